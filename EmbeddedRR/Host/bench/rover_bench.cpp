@@ -0,0 +1,226 @@
+//---------------------------- rover_bench.cpp -------------------------
+// Filename:      	rover_bench.cpp
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Host benchmarks of the Rover_Communication hot paths
+//					built against the Arduino shim: packet encoding,
+//					decoding, sending a TX_64 frame through Serial and
+//					parsing a received RX_64 frame, plus a motor update.
+//					Times are host CPU time, the virtual clock is not
+//					used for measuring; I2C use is reported as counters.
+//					Usage: rover_bench [google benchmark options]
+//------------------------------ Includes  ----------------------------
+#include <string.h>
+
+#include <benchmark/benchmark.h>
+
+#include <Rover_Communication.h>
+#include <Rover_Movement.h>
+#include <Wire.h>
+
+#include "shim.h"
+
+//-------------------------- Configuration  ---------------------------
+// communication (matches Rover1.ino)
+#define MSTR_ADDR_SH 0x0013A200
+#define MSTR_ADDR_SL 0x40F9CEDC
+#define R2_ADDR_SH 0x0013A200
+#define R2_ADDR_SL 0x4103DA0F
+
+#define FRAME_PACKETS (MASTER_SIZE / MIN_SIZE) // packets in a parsed frame
+
+//----------------------------------------------------------------------
+// setup ---------- Resets the shim and the communication module.
+// Preconditions:   None.
+// Postconditions:  Serial runs at 9600 baud and all payloads are empty.
+//----------------------------------------------------------------------
+static void setup() {
+	shim_reset();
+	Serial.begin(9600);
+	com_setupComs(MSTR_ADDR_SH, MSTR_ADDR_SL, R2_ADDR_SH, R2_ADDR_SL);
+	com_emptyPayload(true);
+	com_emptyPayload(false);
+	com_emptyQueue();
+}
+
+//----------------------------------------------------------------------
+// putEscaped ----- Appends a byte to an API mode 2 frame.
+// Preconditions:   frame has room for two more bytes.
+// Postconditions:  The byte is appended, escaped if needed.
+//----------------------------------------------------------------------
+static void putEscaped(uint8_t *frame, size_t *len, uint8_t b) {
+	if (b == 0x7E || b == 0x7D || b == 0x11 || b == 0x13) {
+		frame[(*len)++] = 0x7D;
+		frame[(*len)++] = b ^ 0x20;
+	}
+	else {
+		frame[(*len)++] = b;
+	}
+}
+
+//----------------------------------------------------------------------
+// buildMasterFrame Builds the escaped RX_64 frame of a full master 
+//					payload as rover 2 receives it.
+// Preconditions:   frame holds at least 2 * (MASTER_SIZE + 15) bytes.
+// Postconditions:  Returns the length of the frame.
+//----------------------------------------------------------------------
+static size_t buildMasterFrame(uint8_t *frame) {
+	static const uint8_t master[8] = { 0x00, 0x13, 0xA2, 0x00, 0x40, 0xF9, 0xCE, 0xDC };
+	uint8_t data[MASTER_SIZE + 11];
+	size_t dataLen = 0;
+	uint8_t checksum = 0;
+	size_t len = 0;
+
+	// api id, source, rssi, options, payload
+	data[dataLen++] = 0x80;
+	memcpy(&data[dataLen], master, 8);
+	dataLen += 8;
+	data[dataLen++] = 0x28;
+	data[dataLen++] = 0;
+	for (int i = 0; i < FRAME_PACKETS; i++) {
+		unsigned long time = 1000UL * (i + 1);
+		int l = 100 + i;
+		int r = -100 - i;
+		data[dataLen++] = time >> 24;
+		data[dataLen++] = time >> 16;
+		data[dataLen++] = time >> 8;
+		data[dataLen++] = time;
+		data[dataLen++] = (l >> 2) & 0xFF;
+		data[dataLen++] = ((l & 0x3) << 6) | ((r >> 4) & 0x3F);
+		data[dataLen++] = ((r & 0xF) << 4) | 0x2;
+	}
+
+	frame[len++] = 0x7E;
+	putEscaped(frame, &len, (dataLen >> 8) & 0xFF);
+	putEscaped(frame, &len, dataLen & 0xFF);
+	for (size_t i = 0; i < dataLen; i++) {
+		putEscaped(frame, &len, data[i]);
+		checksum += data[i];
+	}
+	putEscaped(frame, &len, 0xFF - checksum);
+	return len;
+}
+
+//----------------------------------------------------------------------
+//----------------------------- Benchmarks -----------------------------
+//----------------------------------------------------------------------
+
+// one packet into the slave payload, emptied when full
+static void BM_EncodeSlavePacket(benchmark::State &state) {
+	setup();
+	int i = 0;
+	for (auto _ : state) {
+		if (com_encodeSlavePacket(0x2, i & 0x1FF, -(i & 0x1FF)) == ENCODE_ERROR)
+			com_emptyPayload(true);
+		i++;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EncodeSlavePacket);
+
+// one packet into the master payload, emptied when full
+static void BM_EncodeMasterPacket(benchmark::State &state) {
+	setup();
+	int i = 0;
+	for (auto _ : state) {
+		if (com_encodeMasterPacket(0x2, i & 0x1FF, -(i & 0x1FF)) == ENCODE_ERROR)
+			com_emptyPayload(false);
+		i++;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EncodeMasterPacket);
+
+// a full slave payload framed, escaped and written to Serial
+static void BM_SendSlave64(benchmark::State &state) {
+	setup();
+	for (auto _ : state) {
+		state.PauseTiming();
+		com_emptyPayload(true);
+		for (int i = 0; i < MAX_SIZE / MIN_SIZE; i++)
+			com_encodeSlavePacket(0x2, i, -i);
+		state.ResumeTiming();
+		
+		com_sendSlave64(false);
+	}
+	state.SetBytesProcessed(state.iterations() * MAX_SIZE);
+}
+BENCHMARK(BM_SendSlave64);
+
+// an RX_64 frame read from Serial and its payload queued
+static void BM_ReceiveAndUnwrap64(benchmark::State &state) {
+	uint8_t frame[2 * (MASTER_SIZE + 15)];
+	size_t len = buildMasterFrame(frame);
+	setup();
+	for (auto _ : state) {
+		state.PauseTiming();
+		com_emptyQueue();
+		Serial.inject(frame, len, shim_getMicros());
+		shim_advanceMicros(Serial.getLineFree() - shim_getMicros());
+		state.ResumeTiming();
+		
+		if (com_receiveData() != RCV_SIXTYFOUR) {
+			state.SkipWithError("frame not received");
+			break;
+		}
+		com_unwrapAndQueue64();
+	}
+	state.SetItemsProcessed(state.iterations() * FRAME_PACKETS);
+}
+BENCHMARK(BM_ReceiveAndUnwrap64);
+
+// queued packets decoded back into commands
+static void BM_DecodeNext(benchmark::State &state) {
+	uint8_t frame[2 * (MASTER_SIZE + 15)];
+	size_t len = buildMasterFrame(frame);
+	unsigned long timestamp;
+	unsigned char cmd;
+	int lData, rData;
+	setup();
+	for (auto _ : state) {
+		state.PauseTiming();
+		Serial.inject(frame, len, shim_getMicros());
+		shim_advanceMicros(Serial.getLineFree() - shim_getMicros());
+		com_receiveData();
+		com_unwrapAndQueue64();
+		state.ResumeTiming();
+		
+		while (com_decodeNext(&timestamp, &cmd, &lData, &rData))
+			benchmark::DoNotOptimize(lData + rData);
+	}
+	state.SetItemsProcessed(state.iterations() * FRAME_PACKETS);
+}
+BENCHMARK(BM_DecodeNext);
+
+// one ramp step of both motors per update, reversing at the ends
+static void BM_UpdateMotors(benchmark::State &state) {
+	shim_reset();
+	move_setupMotors();
+	move_setRamp(1000, 1000); // a step per millisecond
+	move_setI2CClock(state.range(0));
+	move_setTarget(SPEED_MAX, -SPEED_MAX);
+	unsigned long bytes = Wire.getBytes();
+	unsigned long transmissions = Wire.getTransmissions();
+	unsigned long long busMicros = 0;
+	for (auto _ : state) {
+		state.PauseTiming();
+		shim_advanceMicros(1000);
+		if (move_getCurrentLeft() == move_getTargetLeft())
+			move_setTarget(-move_getTargetLeft(), -move_getTargetRight());
+		unsigned long long start = shim_getMicros();
+		state.ResumeTiming();
+		
+		move_updateMotors();
+		
+		state.PauseTiming();
+		busMicros += shim_getMicros() - start;
+		state.ResumeTiming();
+	}
+	state.counters["i2c_bytes"] = benchmark::Counter(Wire.getBytes() - bytes, benchmark::Counter::kAvgIterations);
+	state.counters["i2c_xfers"] = benchmark::Counter(Wire.getTransmissions() - transmissions, benchmark::Counter::kAvgIterations);
+	state.counters["i2c_us"] = benchmark::Counter(busMicros, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_UpdateMotors)->Arg(I2C_STANDARD)->Arg(I2C_FAST);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,707 @@
+//----------------------------- xbeeemu.c -----------------------------
+// Filename:      	xbeeemu.c
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	XBee 802.15.4 (series 1) radio emulator. Every node
+//					is a pty speaking API mode 2 (escaped) frames, so the
+//					terminal (libxbee "xbee1") and host builds of the
+//					rovers (XBee-Arduino) can talk without radios.
+//					Frames handled:
+//					  0x00 TX_64_REQUEST  -> 0x80 RX_64_RESPONSE at the
+//					                         destination and a 0x89
+//					                         TX_STATUS_RESPONSE back
+//					  0x08 AT_COMMAND     -> 0x88 AT_COMMAND_RESPONSE
+//					                         (SH/SL/MY/AP answered, the
+//					                         rest just return OK)
+//					Bytes leave every node at the configured baud rate
+//					and a frame is delivered when its last byte would
+//					have. Each unicast attempt takes the air latency
+//					(plus jitter) and may be lost; like the radio it is
+//					retried before a TX status of 0x01 (no ack) is given.
+//					Usage: xbeeemu [options] name=addr64[:ack] ...
+//					  -b baud     serial rate of every node (9600)
+//					  -d ms       air latency of an attempt (2)
+//					  -j ms       random extra latency up to ms (0)
+//					  -l percent  chance an attempt is lost (0)
+//					  -n retries  mac retries of a unicast (3)
+//					  -r rssi     rssi magnitude reported (40)
+//					  -R rssi     random extra rssi up to this (0)
+//					  -s seed     random seed (1)
+//					  -p dir      link dir/<name> to each node's pty
+//					  -v          display every frame
+//					addr64 is 16 hex digits. A node ending in :ack has
+//					no pty; it answers every frame holding a command
+//					other than 0xA with a roverPacket ack. Counters are
+//					displayed on SIGINT/SIGTERM.
+//------------------------------ Includes  ----------------------------
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Configuration
+#define MAX_NODES 32
+#define NAME_SIZE 32
+#define MAX_FRAME 128			// unescaped frame data (100 byte payload + header)
+#define MAX_ESCAPED (2 * MAX_FRAME + 8)
+#define ACK_DELAY_MS 1			// time a :ack node takes to answer
+
+// API identifiers
+#define API_TX_64 0x00
+#define API_AT 0x08
+#define API_RX_64 0x80
+#define API_AT_RESPONSE 0x88
+#define API_TX_STATUS 0x89
+
+// TX status values
+#define TX_SUCCESS 0x00
+#define TX_NO_ACK 0x01
+
+// Parser states
+#define P_START 0
+#define P_LEN_MSB 1
+#define P_LEN_LSB 2
+#define P_DATA 3
+#define P_CHECKSUM 4
+
+// Event kinds
+#define EV_WRITE 0				// bytes reach the node's serial port
+#define EV_ACK 1				// a :ack node received a frame
+
+// Per node counters
+struct NodeStats {
+	unsigned long txFrames;		// TX_64 requests from the node
+	unsigned long txLost;		// requests that ran out of retries
+	unsigned long retries;		// extra attempts
+	unsigned long rxFrames;		// RX_64 frames delivered to the node
+	unsigned long atFrames;		// AT commands answered
+	unsigned long badFrames;	// checksum or length errors
+	unsigned long bytesIn;
+	unsigned long bytesOut;
+};
+
+struct Node {
+	char name[NAME_SIZE];
+	uint8_t addr64[8];
+	int master;					// pty master, -1 for :ack nodes
+	int slave;					// kept open so the master never sees a hangup
+	int ackNode;
+	char link[256];				// symlink to remove at exit
+	// frame parser
+	int state;
+	int escape;
+	int need;
+	int len;
+	uint8_t sum;
+	uint8_t frame[MAX_FRAME];
+	// serial pacing in ns
+	uint64_t inFree;			// last byte from the node reached the radio
+	uint64_t outFree;			// last byte queued towards the node
+	struct NodeStats stats;
+};
+
+struct Event {
+	uint64_t due;
+	int kind;
+	int node;
+	int len;
+	uint8_t bytes[MAX_ESCAPED];
+	struct Event *next;
+};
+
+// Emulator settings
+struct Settings {
+	long baud;
+	uint64_t latencyNs;
+	uint64_t jitterNs;
+	double loss;
+	int retries;
+	int rssi;
+	int rssiJitter;
+	int verbose;
+	const char *linkDir;
+};
+
+struct Settings settings = { 9600, 2000000ULL, 0, 0.0, 3, 40, 0, 0, NULL };
+struct Node nodes[MAX_NODES];
+int nodeCount = 0;
+struct Event *events = NULL;	// sorted by due
+uint64_t randState = 1;
+volatile sig_atomic_t running = 1;
+
+//----------------------------------------------------------------------
+// nowNs ---------- Monotonic time in nanoseconds.
+//----------------------------------------------------------------------
+uint64_t nowNs(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+//----------------------------------------------------------------------
+// randUnit ------- Uniform random number in [0, 1) (xorshift64*).
+//----------------------------------------------------------------------
+double randUnit(void) {
+	randState ^= randState >> 12;
+	randState ^= randState << 25;
+	randState ^= randState >> 27;
+	return ((randState * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+//----------------------------------------------------------------------
+// byteNs --------- Time for one byte (start, 8 data and stop bits).
+//----------------------------------------------------------------------
+uint64_t byteNs(void) {
+	return 10000000000ULL / settings.baud;
+}
+
+//----------------------------------------------------------------------
+// schedule ------- Adds an event in due order (events at the same time
+//					stay in the order they were added).
+// Preconditions:   len <= MAX_ESCAPED.
+// Postconditions:  The event is queued, or dropped if out of memory.
+//----------------------------------------------------------------------
+void schedule(uint64_t due, int kind, int node, const uint8_t *bytes, int len) {
+	struct Event *ev = malloc(sizeof(*ev));
+	if (ev == NULL)
+		return;
+
+	ev->due = due;
+	ev->kind = kind;
+	ev->node = node;
+	ev->len = len;
+	memcpy(ev->bytes, bytes, len);
+
+	struct Event **p = &events;
+	while (*p != NULL && (*p)->due <= due)
+		p = &(*p)->next;
+	ev->next = *p;
+	*p = ev;
+}
+
+//----------------------------------------------------------------------
+// putEscaped ----- Appends a byte to an API mode 2 frame.
+//----------------------------------------------------------------------
+void putEscaped(uint8_t *out, int *len, uint8_t b) {
+	if (b == 0x7E || b == 0x7D || b == 0x11 || b == 0x13) {
+		out[(*len)++] = 0x7D;
+		out[(*len)++] = b ^ 0x20;
+	}
+	else {
+		out[(*len)++] = b;
+	}
+}
+
+//----------------------------------------------------------------------
+// sendToNode ----- Queues an API frame towards a node's serial port,
+//					paced at the baud rate after the bytes already queued.
+// Preconditions:   data holds the api id and frame data.
+// Postconditions:  An EV_WRITE is scheduled for when the last byte is
+//					out. Nothing is sent to :ack nodes.
+//----------------------------------------------------------------------
+void sendToNode(int n, uint64_t at, const uint8_t *data, int dataLen) {
+	struct Node *node = &nodes[n];
+	uint8_t out[MAX_ESCAPED];
+	uint8_t sum = 0;
+	int len = 0;
+
+	if (node->ackNode)
+		return;
+
+	out[len++] = 0x7E;
+	putEscaped(out, &len, dataLen >> 8);
+	putEscaped(out, &len, dataLen & 0xFF);
+	for (int i = 0; i < dataLen; i++) {
+		putEscaped(out, &len, data[i]);
+		sum += data[i];
+	}
+	putEscaped(out, &len, 0xFF - sum);
+
+	uint64_t start = at > node->outFree ? at : node->outFree;
+	node->outFree = start + len * byteNs();
+	node->stats.bytesOut += len;
+	schedule(node->outFree, EV_WRITE, n, out, len);
+}
+
+//----------------------------------------------------------------------
+// findNode ------- Looks up a node by its 64-bit address.
+// Postconditions:  Returns the node index or -1.
+//----------------------------------------------------------------------
+int findNode(const uint8_t *addr64) {
+	for (int i = 0; i < nodeCount; i++) {
+		if (memcmp(nodes[i].addr64, addr64, 8) == 0)
+			return i;
+	}
+	return -1;
+}
+
+//----------------------------------------------------------------------
+// airTime -------- Latency of one attempt including jitter.
+//----------------------------------------------------------------------
+uint64_t airTime(void) {
+	return settings.latencyNs + (uint64_t)(randUnit() * settings.jitterNs);
+}
+
+//----------------------------------------------------------------------
+// deliver -------- Hands a payload to a node as an RX_64 frame (or to a
+//					:ack node) at the given time.
+//----------------------------------------------------------------------
+void deliver(int from, int to, uint64_t at, const uint8_t *payload, int payloadLen) {
+	uint8_t rx[MAX_FRAME];
+
+	rx[0] = API_RX_64;
+	memcpy(&rx[1], nodes[from].addr64, 8);
+	rx[9] = settings.rssi + (int)(randUnit() * (settings.rssiJitter + 1));
+	rx[10] = 0; // options
+	memcpy(&rx[11], payload, payloadLen);
+
+	nodes[to].stats.rxFrames++;
+	if (nodes[to].ackNode) {
+		// remember the sender in the event so the ack can go back
+		uint8_t note[1 + MAX_FRAME];
+		note[0] = from;
+		memcpy(&note[1], payload, payloadLen);
+		schedule(at + ACK_DELAY_MS * 1000000ULL, EV_ACK, to, note, payloadLen + 1);
+	}
+	else {
+		sendToNode(to, at, rx, payloadLen + 11);
+	}
+}
+
+//----------------------------------------------------------------------
+// transmit ------- Sends a TX_64 request from a node over the air.
+// Preconditions:   at is when the radio had the whole request.
+// Postconditions:  The payload is delivered (or lost) and a TX status
+//					is returned if frameId is not 0.
+//----------------------------------------------------------------------
+void transmit(int from, uint64_t at, uint8_t frameId, const uint8_t *dest, uint8_t options,
+		const uint8_t *payload, int payloadLen) {
+	static const uint8_t broadcast[8] = { 0, 0, 0, 0, 0, 0, 0xFF, 0xFF };
+	uint64_t done = at;
+	uint8_t status = TX_SUCCESS;
+
+	nodes[from].stats.txFrames++;
+
+	if (memcmp(dest, broadcast, 8) == 0) {
+		// one attempt, never acked
+		for (int i = 0; i < nodeCount; i++) {
+			uint64_t arrive = at + airTime();
+			if (i != from && randUnit() >= settings.loss)
+				deliver(from, i, arrive, payload, payloadLen);
+			if (arrive > done)
+				done = arrive;
+		}
+	}
+	else {
+		int to = findNode(dest);
+		int attempts = (options & 0x01) ? 1 : settings.retries + 1; // 0x01 disables the mac ack
+		int sent = 0;
+
+		for (int attempt = 0; attempt < attempts && !sent; attempt++) {
+			if (attempt > 0)
+				nodes[from].stats.retries++;
+			done += airTime();
+			if (to >= 0 && to != from && randUnit() >= settings.loss) {
+				deliver(from, to, done, payload, payloadLen);
+				sent = 1;
+			}
+		}
+
+		if (!sent && !(options & 0x01)) {
+			nodes[from].stats.txLost++;
+			status = TX_NO_ACK;
+		}
+	}
+
+	if (frameId != 0) {
+		uint8_t txStatus[3] = { API_TX_STATUS, frameId, status };
+		sendToNode(from, done, txStatus, sizeof(txStatus));
+	}
+}
+
+//----------------------------------------------------------------------
+// answerAt ------- Answers a local AT command.
+//----------------------------------------------------------------------
+void answerAt(int n, uint64_t at, const uint8_t *frame, int len) {
+	uint8_t resp[16] = { API_AT_RESPONSE, frame[1], frame[2], frame[3], 0x00 };
+	int respLen = 5;
+
+	nodes[n].stats.atFrames++;
+	if (len == 4) { // a query rather than a set
+		if (frame[2] == 'S' && frame[3] == 'H') {
+			memcpy(&resp[respLen], &nodes[n].addr64[0], 4);
+			respLen += 4;
+		}
+		else if (frame[2] == 'S' && frame[3] == 'L') {
+			memcpy(&resp[respLen], &nodes[n].addr64[4], 4);
+			respLen += 4;
+		}
+		else if (frame[2] == 'M' && frame[3] == 'Y') {
+			resp[respLen++] = 0xFF; // 16-bit addressing disabled
+			resp[respLen++] = 0xFE;
+		}
+		else if (frame[2] == 'A' && frame[3] == 'P') {
+			resp[respLen++] = 2;
+		}
+	}
+
+	if (frame[1] != 0)
+		sendToNode(n, at, resp, respLen);
+}
+
+//----------------------------------------------------------------------
+// handleFrame ---- Acts on a complete frame received from a node.
+//----------------------------------------------------------------------
+void handleFrame(int n, uint64_t at, const uint8_t *frame, int len) {
+	if (settings.verbose) {
+		printf("%12.6f %-8s >", at / 1e9, nodes[n].name);
+		for (int i = 0; i < len; i++)
+			printf(" %02X", frame[i]);
+		printf("\n");
+	}
+
+	switch (frame[0]) {
+		case API_TX_64: // id, frame id, dest(8), options, data
+			if (len >= 11)
+				transmit(n, at, frame[1], &frame[2], frame[10], &frame[11], len - 11);
+			else
+				nodes[n].stats.badFrames++;
+			break;
+
+		case API_AT: // id, frame id, command(2), parameter
+			if (len >= 4)
+				answerAt(n, at, frame, len);
+			else
+				nodes[n].stats.badFrames++;
+			break;
+
+		default:
+			break;
+	}
+}
+
+//----------------------------------------------------------------------
+// parseBytes ----- Runs bytes read from a node through its frame parser.
+// Postconditions:  Each complete frame is handled when its last byte
+//					would have reached the radio at the baud rate.
+//----------------------------------------------------------------------
+void parseBytes(int n, uint64_t now, const uint8_t *bytes, int count) {
+	struct Node *node = &nodes[n];
+
+	node->stats.bytesIn += count;
+	for (int i = 0; i < count; i++) {
+		uint8_t b = bytes[i];
+
+		// bytes from the node arrive back to back at the baud rate
+		node->inFree = (node->inFree > now ? node->inFree : now) + byteNs();
+
+		if (b == 0x7E) { // a start byte always begins a new frame
+			node->state = P_LEN_MSB;
+			node->escape = 0;
+			continue;
+		}
+		if (node->state == P_START)
+			continue;
+		if (b == 0x7D) {
+			node->escape = 1;
+			continue;
+		}
+		if (node->escape) {
+			b ^= 0x20;
+			node->escape = 0;
+		}
+
+		switch (node->state) {
+			case P_LEN_MSB:
+				node->need = b << 8;
+				node->state = P_LEN_LSB;
+				break;
+			case P_LEN_LSB:
+				node->need += b;
+				node->len = 0;
+				node->sum = 0;
+				if (node->need == 0 || node->need > MAX_FRAME) {
+					node->stats.badFrames++;
+					node->state = P_START;
+				}
+				else {
+					node->state = P_DATA;
+				}
+				break;
+			case P_DATA:
+				node->frame[node->len++] = b;
+				node->sum += b;
+				if (node->len == node->need)
+					node->state = P_CHECKSUM;
+				break;
+			case P_CHECKSUM:
+				node->state = P_START;
+				if ((uint8_t)(node->sum + b) == 0xFF)
+					handleFrame(n, node->inFree, node->frame, node->len);
+				else
+					node->stats.badFrames++;
+				break;
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+// runEvent ------- Performs an event that came due.
+//----------------------------------------------------------------------
+void runEvent(const struct Event *ev) {
+	struct Node *node = &nodes[ev->node];
+
+	if (ev->kind == EV_WRITE) {
+		if (settings.verbose)
+			printf("%12.6f %-8s < %i bytes\n", ev->due / 1e9, node->name, ev->len);
+
+		int off = 0;
+		while (off < ev->len) {
+			ssize_t n = write(node->master, ev->bytes + off, ev->len - off);
+			if (n < 0) {
+				if (errno == EINTR)
+					continue;
+				break; // nobody is reading, the bytes are lost like on a real port
+			}
+			off += n;
+		}
+	}
+	else if (ev->kind == EV_ACK) {
+		// ack unless every roverPacket is itself an ack (command 0xA)
+		const uint8_t *payload = ev->bytes + 1;
+		int payloadLen = ev->len - 1;
+		int needAck = 0;
+		for (int i = 0; i + 7 <= payloadLen; i += 7) {
+			if ((payload[i + 6] & 0x0F) != 0xA)
+				needAck = 1;
+		}
+
+		if (needAck) {
+			static const uint8_t ack[7] = { 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x0A };
+			transmit(ev->node, ev->due, 0, nodes[ev->bytes[0]].addr64, 0, ack, sizeof(ack));
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+// openNode ------- Creates the pty of a node and sets it raw.
+// Postconditions:  Returns 0 on success, -1 with an error displayed.
+//----------------------------------------------------------------------
+int openNode(struct Node *node) {
+	struct termios tio;
+
+	node->master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (node->master < 0 || grantpt(node->master) != 0 || unlockpt(node->master) != 0) {
+		perror("posix_openpt");
+		return -1;
+	}
+
+	const char *path = ptsname(node->master);
+	node->slave = open(path, O_RDWR | O_NOCTTY);
+	if (node->slave < 0) {
+		perror(path);
+		return -1;
+	}
+
+	tcgetattr(node->slave, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(node->slave, TCSANOW, &tio);
+	fcntl(node->master, F_SETFL, O_NONBLOCK);
+
+	if (settings.linkDir != NULL) {
+		snprintf(node->link, sizeof(node->link), "%s/%s", settings.linkDir, node->name);
+		unlink(node->link);
+		if (symlink(path, node->link) != 0) {
+			perror(node->link);
+			node->link[0] = '\0';
+		}
+	}
+
+	printf("%-8s %02X%02X%02X%02X %02X%02X%02X%02X  %s\n", node->name, node->addr64[0], node->addr64[1],
+			node->addr64[2], node->addr64[3], node->addr64[4], node->addr64[5], node->addr64[6],
+			node->addr64[7], node->link[0] ? node->link : path);
+	return 0;
+}
+
+//----------------------------------------------------------------------
+// parseNode ------ Adds a node from a name=addr64[:ack] argument.
+// Postconditions:  Returns 0 on success, -1 with an error displayed.
+//----------------------------------------------------------------------
+int parseNode(const char *arg) {
+	const char *eq = strchr(arg, '=');
+	char *end;
+
+	if (nodeCount == MAX_NODES) {
+		fprintf(stderr, "more than %i nodes\n", MAX_NODES);
+		return -1;
+	}
+	if (eq == NULL || eq == arg || eq - arg >= NAME_SIZE) {
+		fprintf(stderr, "bad node '%s', expected name=addr64[:ack]\n", arg);
+		return -1;
+	}
+
+	struct Node *node = &nodes[nodeCount];
+	memset(node, 0, sizeof(*node));
+	node->master = node->slave = -1;
+	memcpy(node->name, arg, eq - arg);
+
+	unsigned long long addr = strtoull(eq + 1, &end, 16);
+	if (end == eq + 1 || (*end != '\0' && strcmp(end, ":ack") != 0)) {
+		fprintf(stderr, "bad address in '%s'\n", arg);
+		return -1;
+	}
+	node->ackNode = (*end != '\0');
+	for (int i = 7; i >= 0; i--) {
+		node->addr64[i] = addr & 0xFF;
+		addr >>= 8;
+	}
+
+	if (findNode(node->addr64) >= 0) {
+		fprintf(stderr, "address of %s is already used\n", node->name);
+		return -1;
+	}
+
+	nodeCount++;
+	return 0;
+}
+
+//----------------------------------------------------------------------
+// printStats ----- Displays the counters of every node.
+//----------------------------------------------------------------------
+void printStats(void) {
+	printf("%-8s %8s %8s %8s %8s %6s %6s %10s %10s\n", "Node", "tx", "lost", "retries",
+			"rx", "at", "bad", "bytes in", "bytes out");
+	for (int i = 0; i < nodeCount; i++) {
+		const struct NodeStats *s = &nodes[i].stats;
+		printf("%-8s %8lu %8lu %8lu %8lu %6lu %6lu %10lu %10lu\n", nodes[i].name, s->txFrames,
+				s->txLost, s->retries, s->rxFrames, s->atFrames, s->badFrames, s->bytesIn, s->bytesOut);
+	}
+}
+
+//----------------------------------------------------------------------
+// stop ----------- Signal handler ending the event loop.
+//----------------------------------------------------------------------
+void stop(int sig) {
+	(void)sig;
+	running = 0;
+}
+
+//----------------------------------------------------------------------
+// main ----------- Creates the nodes and runs the event loop.
+// Preconditions:   None.
+// Postconditions:  Returns 0 after SIGINT/SIGTERM.
+//----------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+	struct pollfd fds[MAX_NODES];
+	int opt;
+
+	while ((opt = getopt(argc, argv, "b:d:j:l:n:r:R:s:p:v")) != -1) {
+		switch (opt) {
+			case 'b': settings.baud = atol(optarg); break;
+			case 'd': settings.latencyNs = atof(optarg) * 1e6; break;
+			case 'j': settings.jitterNs = atof(optarg) * 1e6; break;
+			case 'l': settings.loss = atof(optarg) / 100.0; break;
+			case 'n': settings.retries = atoi(optarg); break;
+			case 'r': settings.rssi = atoi(optarg); break;
+			case 'R': settings.rssiJitter = atoi(optarg); break;
+			case 's': randState = strtoull(optarg, NULL, 0) | 1; break;
+			case 'p': settings.linkDir = optarg; break;
+			case 'v': settings.verbose = 1; break;
+			default:
+				fprintf(stderr, "Usage: %s [-b baud] [-d ms] [-j ms] [-l percent] [-n retries] "
+						"[-r rssi] [-R rssi] [-s seed] [-p dir] [-v] name=addr64[:ack] ...\n", argv[0]);
+				return 1;
+		}
+	}
+
+	if (settings.baud <= 0 || settings.retries < 0 || optind == argc) {
+		fprintf(stderr, "Usage: %s [options] name=addr64[:ack] ...\n", argv[0]);
+		return 1;
+	}
+
+	for (int i = optind; i < argc; i++) {
+		if (parseNode(argv[i]) != 0)
+			return 1;
+	}
+
+	if (settings.linkDir != NULL)
+		mkdir(settings.linkDir, 0755);
+
+	for (int i = 0; i < nodeCount; i++) {
+		if (!nodes[i].ackNode && openNode(&nodes[i]) != 0)
+			return 1;
+	}
+	fflush(stdout);
+
+	signal(SIGINT, stop);
+	signal(SIGTERM, stop);
+	signal(SIGPIPE, SIG_IGN);
+
+	while (running) {
+		uint64_t now = nowNs();
+		int count = 0;
+
+		// perform what came due
+		while (events != NULL && events->due <= now) {
+			struct Event *ev = events;
+			events = ev->next;
+			runEvent(ev);
+			free(ev);
+		}
+
+		// wait for input or the next event
+		for (int i = 0; i < nodeCount; i++) {
+			if (nodes[i].master >= 0) {
+				fds[count].fd = nodes[i].master;
+				fds[count].events = POLLIN;
+				count++;
+			}
+		}
+
+		struct timespec wait;
+		if (events != NULL) {
+			uint64_t ns = events->due > now ? events->due - now : 0;
+			wait.tv_sec = ns / 1000000000ULL;
+			wait.tv_nsec = ns % 1000000000ULL;
+		}
+
+		if (ppoll(fds, count, events != NULL ? &wait : NULL, NULL) < 0) {
+			if (errno == EINTR)
+				continue;
+			perror("poll");
+			break;
+		}
+
+		now = nowNs();
+		for (int i = 0, f = 0; i < nodeCount; i++) {
+			if (nodes[i].master < 0)
+				continue;
+			if (fds[f++].revents & POLLIN) {
+				uint8_t buf[512];
+				ssize_t n = read(nodes[i].master, buf, sizeof(buf));
+				if (n > 0)
+					parseBytes(i, now, buf, n);
+			}
+		}
+		fflush(stdout);
+	}
+
+	printStats();
+	for (int i = 0; i < nodeCount; i++) {
+		if (nodes[i].link[0] != '\0')
+			unlink(nodes[i].link);
+	}
+
+	return 0;
+}
@@ -0,0 +1,562 @@
+//------------------------------ replay.cpp ----------------------------
+// Filename:      	replay.cpp
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Deterministic replay of a recorded packet log through
+//					the Rover 2 navigation path on the host. Frames from
+//					a telemetry log (see libxbee/terminal/telemetry.h)
+//					are fed as RX_64 API frames into the Serial shim at
+//					their recorded times and 9600 baud, then through
+//					com_receiveData, com_unwrapAndQueue64, com_decodeNext
+//					and the Rover_Navigation executor against a virtual
+//					clock. updateState mirrors Rover2.ino without the
+//					lights.
+//					Usage: replay [-p loop_us] [-k ack_ms] [-v] log
+//					  -p  virtual time per loop() (default 1000 us)
+//					  -k  delay of the TX status for each send (10 ms)
+//					  -v  display every executed navigation packet
+//					Frames from any address other than the master are
+//					delivered as coming from rover 1.
+//------------------------------ Includes  ----------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <vector>
+#include <algorithm>
+
+#include <Rover_Communication.h>
+#include <Rover_Movement.h>
+#include <Rover_Navigation.h>
+
+#include "shim.h"
+#include "telemetry.h"
+
+//-------------------------- Configuration  ---------------------------
+// communication (matches Rover2.ino)
+#define MSTR_ADDR_SH 0x0013A200
+#define MSTR_ADDR_SL 0x40F9CEDC
+#define R1_ADDR_SH 0x0013A200
+#define R1_ADDR_SL 0x40F9CEDE
+
+#define LOOP_US 1000 		// default virtual time per loop()
+#define ACK_MS 10 			// default delay of a TX status response
+#define FOLLOW_LIMIT 60000 	// ms after the last frame before giving up
+#define API_FRAME_SIZE 128 	// escaped RX_64 frame of the largest payload
+
+//------------------------------ Globals  -----------------------------
+#define STATE_STOP 0
+#define STATE_STRAIGHT 1
+#define STATE_LEFT 2
+#define STATE_RIGHT 3
+#define STATE_READY 5
+#define STATE_MANUAL 6
+
+int currentState = STATE_STOP;
+unsigned long ackMicros = ACK_MS * 1000UL;
+bool verbose = false;
+
+// Timing samples in microseconds
+struct Samples {
+	std::vector<long long> values;
+
+	void add(long long v) { values.push_back(v); }
+
+	void print(const char *name) {
+		if (values.empty()) {
+			printf("%-10s no samples\n", name);
+			return;
+		}
+		std::sort(values.begin(), values.end());
+		long long sum = 0;
+		for (size_t i = 0; i < values.size(); i++)
+			sum += values[i];
+		printf("%-10s mean %8.3f  p50 %8.3f  p99 %8.3f  max %8.3f ms (%zu)\n", name,
+				sum / 1000.0 / values.size(), values[values.size() / 2] / 1000.0,
+				values[values.size() * 99 / 100] / 1000.0, values.back() / 1000.0, values.size());
+	}
+};
+
+// Replay counters
+struct ReplayStats {
+	unsigned long frames;		// frames injected
+	unsigned long decoded;		// roverPackets decoded
+	unsigned long enqueued;		// navigationPackets queued
+	unsigned long dropped;		// navigationPackets the full replay buffer refused
+	unsigned long executed;		// navigationPackets applied
+	unsigned long superseded;	// targets replaced before the motors got there
+	unsigned long estops;
+	unsigned long txFrames;		// frames sent by the rover
+	int queueMax;
+	Samples dispatch;			// due -> move_setTarget
+	Samples applied;			// due -> motors at target
+	Samples settle;				// move_setTarget -> motors at target
+} stats;
+
+// Target waiting for the motors to reach it
+struct PendingTarget {
+	bool active;
+	int left;
+	int right;
+	unsigned long long due;		// virtual us the target was commanded for
+	unsigned long long set;		// virtual us the target was set
+} pending;
+
+//----------------------------------------------------------------------
+//----------------------------- Radio Model ----------------------------
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// putEscaped ----- Appends a byte to an API mode 2 frame.
+// Preconditions:   frame has room for two more bytes.
+// Postconditions:  The byte is appended, escaped if needed.
+//----------------------------------------------------------------------
+void putEscaped(uint8_t *frame, size_t *len, uint8_t b) {
+	if (b == 0x7E || b == 0x7D || b == 0x11 || b == 0x13) {
+		frame[(*len)++] = 0x7D;
+		frame[(*len)++] = b ^ 0x20;
+	}
+	else {
+		frame[(*len)++] = b;
+	}
+}
+
+//----------------------------------------------------------------------
+// buildFrame ----- Builds an escaped API frame from the frame data.
+// Preconditions:   frame holds at least 2 * (dataLen + 4) bytes.
+// Postconditions:  Returns the length of the frame.
+//----------------------------------------------------------------------
+size_t buildFrame(uint8_t *frame, const uint8_t *data, size_t dataLen) {
+	size_t len = 0;
+	uint8_t checksum = 0;
+
+	frame[len++] = 0x7E;
+	putEscaped(frame, &len, (dataLen >> 8) & 0xFF);
+	putEscaped(frame, &len, dataLen & 0xFF);
+	for (size_t i = 0; i < dataLen; i++) {
+		putEscaped(frame, &len, data[i]);
+		checksum += data[i];
+	}
+	putEscaped(frame, &len, 0xFF - checksum);
+
+	return len;
+}
+
+//----------------------------------------------------------------------
+// injectRecord --- Delivers a recorded frame as an RX_64 response.
+// Preconditions:   Serial is setup.
+// Postconditions:  Frame bytes are scheduled on the Serial shim.
+//----------------------------------------------------------------------
+void injectRecord(const TelemetryRecord *rec, unsigned long long atMicros) {
+	static const uint8_t master[8] = { 0x00, 0x13, 0xA2, 0x00, 0x40, 0xF9, 0xCE, 0xDC };
+	static const uint8_t rover1[8] = { 0x00, 0x13, 0xA2, 0x00, 0x40, 0xF9, 0xCE, 0xDE };
+	uint8_t data[TLM_DATA_SIZE + 11];
+	uint8_t frame[API_FRAME_SIZE * 2];
+
+	// api id, source, rssi, options, payload
+	data[0] = 0x80;
+	memcpy(&data[1], memcmp(rec->addr64, master, 8) == 0 ? master : rover1, 8);
+	data[9] = rec->rssi;
+	data[10] = 0;
+	memcpy(&data[11], rec->data, rec->dataLen);
+
+	size_t len = buildFrame(frame, data, rec->dataLen + 11);
+	Serial.inject(frame, len, atMicros);
+	stats.frames++;
+}
+
+//----------------------------------------------------------------------
+// radioTx -------- Receives the bytes the rover sends to its xbee and
+//					answers each TX_64 request with a successful TX
+//					status after the configured delay.
+// Preconditions:   Registered as the Serial tx handler.
+// Postconditions:  TX status responses are scheduled on the Serial shim.
+//----------------------------------------------------------------------
+void radioTx(const uint8_t *bytes, size_t len) {
+	uint8_t data[API_FRAME_SIZE * 2];
+	size_t dataLen = 0;
+
+	// unescape, skipping the start byte
+	for (size_t i = 1; i < len && dataLen < sizeof(data); i++) {
+		if (bytes[i] == 0x7D && i + 1 < len)
+			data[dataLen++] = bytes[++i] ^ 0x20;
+		else
+			data[dataLen++] = bytes[i];
+	}
+
+	// length(2), api id, frame id
+	if (dataLen < 4 || data[2] != 0x00)
+		return;
+
+	stats.txFrames++;
+	if (data[3] != 0) {
+		uint8_t status[3] = { 0x89, data[3], 0x00 };
+		uint8_t frame[16];
+		size_t frameLen = buildFrame(frame, status, sizeof(status));
+		Serial.inject(frame, frameLen, shim_getMicros() + ackMicros);
+	}
+}
+
+//----------------------------------------------------------------------
+//----------------------------- State Functions ------------------------
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// enterStopState() -- Enters STATE_STOP, clears payloads, and optionally
+// sends statistics.
+//----------------------------------------------------------------------
+void enterStopState(bool sendStats) {
+	currentState = STATE_STOP;
+	move_setTarget(0, 0);
+	com_emptyPayload(true);
+	com_emptyPayload(false);
+	com_emptyQueue();
+	nav_emptyQueue();
+
+	if (sendStats)
+		com_sendStatistics64(true);
+}
+
+//----------------------------------------------------------------------
+// emergencyStop() -- Stops immediately, clears payloads, sends estop
+// command to other rover if not already stopped, enters STATE_STOP,
+// and optionally sends statistics.
+//----------------------------------------------------------------------
+void emergencyStop(bool sendStats) {
+	stats.estops++;
+	move_fullStop();
+	pending.active = false;
+	com_emptyPayload(true);
+	com_emptyPayload(false);
+	nav_emptyQueue();
+
+	if (currentState != STATE_STOP) {
+		com_encodeSlavePacket(0, 0, 0);
+		com_sendSlave64(true);
+	}
+
+	com_emptyQueue();
+	currentState = STATE_STOP;
+	if (sendStats) {
+		com_sendStatistics64(true);
+		com_resetStatistics();
+	}
+	delay(100);
+}
+
+//----------------------------------------------------------------------
+// executeNav() -- Applies a navigation packet, records its timing and
+// enters the matching state.
+//----------------------------------------------------------------------
+void executeNav(const NavigationPacket *packet) {
+	unsigned long long now = shim_getMicros();
+	unsigned long long due = (unsigned long long)(long long)(packet->timestamp - nav_getOffset()) * 1000ULL;
+
+	if (pending.active)
+		stats.superseded++;
+
+	stats.executed++;
+	stats.dispatch.add((long long)(now - due));
+	pending.active = true;
+	pending.left = packet->leftPower;
+	pending.right = packet->rightPower;
+	pending.due = due;
+	pending.set = now;
+
+	int direction = nav_execute(packet->leftPower, packet->rightPower);
+
+	if (verbose) {
+		printf("%10.3f ms  nav l %4i r %4i  late %7.3f ms  queued %i\n", now / 1000.0,
+				packet->leftPower, packet->rightPower, (long long)(now - due) / 1000.0,
+				nav_getQueuedPackets());
+	}
+
+	switch (direction) {
+		case NAV_STOP:
+			enterStopState(true);
+			break;
+		case NAV_STRAIGHT:
+			currentState = STATE_STRAIGHT;
+			break;
+		case NAV_LEFT:
+			currentState = STATE_LEFT;
+			break;
+		case NAV_RIGHT:
+			currentState = STATE_RIGHT;
+			break;
+	}
+}
+
+//----------------------------------------------------------------------
+// queueNav() -- Adds a target to the replay buffer, a drop is counted
+// like Rover2 does for the stats frame.
+//----------------------------------------------------------------------
+void queueNav(unsigned long timestamp, int leftPower, int rightPower) {
+	if (nav_enqueue(timestamp, leftPower, rightPower))
+		stats.enqueued++;
+	else {
+		stats.dropped++;
+		com_noteQueueDrop(COM_QUEUE_NAV);
+	}
+}
+
+//----------------------------------------------------------------------
+// receive() -- Receives and unwraps xbee data. Returns false if an
+// emergency stop was handled.
+//----------------------------------------------------------------------
+bool receive(bool sendStats) {
+	if (com_receiveData() == RCV_SIXTYFOUR) {
+		if (com_unwrapAndQueue64()) {
+			emergencyStop(sendStats);
+			return false;
+		}
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------
+// updateState() -- Updates the state based on xbee communication.
+//----------------------------------------------------------------------
+void updateState() {
+	unsigned long timestamp = 0;
+	unsigned char cmd = 0;
+	int lData = 0;
+	int rData = 0;
+	NavigationPacket thePacket;
+
+	switch (currentState) {
+		case STATE_READY: // received navigation data, waiting to start
+			if (!receive(true))
+				return;
+			while (com_decodeNext(&timestamp, &cmd, &lData, &rData)) {
+				stats.decoded++;
+				if (cmd == 0xA) {
+					queueNav(timestamp, lData, rData);
+				}
+				else if (cmd == 0x6 && nav_start(&thePacket)) {
+					executeNav(&thePacket);
+				}
+			}
+			break;
+
+		case STATE_STRAIGHT:
+		case STATE_LEFT:
+		case STATE_RIGHT: // following
+			if (!nav_isEmpty()) {
+				if (nav_getDue(&thePacket))
+					executeNav(&thePacket);
+			}
+			else {
+				emergencyStop(true);
+			}
+
+			if (!receive(true))
+				return;
+			if (com_decodeNext(&timestamp, &cmd, &lData, &rData)) {
+				stats.decoded++;
+				if (cmd == 0xA) {
+					queueNav(timestamp, lData, rData);
+				}
+			}
+			break;
+
+		case STATE_STOP:
+		case STATE_MANUAL: // waiting for new commands
+			if (!receive(false))
+				return;
+			while (com_decodeNext(&timestamp, &cmd, &lData, &rData)) {
+				stats.decoded++;
+				switch (cmd) {
+					case 0x1: // Slow Stop
+						if (currentState == STATE_MANUAL)
+							enterStopState(false);
+						break;
+					case 0x2: // Forward
+						currentState = STATE_MANUAL;
+						move_moveForward(false);
+						break;
+					case 0x3: // Backward
+						currentState = STATE_MANUAL;
+						move_moveReverse(false);
+						break;
+					case 0x4: // Turn left 90
+						currentState = STATE_MANUAL;
+						move_rotateLeft90();
+						break;
+					case 0x5: // Turn right 90
+						currentState = STATE_MANUAL;
+						move_rotateRight90();
+						break;
+					case 0xA: // Navigation Data
+						currentState = STATE_READY;
+						queueNav(timestamp, lData, rData);
+						break;
+				}
+			}
+			break;
+	}
+}
+
+//----------------------------------------------------------------------
+// trackTarget() -- Records when the motors reach the pending target.
+//----------------------------------------------------------------------
+void trackTarget() {
+	if (!pending.active)
+		return;
+
+	if (move_getTargetLeft() != pending.left || move_getTargetRight() != pending.right) {
+		pending.active = false; // replaced by a stop
+		return;
+	}
+
+	if (move_getCurrentLeft() == pending.left && move_getCurrentRight() == pending.right) {
+		unsigned long long now = shim_getMicros();
+		stats.settle.add((long long)(now - pending.set));
+		stats.applied.add((long long)(now - pending.due));
+		pending.active = false;
+	}
+}
+
+//----------------------------------------------------------------------
+// loadLog -------- Reads every record of a telemetry log.
+// Preconditions:   None.
+// Postconditions:  Returns the records, empty on error.
+//----------------------------------------------------------------------
+std::vector<TelemetryRecord> loadLog(const char *path) {
+	std::vector<TelemetryRecord> records;
+	TelemetryHeader header;
+	TelemetryRecord rec;
+
+	FILE *fp = fopen(path, "rb");
+	if (fp == NULL) {
+		perror(path);
+		return records;
+	}
+
+	if (fread(&header, sizeof(header), 1, fp) != 1 || memcmp(header.magic, TLM_MAGIC, sizeof(TLM_MAGIC)) != 0 ||
+			header.version != TLM_VERSION || header.recordSize != sizeof(TelemetryRecord)) {
+		fprintf(stderr, "%s: not a telemetry log of this version\n", path);
+		fclose(fp);
+		return records;
+	}
+
+	while (fread(&rec, sizeof(rec), 1, fp) == 1)
+		records.push_back(rec);
+
+	fclose(fp);
+	return records;
+}
+
+//----------------------------------------------------------------------
+// hostNanos ------ Monotonic host time in nanoseconds.
+//----------------------------------------------------------------------
+long long hostNanos() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+//----------------------------------------------------------------------
+// main ----------- Replays the log and displays the timing report.
+// Preconditions:   None.
+// Postconditions:  Returns 0 on success.
+//----------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+	unsigned long loopMicros = LOOP_US;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "p:k:v")) != -1) {
+		switch (opt) {
+			case 'p':
+				loopMicros = strtoul(optarg, NULL, 10);
+				break;
+			case 'k':
+				ackMicros = strtoul(optarg, NULL, 10) * 1000UL;
+				break;
+			case 'v':
+				verbose = true;
+				break;
+			default:
+				fprintf(stderr, "Usage: %s [-p loop_us] [-k ack_ms] [-v] log\n", argv[0]);
+				return 1;
+		}
+	}
+	if (optind >= argc || loopMicros == 0) {
+		fprintf(stderr, "Usage: %s [-p loop_us] [-k ack_ms] [-v] log\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<TelemetryRecord> records = loadLog(argv[optind]);
+	if (records.empty())
+		return 1;
+
+	// setup like Rover2.ino
+	shim_reset();
+	Serial.begin(9600);
+	Serial.setTxHandler(radioTx);
+	move_setupMotors();
+	com_setupComs(MSTR_ADDR_SH, MSTR_ADDR_SL, R1_ADDR_SH, R1_ADDR_SL);
+	nav_setupNavigation();
+	com_setQueueCapacity(COM_QUEUE_NAV, nav_getCapacity());
+
+	uint64_t base = records[0].hostTime;
+	unsigned long long lastFrame = (records.back().hostTime - base) / 1000;
+	size_t next = 0;
+	unsigned long loops = 0;
+	long long hostCost = 0;
+	long long hostMax = 0;
+	long long hostStart = hostNanos();
+
+	for (;;) {
+		unsigned long long now = shim_getMicros();
+
+		// hand recorded frames to the radio as they come due
+		while (next < records.size() && (records[next].hostTime - base) / 1000 <= now) {
+			injectRecord(&records[next], (records[next].hostTime - base) / 1000);
+			next++;
+		}
+
+		// done once everything was delivered and the rover is idle
+		bool following = currentState == STATE_STRAIGHT || currentState == STATE_LEFT || currentState == STATE_RIGHT;
+		if (next == records.size() && now >= Serial.getLineFree() && !pending.active &&
+				(!following || now > lastFrame + FOLLOW_LIMIT * 1000ULL))
+			break;
+
+		long long start = hostNanos();
+		updateState();
+		move_updateMotors();
+		long long cost = hostNanos() - start;
+
+		hostCost += cost;
+		if (cost > hostMax)
+			hostMax = cost;
+		loops++;
+
+		trackTarget();
+		if (nav_getQueuedPackets() > stats.queueMax)
+			stats.queueMax = nav_getQueuedPackets();
+
+		shim_advanceMicros(loopMicros);
+	}
+
+	long long hostTotal = hostNanos() - hostStart;
+	double virtualSec = shim_getMicros() / 1e6;
+
+	printf("Replayed %lu frames (%lu roverPackets) over %.3f s of virtual time\n",
+			stats.frames, stats.decoded, virtualSec);
+	printf("Navigation: %lu queued, %lu dropped, %lu executed, %lu superseded, %lu estops, queue max %i of %i\n",
+			stats.enqueued, stats.dropped, stats.executed, stats.superseded, stats.estops,
+			stats.queueMax, nav_getCapacity());
+	printf("Radio: %lu frames sent, %lu rx bytes dropped on overflow\n", stats.txFrames, Serial.getOverflows());
+	stats.dispatch.print("dispatch");
+	stats.settle.print("settle");
+	stats.applied.print("applied");
+	printf("Loop: %lu loops, %.1f us virtual per loop, host %.0f ns mean %lld ns max\n", loops,
+			(double)shim_getMicros() / loops, (double)hostCost / loops, hostMax);
+	printf("Host: %.3f s for %.3f s virtual (%.0fx real time)\n", hostTotal / 1e9, virtualSec,
+			hostTotal > 0 ? virtualSec / (hostTotal / 1e9) : 0.0);
+
+	return 0;
+}
@@ -0,0 +1,177 @@
+//------------------------- Adafruit_LSM303_U --------------------------
+// Filename:      	Adafruit_LSM303_U.cpp
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Host shim for the Adafruit LSM303 unified driver.
+//----------------------------------------------------------------------
+#include <string.h>
+
+#include "Adafruit_LSM303_U.h"
+#include "shim.h"
+
+//---------------------------- Initialization --------------------------
+// accelerometer data rates by ODR (CTRL_REG1_A bits 7:4), Hz
+static const unsigned int ACCEL_RATES[16] = { 0, 1, 10, 25, 50, 100, 200, 400 };
+
+// magnetometer LSB per gauss by GN (CRB_REG_M bits 7:5), XY and Z
+static const unsigned int MAG_LSB_XY[8] = { 1100, 1100, 855, 670, 450, 400, 330, 230 };
+static const unsigned int MAG_LSB_Z[8] = { 980, 980, 760, 600, 400, 355, 295, 205 };
+
+static Adafruit_LSM303_Unified *s_accel = NULL;
+static Adafruit_LSM303_Unified *s_mag = NULL;
+
+static void accelReceive(const uint8_t *data, uint8_t len) { s_accel->receive(data, len); }
+static void accelTransmit(uint8_t *data, uint8_t len) { s_accel->transmit(data, len); }
+static void magReceive(const uint8_t *data, uint8_t len) { s_mag->receive(data, len); }
+static void magTransmit(uint8_t *data, uint8_t len) { s_mag->transmit(data, len); }
+
+//----------------------------------------------------------------------
+// toCounts ------- Scales a reading to a 12 bit signed sample.
+// Preconditions:   None.
+// Postconditions:  Returns -2048 - 2047.
+//----------------------------------------------------------------------
+static int toCounts(float value, float lsb) {
+	long counts = lroundf(value * lsb);
+	return counts < -2048 ? -2048 : (counts > 2047 ? 2047 : (int)counts);
+}
+
+//-------------------------- LSM303 Unified ----------------------------
+Adafruit_LSM303_Unified::Adafruit_LSM303_Unified(int32_t sensorID, uint8_t address) {
+	_sensorID = sensorID;
+	_address = address;
+	_reading.x = _reading.y = _reading.z = 0;
+	_reads = 0;
+	memset(_regs, 0, sizeof(_regs));
+	_pointer = 0;
+	_autoIncrement = false;
+	_fifoLevel = 0;
+	_fifoTime = 0;
+}
+
+// the driver's defaults: accelerometer 100 Hz normal mode, magnetometer
+// continuous at +-1.3 gauss
+bool Adafruit_LSM303_Unified::begin() {
+	Wire.begin();
+	memset(_regs, 0, sizeof(_regs));
+	_fifoLevel = 0;
+	_fifoTime = shim_getMicros();
+	if (_address == LSM303_ADDRESS_ACCEL) {
+		_regs[LSM303_REGISTER_ACCEL_CTRL_REG1_A] = 0x57;
+		s_accel = this;
+		Wire.attachDevice(_address, accelReceive, accelTransmit);
+	}
+	else {
+		_regs[LSM303_REGISTER_MAG_CRA_REG_M] = 0x10;
+		_regs[LSM303_REGISTER_MAG_CRB_REG_M] = 0x20;
+		s_mag = this;
+		Wire.attachDevice(_address, magReceive, magTransmit);
+	}
+	return true;
+}
+
+// the two byte register address is written, then six data bytes read
+bool Adafruit_LSM303_Unified::getEvent(sensors_event_t *event) {
+	Wire.chargeBytes(LSM303_READ_BYTES);
+	_reads++;
+	
+	memset(event, 0, sizeof(*event));
+	event->version = sizeof(sensors_event_t);
+	event->sensor_id = _sensorID;
+	event->timestamp = millis();
+	event->acceleration = _reading; // shares storage with magnetic
+	return true;
+}
+
+void Adafruit_LSM303_Unified::setReading(float x, float y, float z) {
+	_reading.x = x;
+	_reading.y = y;
+	_reading.z = z;
+}
+
+unsigned long Adafruit_LSM303_Unified::getReads() {
+	return _reads;
+}
+
+// counts the samples taken since the last update while the FIFO streams
+void Adafruit_LSM303_Unified::updateFifo() {
+	unsigned long long now = shim_getMicros();
+	unsigned int rate = ACCEL_RATES[_regs[LSM303_REGISTER_ACCEL_CTRL_REG1_A] >> 4];
+	bool streaming = (_regs[LSM303_REGISTER_ACCEL_CTRL_REG5_A] & 0x40) &&
+			(_regs[LSM303_REGISTER_ACCEL_FIFO_CTRL_REG_A] & 0xC0) == 0x80;
+	if (_address != LSM303_ADDRESS_ACCEL || !streaming || rate == 0) {
+		_fifoLevel = 0;
+		_fifoTime = now;
+		return;
+	}
+	
+	unsigned long long period = 1000000ULL / rate;
+	unsigned long long samples = (now - _fifoTime) / period;
+	_fifoTime += samples * period;
+	unsigned long long room = LSM303_FIFO_SIZE - _fifoLevel;
+	_fifoLevel = samples >= room ? LSM303_FIFO_SIZE : _fifoLevel + samples;
+}
+
+uint8_t Adafruit_LSM303_Unified::readRegister(uint8_t reg) {
+	if (_address == LSM303_ADDRESS_ACCEL) {
+		if (reg >= LSM303_REGISTER_ACCEL_OUT_X_L_A && reg <= LSM303_REGISTER_ACCEL_OUT_Z_H_A) {
+			// 1 mg per LSB, left justified
+			const float *axes[3] = { &_reading.x, &_reading.y, &_reading.z };
+			uint8_t offset = reg - LSM303_REGISTER_ACCEL_OUT_X_L_A;
+			uint16_t raw = toCounts(*axes[offset / 2], 1000 / SENSORS_GRAVITY_STANDARD) * 16;
+			return offset % 2 ? raw >> 8 : raw & 0xFF;
+		}
+		if (reg == LSM303_REGISTER_ACCEL_FIFO_SRC_REG_A) {
+			updateFifo();
+			if (_fifoLevel == 0)
+				return 0x20; // EMPTY
+			return (_fifoLevel == LSM303_FIFO_SIZE ? 0x40 : 0) | min(_fifoLevel, (uint8_t)31);
+		}
+	}
+	else if (reg >= LSM303_REGISTER_MAG_OUT_X_H_M && reg <= LSM303_REGISTER_MAG_OUT_Y_L_M) {
+		// X, Z, Y big endian at the gain in CRB
+		uint8_t gain = _regs[LSM303_REGISTER_MAG_CRB_REG_M] >> 5;
+		const float *axes[3] = { &_reading.x, &_reading.z, &_reading.y };
+		const unsigned int lsb[3] = { MAG_LSB_XY[gain], MAG_LSB_Z[gain], MAG_LSB_XY[gain] };
+		uint8_t offset = reg - LSM303_REGISTER_MAG_OUT_X_H_M;
+		uint16_t raw = toCounts(*axes[offset / 2], lsb[offset / 2] / 100.0F); // uT to gauss
+		return offset % 2 ? raw & 0xFF : raw >> 8;
+	}
+	return _regs[reg & 0x3F];
+}
+
+// the register address, then data written from there on
+void Adafruit_LSM303_Unified::receive(const uint8_t *data, uint8_t len) {
+	if (len == 0)
+		return;
+	updateFifo();
+	_pointer = data[0] & 0x3F;
+	_autoIncrement = _address == LSM303_ADDRESS_MAG || (data[0] & 0x80);
+	for (uint8_t i = 1; i < len; i++) {
+		_regs[_pointer] = data[i];
+		if (_autoIncrement)
+			_pointer = (_pointer + 1) & 0x3F;
+	}
+	if (len > 1)
+		updateFifo(); // a new mode starts empty
+}
+
+// reads from the register pointer on, the accelerometer's outputs roll
+// over to X and pop the FIFO in stream mode
+void Adafruit_LSM303_Unified::transmit(uint8_t *data, uint8_t len) {
+	for (uint8_t i = 0; i < len; i++) {
+		data[i] = readRegister(_pointer);
+		if (!_autoIncrement)
+			continue;
+		if (_address == LSM303_ADDRESS_ACCEL && _pointer == LSM303_REGISTER_ACCEL_OUT_Z_H_A &&
+				(_regs[LSM303_REGISTER_ACCEL_FIFO_CTRL_REG_A] & 0xC0) != 0) {
+			updateFifo();
+			if (_fifoLevel > 0)
+				_fifoLevel--;
+			_pointer = LSM303_REGISTER_ACCEL_OUT_X_L_A;
+		}
+		else {
+			_pointer = (_pointer + 1) & 0x3F;
+		}
+	}
+}
@@ -0,0 +1,87 @@
+//------------------------- Adafruit_LSM303_U --------------------------
+// Filename:      	Adafruit_LSM303_U.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Host shim for the Adafruit LSM303 unified driver. 
+//					Events return the values set by the host and each
+//					read costs the I2C time of the real register reads.
+//					After begin() the sensors also answer register reads
+//					on Wire with the same values as raw LSM303DLHC data:
+//					accelerometer at +-2 g (auto-increment with bit 7 of
+//					the register, FIFO in stream mode), magnetometer at
+//					the gain in CRB_REG_M.
+//------------------------------ Includes ------------------------------
+#ifndef _Adafruit_LSM303_U_h_
+#define _Adafruit_LSM303_U_h_
+
+#include "Adafruit_Sensor.h"
+#include "Wire.h"
+
+//---------------------------- Definitions -----------------------------
+#define LSM303_READ_BYTES 10 // address + register, address + 6 data bytes, restart
+
+#define LSM303_ADDRESS_ACCEL (0x32 >> 1)
+#define LSM303_ADDRESS_MAG (0x3C >> 1)
+#define LSM303_FIFO_SIZE 32
+
+// Registers of the real driver that the shim models
+typedef enum {
+	LSM303_REGISTER_ACCEL_CTRL_REG1_A = 0x20,
+	LSM303_REGISTER_ACCEL_CTRL_REG4_A = 0x23,
+	LSM303_REGISTER_ACCEL_CTRL_REG5_A = 0x24,
+	LSM303_REGISTER_ACCEL_OUT_X_L_A = 0x28,
+	LSM303_REGISTER_ACCEL_OUT_Z_H_A = 0x2D,
+	LSM303_REGISTER_ACCEL_FIFO_CTRL_REG_A = 0x2E,
+	LSM303_REGISTER_ACCEL_FIFO_SRC_REG_A = 0x2F
+} lsm303AccelRegisters_t;
+
+typedef enum {
+	LSM303_REGISTER_MAG_CRA_REG_M = 0x00,
+	LSM303_REGISTER_MAG_CRB_REG_M = 0x01,
+	LSM303_REGISTER_MAG_MR_REG_M = 0x02,
+	LSM303_REGISTER_MAG_OUT_X_H_M = 0x03,
+	LSM303_REGISTER_MAG_OUT_Y_L_M = 0x08
+} lsm303MagRegisters_t;
+
+//-------------------------- LSM303 Unified ----------------------------
+class Adafruit_LSM303_Unified : public Adafruit_Sensor {
+public:
+	Adafruit_LSM303_Unified(int32_t sensorID, uint8_t address);
+	bool begin();
+	bool getEvent(sensors_event_t *event);
+	
+	// Host interface
+	void setReading(float x, float y, float z);
+	unsigned long getReads();
+	
+	// Wire device
+	void receive(const uint8_t *data, uint8_t len);
+	void transmit(uint8_t *data, uint8_t len);
+
+private:
+	uint8_t readRegister(uint8_t reg);
+	void updateFifo();
+	
+	int32_t _sensorID;
+	uint8_t _address;
+	sensors_vec_t _reading;
+	unsigned long _reads;
+	uint8_t _regs[0x40];
+	uint8_t _pointer;				// register of the next read
+	bool _autoIncrement;
+	uint8_t _fifoLevel;				// accelerometer samples in the FIFO
+	unsigned long long _fifoTime;	// virtual us of the last sample counted
+};
+
+class Adafruit_LSM303_Accel_Unified : public Adafruit_LSM303_Unified {
+public:
+	Adafruit_LSM303_Accel_Unified(int32_t sensorID = -1) : Adafruit_LSM303_Unified(sensorID, LSM303_ADDRESS_ACCEL) {}
+};
+
+class Adafruit_LSM303_Mag_Unified : public Adafruit_LSM303_Unified {
+public:
+	Adafruit_LSM303_Mag_Unified(int32_t sensorID = -1) : Adafruit_LSM303_Unified(sensorID, LSM303_ADDRESS_MAG) {}
+};
+
+#endif
@@ -0,0 +1,146 @@
+//------------------------ Adafruit_MotorShield ------------------------
+// Filename:      	Adafruit_MotorShield.cpp
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Host shim for the Adafruit Motor Shield v2.
+//----------------------------------------------------------------------
+#include "Adafruit_MotorShield.h"
+
+#include <string.h>
+
+//---------------------------- Initialization --------------------------
+// PWM, IN2 and IN1 channels of M1 - M4 as wired on the shield
+static const uint8_t s_pins[4][3] = { { 8, 9, 10 }, { 13, 12, 11 }, { 2, 3, 4 }, { 7, 6, 5 } };
+
+// The shield that began last receives the transmissions to its address
+static Adafruit_MotorShield *s_shield = NULL;
+
+static void shieldReceive(const uint8_t *data, uint8_t len) {
+	s_shield->receive(data, len);
+}
+
+//--------------------------- Adafruit_DCMotor -------------------------
+Adafruit_DCMotor::Adafruit_DCMotor() {
+	_shield = NULL;
+	_pwm = _in1 = _in2 = 0;
+}
+
+// the real driver sets both H-bridge pins, two setPWM transfers
+void Adafruit_DCMotor::run(uint8_t cmd) {
+	switch (cmd) {
+		case FORWARD:
+			_shield->setPin(_in2, false);
+			_shield->setPin(_in1, true);
+			break;
+		case BACKWARD:
+			_shield->setPin(_in1, false);
+			_shield->setPin(_in2, true);
+			break;
+		case RELEASE:
+			_shield->setPin(_in1, false);
+			_shield->setPin(_in2, false);
+			break;
+		case BRAKE:
+			_shield->setPin(_in1, true);
+			_shield->setPin(_in2, true);
+			break;
+	}
+}
+
+// one setPWM transfer for the speed pin
+void Adafruit_DCMotor::setSpeed(uint8_t speed) {
+	_shield->setPWM(_pwm, speed * 16);
+}
+
+uint8_t Adafruit_DCMotor::getSpeed() {
+	uint16_t duty = _shield->getChannel(_pwm);
+	return duty >= 4096 ? 255 : duty / 16;
+}
+
+uint8_t Adafruit_DCMotor::getDirection() {
+	bool in1 = _shield->getChannel(_in1) >= 4096;
+	bool in2 = _shield->getChannel(_in2) >= 4096;
+	if (in1 && in2)
+		return BRAKE;
+	if (in1)
+		return FORWARD;
+	if (in2)
+		return BACKWARD;
+	return RELEASE;
+}
+
+//------------------------ Adafruit_MotorShield ------------------------
+// every channel starts full off like a PCA9685 after power up
+Adafruit_MotorShield::Adafruit_MotorShield(uint8_t addr) {
+	_addr = addr;
+	memset(_regs, 0, sizeof(_regs));
+	for (int pin = 0; pin < 16; pin++)
+		_regs[LED0_ON_L + 4 * pin + 3] = 0x10;
+}
+
+void Adafruit_MotorShield::begin(uint16_t freq) {
+	(void)freq;
+	Wire.begin();
+	s_shield = this;
+	Wire.attachDevice(_addr, shieldReceive);
+}
+
+// motors are numbered 1 - 4 like the real shield
+Adafruit_DCMotor *Adafruit_MotorShield::getMotor(uint8_t n) {
+	if (n < 1 || n > 4)
+		return NULL;
+	
+	Adafruit_DCMotor *motor = &_motors[n - 1];
+	motor->_shield = this;
+	motor->_pwm = s_pins[n - 1][0];
+	motor->_in2 = s_pins[n - 1][1];
+	motor->_in1 = s_pins[n - 1][2];
+	return motor;
+}
+
+void Adafruit_MotorShield::setPWM(uint8_t pin, uint16_t val) {
+	if (val > 4095)
+		writePWM(pin, 4096, 0);
+	else
+		writePWM(pin, 0, val);
+}
+
+void Adafruit_MotorShield::setPin(uint8_t pin, bool val) {
+	if (val)
+		writePWM(pin, 4096, 0);
+	else
+		writePWM(pin, 0, 0);
+}
+
+// full off wins over full on, otherwise the duty assumes ON = 0
+uint16_t Adafruit_MotorShield::getChannel(uint8_t pin) {
+	const uint8_t *reg = &_regs[LED0_ON_L + 4 * pin];
+	uint16_t on = reg[0] | (reg[1] << 8);
+	uint16_t off = reg[2] | (reg[3] << 8);
+	if (off & 0x1000)
+		return 0;
+	if (on & 0x1000)
+		return 4096;
+	return off & 0xFFF;
+}
+
+// register address then data, auto-incremented
+void Adafruit_MotorShield::receive(const uint8_t *data, uint8_t len) {
+	if (len == 0)
+		return;
+	uint8_t reg = data[0];
+	for (uint8_t i = 1; i < len; i++)
+		_regs[reg++] = data[i];
+}
+
+// one transmission like Adafruit_MS_PWMServoDriver::setPWM
+void Adafruit_MotorShield::writePWM(uint8_t pin, uint16_t on, uint16_t off) {
+	Wire.beginTransmission(_addr);
+	Wire.write(LED0_ON_L + 4 * pin);
+	Wire.write(on);
+	Wire.write(on >> 8);
+	Wire.write(off);
+	Wire.write(off >> 8);
+	Wire.endTransmission();
+}
@@ -0,0 +1,66 @@
+//------------------------ Adafruit_MotorShield ------------------------
+// Filename:      	Adafruit_MotorShield.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Host shim for the Adafruit Motor Shield v2. The
+//					shield keeps the LED registers of its PCA9685, written
+//					by the motors like the real driver does or directly
+//					over Wire, and the motors read their speed and
+//					direction back from them.
+//------------------------------ Includes ------------------------------
+#ifndef _Adafruit_MotorShield_h_
+#define _Adafruit_MotorShield_h_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Wire.h"
+
+//---------------------------- Definitions -----------------------------
+#define FORWARD 1
+#define BACKWARD 2
+#define BRAKE 3
+#define RELEASE 4
+
+#define LED0_ON_L 0x06 // named like the real library, 4 registers per channel
+
+class Adafruit_MotorShield;
+
+//--------------------------- Adafruit_DCMotor -------------------------
+class Adafruit_DCMotor {
+public:
+	Adafruit_DCMotor();
+	void run(uint8_t cmd);
+	void setSpeed(uint8_t speed);
+	
+	// Host interface
+	uint8_t getSpeed();
+	uint8_t getDirection();
+
+private:
+	friend class Adafruit_MotorShield;
+	Adafruit_MotorShield *_shield;
+	uint8_t _pwm, _in1, _in2;	// PCA9685 channels
+};
+
+//------------------------ Adafruit_MotorShield ------------------------
+class Adafruit_MotorShield {
+public:
+	Adafruit_MotorShield(uint8_t addr = 0x60);
+	void begin(uint16_t freq = 1600);
+	Adafruit_DCMotor *getMotor(uint8_t n);
+	void setPWM(uint8_t pin, uint16_t val);
+	void setPin(uint8_t pin, bool val);
+	
+	// Host interface
+	uint16_t getChannel(uint8_t pin); 	// 0 - 4095 duty, 4096 full on
+	void receive(const uint8_t *data, uint8_t len);
+
+private:
+	uint8_t _addr;
+	uint8_t _regs[256];
+	Adafruit_DCMotor _motors[4];
+	void writePWM(uint8_t pin, uint16_t on, uint16_t off);
+};
+
+#endif
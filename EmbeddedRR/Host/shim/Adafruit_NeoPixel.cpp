@@ -0,0 +1,80 @@
+//------------------------- Adafruit_NeoPixel --------------------------
+// Filename:      	Adafruit_NeoPixel.cpp
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Host shim for an Adafruit NeoPixel strip.
+//----------------------------------------------------------------------
+#include "Adafruit_NeoPixel.h"
+#include "shim.h"
+
+//------------------------- Adafruit_NeoPixel --------------------------
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, uint8_t pin, neoPixelType type) :
+		_pixels(n, 0), _shown(n, 0) {
+	(void)pin;
+	(void)type;
+	_brightness = 0;
+	_shows = 0;
+	_pixelWrites = 0;
+}
+
+void Adafruit_NeoPixel::begin() {
+}
+
+// every pixel is clocked out again on each show, changed or not
+void Adafruit_NeoPixel::show() {
+	shim_advanceMicros(_pixels.size() * NEO_PIXEL_US + NEO_LATCH_US);
+	_shown = _pixels;
+	_shows++;
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) {
+	setPixelColor(n, Color(r, g, b));
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint32_t c) {
+	if (n < _pixels.size()) {
+		_pixels[n] = c;
+		_pixelWrites++;
+	}
+}
+
+void Adafruit_NeoPixel::setBrightness(uint8_t brightness) {
+	_brightness = brightness;
+}
+
+void Adafruit_NeoPixel::clear() {
+	for (size_t i = 0; i < _pixels.size(); i++)
+		_pixels[i] = 0;
+}
+
+uint32_t Adafruit_NeoPixel::getPixelColor(uint16_t n) const {
+	return n < _pixels.size() ? _pixels[n] : 0;
+}
+
+uint16_t Adafruit_NeoPixel::numPixels() const {
+	return _pixels.size();
+}
+
+uint32_t Adafruit_NeoPixel::Color(uint8_t r, uint8_t g, uint8_t b) {
+	return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+uint32_t Adafruit_NeoPixel::getShownColor(uint16_t n) const {
+	return n < _shown.size() ? _shown[n] : 0;
+}
+
+unsigned long Adafruit_NeoPixel::getShows() const {
+	return _shows;
+}
+
+unsigned long Adafruit_NeoPixel::getPixelWrites() const {
+	return _pixelWrites;
+}
+
+void Adafruit_NeoPixel::reset() {
+	clear();
+	_shown = _pixels;
+	_shows = 0;
+	_pixelWrites = 0;
+}
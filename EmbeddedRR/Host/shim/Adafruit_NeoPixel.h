@@ -0,0 +1,55 @@
+//------------------------- Adafruit_NeoPixel --------------------------
+// Filename:      	Adafruit_NeoPixel.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Host shim for an Adafruit NeoPixel strip. Colors are
+//					recorded and show() costs the time the real driver
+//					spends bit banging the strip with interrupts off.
+//------------------------------ Includes ------------------------------
+#ifndef _Adafruit_NeoPixel_h_
+#define _Adafruit_NeoPixel_h_
+
+#include <stdint.h>
+#include <vector>
+
+//---------------------------- Definitions -----------------------------
+#define NEO_RGB ((0 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_GRB ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_KHZ800 0x0000
+#define NEO_KHZ400 0x0100
+
+#define NEO_PIXEL_US 30 	// 24 bits at 800 kHz per pixel
+#define NEO_LATCH_US 50 	// reset time after the last pixel
+
+typedef uint16_t neoPixelType;
+
+//------------------------- Adafruit_NeoPixel --------------------------
+class Adafruit_NeoPixel {
+public:
+	Adafruit_NeoPixel(uint16_t n, uint8_t pin = 6, neoPixelType type = NEO_GRB + NEO_KHZ800);
+	void begin();
+	void show();
+	void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b);
+	void setPixelColor(uint16_t n, uint32_t c);
+	void setBrightness(uint8_t brightness);
+	void clear();
+	uint32_t getPixelColor(uint16_t n) const;
+	uint16_t numPixels() const;
+	static uint32_t Color(uint8_t r, uint8_t g, uint8_t b);
+	
+	// Host interface
+	uint32_t getShownColor(uint16_t n) const;
+	unsigned long getShows() const;
+	unsigned long getPixelWrites() const;
+	void reset();
+
+private:
+	std::vector<uint32_t> _pixels;	// colors set since the last show
+	std::vector<uint32_t> _shown;	// colors on the strip
+	uint8_t _brightness;
+	unsigned long _shows;
+	unsigned long _pixelWrites;
+};
+
+#endif
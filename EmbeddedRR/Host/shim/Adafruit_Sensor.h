@@ -0,0 +1,43 @@
+//-------------------------- Adafruit_Sensor ---------------------------
+// Filename:      	Adafruit_Sensor.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Host shim for the Adafruit unified sensor types. Only
+//					the event fields used by the rover library exist.
+//------------------------------ Includes ------------------------------
+#ifndef _Adafruit_Sensor_h_
+#define _Adafruit_Sensor_h_
+
+#include <stdint.h>
+
+//---------------------------- Definitions -----------------------------
+#define SENSORS_GRAVITY_STANDARD 9.80665F
+
+typedef struct {
+	float x;
+	float y;
+	float z;
+} sensors_vec_t;
+
+typedef struct {
+	int32_t version;
+	int32_t sensor_id;
+	int32_t type;
+	int32_t reserved0;
+	int32_t timestamp;
+	union {
+		sensors_vec_t acceleration;	// m/s^2
+		sensors_vec_t magnetic;		// uT
+	};
+} sensors_event_t;
+
+//-------------------------- Adafruit_Sensor ---------------------------
+class Adafruit_Sensor {
+public:
+	virtual ~Adafruit_Sensor() {}
+	virtual bool getEvent(sensors_event_t *event) = 0;
+	virtual void enableAutoRange(bool enabled) { (void)enabled; }
+};
+
+#endif
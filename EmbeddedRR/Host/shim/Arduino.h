@@ -0,0 +1,97 @@
+//------------------------------ Arduino -------------------------------
+// Filename:      	Arduino.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Host shim for the parts of the Arduino core used by
+//					the rover library. Time is virtual and only moves
+//					when the host advances it (see shim.h) or when the
+//					code under test blocks in delay(), polls an idle
+//					serial port or touches a pin. Port registers group
+//					8 consecutive pins, not the Mega's wiring. Pin change
+//					interrupts only exist for the port of pins 48 - 55
+//					(PCINT0_vect) and only fire on the falling edge of a
+//					decaying pin (see shim_setPinDecay).
+//------------------------------ Includes ------------------------------
+#ifndef _Arduino_h_
+#define _Arduino_h_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//---------------------------- Definitions -----------------------------
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define PIN_ACCESS_US 3		// virtual cost of pinMode/digitalWrite/digitalRead
+#define PORT_ACCESS_US 1	// virtual cost of a port register access
+
+#define LED_BUILTIN 13
+#define NUM_DIGITAL_PINS 70 // Arduino Mega
+
+#define A0 54
+
+#define NOT_A_PORT 0
+#define SHIM_PORTS (NUM_DIGITAL_PINS / 8 + 2)
+#define digitalPinToPort(P) ((P) < NUM_DIGITAL_PINS ? (P) / 8 + 1 : NOT_A_PORT)
+#define digitalPinToBitMask(P) ((uint8_t)(1 << ((P) % 8)))
+#define portInputRegister(P) shim_portRegister((P), 0)
+#define portModeRegister(P) shim_portRegister((P), 1)
+#define portOutputRegister(P) shim_portRegister((P), 2)
+
+#define _BV(B) (1 << (B))
+#define PCIE0 0
+#define SHIM_PCINT_PORT digitalPinToPort(48)
+#define digitalPinToPCICR(P) (digitalPinToPort(P) == SHIM_PCINT_PORT ? &PCICR : (volatile uint8_t *)0)
+#define digitalPinToPCICRbit(P) PCIE0
+#define digitalPinToPCMSK(P) (digitalPinToPort(P) == SHIM_PCINT_PORT ? &PCMSK0 : (volatile uint8_t *)0)
+#define digitalPinToPCMSKbit(P) ((P) % 8)
+
+// handlers are plain functions the shim calls at the virtual time of the edge
+#define ISR(vector) extern "C" void vector()
+#define PCINT0_vect shim_pcint0
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+template <typename T> inline T min(T a, T b) { return a < b ? a : b; }
+template <typename T> inline T max(T a, T b) { return a > b ? a : b; }
+template <typename T> inline T constrain(T x, T low, T high) { return x < low ? low : (x > high ? high : x); }
+
+//------------------------------ Functions -----------------------------
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+void noInterrupts();
+void interrupts();
+
+extern volatile uint8_t PCICR;	// pin change interrupt enables
+extern volatile uint8_t PCMSK0; // pins of PCINT0_vect
+
+// PIN (0), DDR (1) or PORT (2) register of a port, refreshed from the
+// pins; writes through the pointer are picked up at the next pin access
+volatile uint8_t *shim_portRegister(uint8_t port, uint8_t reg);
+
+char *dtostrf(double val, signed char width, unsigned char prec, char *buf);
+
+#include "WString.h"
+#include "HardwareSerial.h"
+
+#endif
@@ -0,0 +1,75 @@
+//--------------------------- HardwareSerial ---------------------------
+// Filename:      	HardwareSerial.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Host shim for the Arduino hardware serial port. 
+//					Received bytes are injected by the host and arrive 
+//					at the configured baud rate into a 64 byte ring 
+//					buffer that overflows like the real one. Written 
+//					bytes are collected and handed to a host callback 
+//					on flush(), which also blocks for the time the bytes
+//					take on the wire.
+//------------------------------ Includes ------------------------------
+#ifndef _HardwareSerial_h_
+#define _HardwareSerial_h_
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
+#include "Stream.h"
+
+//---------------------------- Definitions -----------------------------
+#define SERIAL_RX_BUFFER_SIZE 64
+#define SERIAL_POLL_US 4 			// virtual cost of polling an idle port
+
+typedef void (*SerialTxHandler)(const uint8_t *data, size_t len);
+
+//--------------------------- HardwareSerial ---------------------------
+class HardwareSerial : public Stream {
+public:
+	HardwareSerial();
+	
+	// Arduino interface
+	void begin(unsigned long baud);
+	void end();
+	int available();
+	int read();
+	int peek();
+	void flush();
+	size_t write(uint8_t val);
+	using Print::write;
+	operator bool() { return true; }
+	
+	// Host interface
+	void inject(const uint8_t *data, size_t len, unsigned long long atMicros);
+	void setTxHandler(SerialTxHandler handler);
+	unsigned long long getLineFree();
+	unsigned long getOverflows();
+	unsigned long getTxBytes();
+	void reset();
+
+private:
+	struct PendingByte {
+		unsigned long long ready;	// virtual time the byte has arrived
+		uint8_t val;
+	};
+	
+	void receive();
+	
+	unsigned long _byteMicros;		// time for one byte on the wire
+	std::deque<PendingByte> _pending;
+	uint8_t _rx[SERIAL_RX_BUFFER_SIZE];
+	unsigned int _rxHead;
+	unsigned int _rxCount;
+	unsigned long long _lineFree;	// virtual time the rx line is idle
+	unsigned long _overflows;
+	std::vector<uint8_t> _tx;
+	unsigned long _txBytes;
+	SerialTxHandler _txHandler;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,41 @@
+//------------------------------- Print --------------------------------
+// Filename:      	Print.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Host shim for the Arduino Print class. Only the 
+//					overloads used by the rover code are provided.
+//------------------------------ Includes ------------------------------
+#ifndef _Print_h_
+#define _Print_h_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "WString.h"
+
+//------------------------------- Print --------------------------------
+class Print {
+public:
+	virtual ~Print() {}
+	virtual size_t write(uint8_t val) = 0;
+	virtual size_t write(const uint8_t *buffer, size_t size);
+	size_t write(const char *str);
+	
+	size_t print(const char *str);
+	size_t print(const String &str) { return print(str.c_str()); }
+	size_t print(char c);
+	size_t print(long n, int base = 10);
+	size_t print(unsigned long n, int base = 10);
+	size_t print(int n, int base = 10) { return print((long)n, base); }
+	size_t print(unsigned int n, int base = 10) { return print((unsigned long)n, base); }
+	size_t print(unsigned char n, int base = 10) { return print((unsigned long)n, base); }
+	size_t print(double n, int digits = 2);
+	
+	size_t println();
+	size_t println(const String &str) { size_t n = print(str); return n + println(); }
+	template <typename T> size_t println(T val) { size_t n = print(val); return n + println(); }
+	template <typename T> size_t println(T val, int format) { size_t n = print(val, format); return n + println(); }
+};
+
+#endif
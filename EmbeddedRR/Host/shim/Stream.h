@@ -0,0 +1,22 @@
+//------------------------------- Stream -------------------------------
+// Filename:      	Stream.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Host shim for the Arduino Stream class.
+//------------------------------ Includes ------------------------------
+#ifndef _Stream_h_
+#define _Stream_h_
+
+#include "Print.h"
+
+//------------------------------- Stream -------------------------------
+class Stream : public Print {
+public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+	virtual void flush() = 0;
+};
+
+#endif
@@ -0,0 +1,37 @@
+//------------------------------ WString -------------------------------
+// Filename:      	WString.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Host shim for the Arduino String class. Only
+//					construction from text and numbers, concatenation
+//					and c_str() are provided.
+//------------------------------ Includes ------------------------------
+#ifndef _WString_h_
+#define _WString_h_
+
+#include <string>
+
+//------------------------------- String -------------------------------
+class String {
+public:
+	String(const char *str = "") : _str(str) {}
+	String(char c) : _str(1, c) {}
+	String(int n) : _str(std::to_string(n)) {}
+	String(unsigned int n) : _str(std::to_string(n)) {}
+	String(long n) : _str(std::to_string(n)) {}
+	String(unsigned long n) : _str(std::to_string(n)) {}
+	
+	const char *c_str() const { return _str.c_str(); }
+	unsigned int length() const { return _str.length(); }
+	
+	String &operator+=(const String &rhs) { _str += rhs._str; return *this; }
+	friend String operator+(const String &lhs, const String &rhs) { String s(lhs); s += rhs; return s; }
+	friend String operator+(const char *lhs, const String &rhs) { String s(lhs); s += rhs; return s; }
+	friend String operator+(const String &lhs, const char *rhs) { String s(lhs); s += String(rhs); return s; }
+
+private:
+	std::string _str;
+};
+
+#endif
@@ -0,0 +1,64 @@
+//-------------------------------- Wire --------------------------------
+// Filename:      	Wire.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Host shim for the Arduino I2C bus. Only the bus 
+//					clock is modelled; drivers charge virtual time per
+//					byte with chargeBytes. Transmissions and requests
+//					are charged the same way and handed to the device
+//					attached at the address.
+//------------------------------ Includes ------------------------------
+#ifndef _Wire_h_
+#define _Wire_h_
+
+#include <stdint.h>
+#include <stddef.h>
+
+//---------------------------- Definitions -----------------------------
+#define BUFFER_LENGTH 32 // transmit buffer of the AVR Wire library
+
+// Receives the bytes of a transmission to its address
+typedef void (*WireDevice)(const uint8_t *data, uint8_t len);
+
+// Fills the bytes of a request from its address
+typedef void (*WireSource)(uint8_t *data, uint8_t len);
+
+//-------------------------------- Wire --------------------------------
+class TwoWire {
+public:
+	TwoWire();
+	void begin();
+	void setClock(uint32_t clock);
+	uint32_t getClock();
+	void beginTransmission(uint8_t address);
+	size_t write(uint8_t data);
+	uint8_t endTransmission();
+	uint8_t requestFrom(uint8_t address, uint8_t quantity);
+	int available();
+	int read();
+	
+	// Host interface
+	void chargeBytes(unsigned int bytes);
+	unsigned long getBytes();
+	unsigned long getTransmissions();
+	void attachDevice(uint8_t address, WireDevice device, WireSource source = NULL);
+
+private:
+	uint32_t _clock;
+	unsigned long _bytes;
+	unsigned long _remainder;		// sub-microsecond bus time carried over
+	unsigned long _transmissions;
+	uint8_t _address;
+	uint8_t _buffer[BUFFER_LENGTH];
+	uint8_t _length;
+	WireDevice _devices[128];		// by 7-bit address
+	WireSource _sources[128];
+	uint8_t _rx[BUFFER_LENGTH];		// bytes of the last request
+	uint8_t _rxLength;
+	uint8_t _rxIndex;
+};
+
+extern TwoWire Wire;
+
+#endif
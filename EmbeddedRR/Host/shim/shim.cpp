@@ -0,0 +1,558 @@
+//-------------------------------- shim --------------------------------
+// Filename:      	shim.cpp
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Virtual clock, pins, Print, Serial and Wire for the
+//					host build of the rover library.
+//----------------------------------------------------------------------
+#include <stdio.h>
+
+#include "shim.h"
+#include "Wire.h"
+
+//---------------------------- Initialization --------------------------
+static unsigned long long s_micros = 0; 		// virtual clock
+static uint8_t s_pins[NUM_DIGITAL_PINS]; 		// last value written per pin
+static uint8_t s_modes[NUM_DIGITAL_PINS]; 		// INPUT or OUTPUT per pin
+static unsigned long s_decay[NUM_DIGITAL_PINS]; // us a released pin reads HIGH
+static unsigned long long s_released[NUM_DIGITAL_PINS]; // when it was released
+static volatile uint8_t s_ports[3][SHIM_PORTS]; // PIN, DDR and PORT registers
+static bool s_portsLent = false; 				// DDR or PORT handed out since the last sync
+static bool s_edgeDue[NUM_DIGITAL_PINS]; 		// released pin has not fallen yet
+static bool s_interrupts = true; 				// between interrupts() and noInterrupts()
+static bool s_inInterrupt = false; 				// a handler is running
+volatile uint8_t PCICR = 0;
+volatile uint8_t PCMSK0 = 0;
+
+// handler of the code under test, if it has one
+extern "C" void shim_pcint0() __attribute__((weak));
+
+HardwareSerial Serial;
+TwoWire Wire;
+
+//------------------------------ Interrupts ----------------------------
+//----------------------------------------------------------------------
+// nextEdge ------- Finds the earliest falling edge that raises PCINT0_vect
+//					by end. Edges of pins that are not enabled are lost,
+//					like on the chip.
+// Preconditions:   None.
+// Postconditions:  Returns true with its time in edge, which may be in
+//					the past when interrupts were off.
+//----------------------------------------------------------------------
+static bool nextEdge(unsigned long long end, unsigned long long *edge) {
+	bool found = false;
+	for (uint8_t bit = 0; bit < 8; bit++) {
+		uint8_t pin = (SHIM_PCINT_PORT - 1) * 8 + bit;
+		if (!s_edgeDue[pin] || s_modes[pin] == OUTPUT || s_decay[pin] == 0)
+			continue;
+		unsigned long long t = s_released[pin] + s_decay[pin];
+		if (t > end)
+			continue;
+		if (!(PCICR & _BV(PCIE0)) || !(PCMSK0 & _BV(bit))) {
+			s_edgeDue[pin] = false;
+			continue;
+		}
+		if (!found || t < *edge)
+			*edge = t;
+		found = true;
+	}
+	return found;
+}
+
+//----------------------------------------------------------------------
+// advance -------- Moves the virtual clock forward, running the pin change
+//					handler at each falling edge on the way.
+// Preconditions:   None.
+// Postconditions:  The clock is us later plus the time spent in handlers.
+//----------------------------------------------------------------------
+static void advance(unsigned long long us) {
+	unsigned long long end = s_micros + us;
+	unsigned long long edge = 0; // set by nextEdge
+	while (s_interrupts && !s_inInterrupt && shim_pcint0 != NULL && nextEdge(end, &edge)) {
+		for (uint8_t bit = 0; bit < 8; bit++) {
+			uint8_t pin = (SHIM_PCINT_PORT - 1) * 8 + bit;
+			if (s_edgeDue[pin] && s_released[pin] + s_decay[pin] <= edge)
+				s_edgeDue[pin] = false;
+		}
+		if (edge > s_micros)
+			s_micros = edge;
+		
+		unsigned long long entered = s_micros;
+		s_inInterrupt = true;
+		shim_pcint0();
+		s_inInterrupt = false;
+		end += s_micros - entered; // the handler delays the interrupted code
+	}
+	s_micros = end;
+}
+
+void noInterrupts() {
+	s_interrupts = false;
+}
+
+// edges that came in while interrupts were off are handled now
+void interrupts() {
+	s_interrupts = true;
+	advance(0);
+}
+
+//------------------------------ Host Functions ------------------------
+//----------------------------------------------------------------------
+// shim_getMicros - Getter for the virtual clock.
+// Preconditions:   None.
+// Postconditions:  Returns microseconds since the shim was reset.
+//----------------------------------------------------------------------
+unsigned long long shim_getMicros() {
+	return s_micros;
+}
+
+//----------------------------------------------------------------------
+// shim_advanceMicros Moves the virtual clock forward.
+// Preconditions:   None.
+// Postconditions:  The virtual clock is us microseconds later.
+//----------------------------------------------------------------------
+void shim_advanceMicros(unsigned long long us) {
+	advance(us);
+}
+
+//----------------------------------------------------------------------
+// shim_reset ----- Resets the virtual clock, pins and serial port.
+// Preconditions:   None.
+// Postconditions:  Virtual clock is 0, pins are LOW inputs without decay
+//					and Serial is empty.
+//----------------------------------------------------------------------
+void shim_reset() {
+	s_micros = 0;
+	memset(s_pins, 0, sizeof(s_pins));
+	memset(s_modes, 0, sizeof(s_modes));
+	memset(s_decay, 0, sizeof(s_decay));
+	memset(s_released, 0, sizeof(s_released));
+	memset((void *)s_ports, 0, sizeof(s_ports));
+	s_portsLent = false;
+	memset(s_edgeDue, 0, sizeof(s_edgeDue));
+	s_interrupts = true;
+	PCICR = 0;
+	PCMSK0 = 0;
+	Serial.reset();
+}
+
+//----------------------------------------------------------------------
+// shim_setPinDecay Makes a pin behave like a QRE1113 reflectance sensor:
+//					once driven HIGH and switched to INPUT it reads HIGH
+//					for us microseconds, then LOW. The fall raises
+//					PCINT0_vect when the pin is enabled for it.
+// Preconditions:   pin < NUM_DIGITAL_PINS.
+// Postconditions:  The decay is used from the next release on. 0 turns
+//					the model off.
+//----------------------------------------------------------------------
+void shim_setPinDecay(uint8_t pin, unsigned long us) {
+	if (pin < NUM_DIGITAL_PINS)
+		s_decay[pin] = us;
+}
+
+//------------------------------ Arduino Core --------------------------
+unsigned long millis() {
+	return s_micros / 1000;
+}
+
+unsigned long micros() {
+	return s_micros;
+}
+
+void delay(unsigned long ms) {
+	advance(ms * 1000ULL);
+}
+
+void delayMicroseconds(unsigned int us) {
+	advance(us);
+}
+
+//----------------------------------------------------------------------
+// setMode -------- Changes the mode of a pin.
+// Preconditions:   pin < NUM_DIGITAL_PINS.
+// Postconditions:  A charged pin switched from OUTPUT starts to decay
+//					and falls with a pin change edge.
+//----------------------------------------------------------------------
+static void setMode(uint8_t pin, uint8_t mode) {
+	if (mode != OUTPUT && s_modes[pin] == OUTPUT && s_pins[pin] == HIGH) {
+		s_released[pin] = s_micros;
+		s_edgeDue[pin] = true;
+	}
+	else if (mode == OUTPUT) {
+		s_edgeDue[pin] = false;
+	}
+	s_modes[pin] = mode;
+}
+
+//----------------------------------------------------------------------
+// readPin -------- Level of a pin without charging time.
+// Preconditions:   pin < NUM_DIGITAL_PINS.
+// Postconditions:  Returns HIGH or LOW.
+//----------------------------------------------------------------------
+static int readPin(uint8_t pin) {
+	if (s_modes[pin] != OUTPUT && s_decay[pin] > 0)
+		return s_micros - s_released[pin] < s_decay[pin] ? HIGH : LOW;
+	return s_pins[pin];
+}
+
+//----------------------------------------------------------------------
+// mirrorPin ------ Writes the mode and value of a pin to the DDR and
+//					PORT registers, PORT is the pull-up of an input.
+// Preconditions:   pin < NUM_DIGITAL_PINS.
+// Postconditions:  The registers match the pin.
+//----------------------------------------------------------------------
+static void mirrorPin(uint8_t pin) {
+	uint8_t port = digitalPinToPort(pin);
+	uint8_t mask = digitalPinToBitMask(pin);
+	if (s_modes[pin] == OUTPUT)
+		s_ports[1][port] |= mask;
+	else
+		s_ports[1][port] &= ~mask;
+	if (s_modes[pin] == OUTPUT ? s_pins[pin] == HIGH : s_modes[pin] == INPUT_PULLUP)
+		s_ports[2][port] |= mask;
+	else
+		s_ports[2][port] &= ~mask;
+}
+
+//----------------------------------------------------------------------
+// syncPorts ------ Applies DDR and PORT register writes made by the code
+//					under test since the last pin access.
+// Preconditions:   None.
+// Postconditions:  Pins match the registers, modes before values so a
+//					released HIGH output decays.
+//----------------------------------------------------------------------
+static void syncPorts() {
+	if (!s_portsLent)
+		return;
+	s_portsLent = false;
+	
+	for (uint8_t pin = 0; pin < NUM_DIGITAL_PINS; pin++) {
+		uint8_t port = digitalPinToPort(pin);
+		uint8_t mask = digitalPinToBitMask(pin);
+		bool output = s_ports[1][port] & mask;
+		bool high = s_ports[2][port] & mask;
+		
+		if (output != (s_modes[pin] == OUTPUT))
+			setMode(pin, output ? OUTPUT : (high ? INPUT_PULLUP : INPUT));
+		if (output)
+			s_pins[pin] = high ? HIGH : LOW;
+		else if (high != (s_modes[pin] == INPUT_PULLUP))
+			s_modes[pin] = high ? INPUT_PULLUP : INPUT;
+	}
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+	advance(PIN_ACCESS_US);
+	if (pin >= NUM_DIGITAL_PINS)
+		return;
+	
+	syncPorts();
+	setMode(pin, mode);
+	mirrorPin(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+	advance(PIN_ACCESS_US);
+	if (pin >= NUM_DIGITAL_PINS)
+		return;
+	
+	syncPorts();
+	s_pins[pin] = val;
+	mirrorPin(pin);
+}
+
+int digitalRead(uint8_t pin) {
+	advance(PIN_ACCESS_US);
+	if (pin >= NUM_DIGITAL_PINS)
+		return LOW;
+	
+	syncPorts();
+	return readPin(pin);
+}
+
+volatile uint8_t *shim_portRegister(uint8_t port, uint8_t reg) {
+	advance(PORT_ACCESS_US);
+	syncPorts();
+	if (port >= SHIM_PORTS || reg > 2)
+		return &s_ports[0][NOT_A_PORT];
+	
+	// the input register reads the level of every pin of the port
+	if (reg == 0) {
+		uint8_t levels = 0;
+		for (uint8_t bit = 0; bit < 8; bit++) {
+			uint8_t pin = (port - 1) * 8 + bit;
+			if (port != NOT_A_PORT && pin < NUM_DIGITAL_PINS && readPin(pin) == HIGH)
+				levels |= 1 << bit;
+		}
+		s_ports[0][port] = levels;
+	}
+	else {
+		s_portsLent = true;
+	}
+	return &s_ports[reg][port];
+}
+
+char *dtostrf(double val, signed char width, unsigned char prec, char *buf) {
+	sprintf(buf, "%*.*f", width, prec, val);
+	return buf;
+}
+
+//-------------------------------- Print -------------------------------
+size_t Print::write(const uint8_t *buffer, size_t size) {
+	size_t n = 0;
+	while (size--)
+		n += write(*buffer++);
+	return n;
+}
+
+size_t Print::write(const char *str) {
+	return write((const uint8_t *)str, strlen(str));
+}
+
+size_t Print::print(const char *str) {
+	return write(str);
+}
+
+size_t Print::print(char c) {
+	return write((uint8_t)c);
+}
+
+size_t Print::print(long n, int base) {
+	if (base == 10) {
+		char buf[24];
+		snprintf(buf, sizeof(buf), "%ld", n);
+		return write(buf);
+	}
+	return print((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+	char buf[8 * sizeof(long) + 1];
+	char *p = &buf[sizeof(buf) - 1];
+	*p = '\0';
+	
+	if (base < 2)
+		base = 10;
+	do {
+		unsigned long digit = n % base;
+		*--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+		n /= base;
+	} while (n > 0);
+	
+	return write(p);
+}
+
+size_t Print::print(double n, int digits) {
+	char buf[48];
+	snprintf(buf, sizeof(buf), "%.*f", digits, n);
+	return write(buf);
+}
+
+size_t Print::println() {
+	return write("\r\n");
+}
+
+//--------------------------- HardwareSerial ---------------------------
+HardwareSerial::HardwareSerial() {
+	_txHandler = NULL;
+	_byteMicros = 10000000UL / 9600;
+	reset();
+}
+
+void HardwareSerial::begin(unsigned long baud) {
+	_byteMicros = 10000000UL / baud; // 8N1 is 10 bits per byte
+}
+
+void HardwareSerial::end() {
+}
+
+// moves every byte that has arrived by now into the ring buffer
+void HardwareSerial::receive() {
+	while (!_pending.empty() && _pending.front().ready <= s_micros) {
+		if (_rxCount == SERIAL_RX_BUFFER_SIZE) {
+			_overflows++; // dropped just like the real ring buffer
+		}
+		else {
+			_rx[(_rxHead + _rxCount) % SERIAL_RX_BUFFER_SIZE] = _pending.front().val;
+			_rxCount++;
+		}
+		_pending.pop_front();
+	}
+}
+
+int HardwareSerial::available() {
+	receive();
+	if (_rxCount == 0)
+		advance(SERIAL_POLL_US); // let busy waits make progress
+	return _rxCount;
+}
+
+int HardwareSerial::read() {
+	receive();
+	if (_rxCount == 0)
+		return -1;
+	
+	uint8_t val = _rx[_rxHead];
+	_rxHead = (_rxHead + 1) % SERIAL_RX_BUFFER_SIZE;
+	_rxCount--;
+	return val;
+}
+
+int HardwareSerial::peek() {
+	receive();
+	if (_rxCount == 0)
+		return -1;
+	return _rx[_rxHead];
+}
+
+// blocks until the written bytes are on the wire
+void HardwareSerial::flush() {
+	if (_tx.empty())
+		return;
+	
+	advance(_tx.size() * _byteMicros);
+	if (_txHandler != NULL)
+		_txHandler(_tx.data(), _tx.size());
+	_tx.clear();
+}
+
+size_t HardwareSerial::write(uint8_t val) {
+	_tx.push_back(val);
+	_txBytes++;
+	return 1;
+}
+
+// queues bytes to arrive back to back starting at atMicros (or once the
+// line is free)
+void HardwareSerial::inject(const uint8_t *data, size_t len, unsigned long long atMicros) {
+	unsigned long long t = atMicros > _lineFree ? atMicros : _lineFree;
+	for (size_t i = 0; i < len; i++) {
+		t += _byteMicros;
+		PendingByte b = { t, data[i] };
+		_pending.push_back(b);
+	}
+	_lineFree = t;
+}
+
+void HardwareSerial::setTxHandler(SerialTxHandler handler) {
+	_txHandler = handler;
+}
+
+unsigned long long HardwareSerial::getLineFree() {
+	return _lineFree;
+}
+
+unsigned long HardwareSerial::getOverflows() {
+	return _overflows;
+}
+
+unsigned long HardwareSerial::getTxBytes() {
+	return _txBytes;
+}
+
+void HardwareSerial::reset() {
+	_pending.clear();
+	_rxHead = 0;
+	_rxCount = 0;
+	_lineFree = 0;
+	_overflows = 0;
+	_tx.clear();
+	_txBytes = 0;
+}
+
+//-------------------------------- Wire --------------------------------
+TwoWire::TwoWire() {
+	_clock = 100000;
+	_bytes = 0;
+	_remainder = 0;
+	_transmissions = 0;
+	_address = 0;
+	_length = 0;
+	_rxLength = 0;
+	_rxIndex = 0;
+	for (int i = 0; i < 128; i++) {
+		_devices[i] = NULL;
+		_sources[i] = NULL;
+	}
+}
+
+void TwoWire::begin() {
+}
+
+void TwoWire::setClock(uint32_t clock) {
+	_clock = clock;
+}
+
+uint32_t TwoWire::getClock() {
+	return _clock;
+}
+
+// 9 clocks per byte (8 data + ack)
+void TwoWire::chargeBytes(unsigned int bytes) {
+	unsigned long long bits = 9ULL * bytes * 1000000ULL + _remainder;
+	advance(bits / _clock);
+	_remainder = bits % _clock;
+	_bytes += bytes;
+}
+
+unsigned long TwoWire::getBytes() {
+	return _bytes;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+	_address = address & 0x7F;
+	_length = 0;
+}
+
+// bytes past the buffer are dropped like the AVR library
+size_t TwoWire::write(uint8_t data) {
+	if (_length >= BUFFER_LENGTH)
+		return 0;
+	_buffer[_length++] = data;
+	return 1;
+}
+
+// the address byte and the data, 2 (address NACK) without a device
+uint8_t TwoWire::endTransmission() {
+	chargeBytes(1 + _length);
+	_transmissions++;
+	if (_devices[_address] == NULL)
+		return 2;
+	_devices[_address](_buffer, _length);
+	return 0;
+}
+
+unsigned long TwoWire::getTransmissions() {
+	return _transmissions;
+}
+
+// the address byte and the data, nothing is received without a source
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity) {
+	if (quantity > BUFFER_LENGTH)
+		quantity = BUFFER_LENGTH;
+	chargeBytes(1 + quantity);
+	_transmissions++;
+	_rxIndex = 0;
+	_rxLength = 0;
+	if (_sources[address & 0x7F] == NULL)
+		return 0;
+	_sources[address & 0x7F](_rx, quantity);
+	_rxLength = quantity;
+	return quantity;
+}
+
+int TwoWire::available() {
+	return _rxLength - _rxIndex;
+}
+
+int TwoWire::read() {
+	if (_rxIndex >= _rxLength)
+		return -1;
+	return _rx[_rxIndex++];
+}
+
+void TwoWire::attachDevice(uint8_t address, WireDevice device, WireSource source) {
+	_devices[address & 0x7F] = device;
+	_sources[address & 0x7F] = source;
+}
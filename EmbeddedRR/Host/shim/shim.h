@@ -0,0 +1,49 @@
+//-------------------------------- shim --------------------------------
+// Filename:      	shim.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Host side control of the Arduino shim. The virtual
+//					clock starts at 0 and is only advanced through these
+//					functions or by the code under test blocking.
+//------------------------------ Includes ------------------------------
+#ifndef _shim_h_
+#define _shim_h_
+
+#include "Arduino.h"
+
+//------------------------------ Functions -----------------------------
+//----------------------------------------------------------------------
+// shim_getMicros - Getter for the virtual clock.
+// Preconditions:   None.
+// Postconditions:  Returns microseconds since the shim was reset.
+//----------------------------------------------------------------------
+unsigned long long shim_getMicros();
+
+//----------------------------------------------------------------------
+// shim_advanceMicros Moves the virtual clock forward.
+// Preconditions:   None.
+// Postconditions:  The virtual clock is us microseconds later.
+//----------------------------------------------------------------------
+void shim_advanceMicros(unsigned long long us);
+
+//----------------------------------------------------------------------
+// shim_reset ----- Resets the virtual clock, pins and serial port.
+// Preconditions:   None.
+// Postconditions:  Virtual clock is 0, pins are LOW inputs without decay
+//					and Serial is empty.
+//----------------------------------------------------------------------
+void shim_reset();
+
+//----------------------------------------------------------------------
+// shim_setPinDecay Makes a pin behave like a QRE1113 reflectance sensor:
+//					once driven HIGH and switched to INPUT it reads HIGH
+//					for us microseconds, then LOW. The fall raises
+//					PCINT0_vect when the pin is enabled for it.
+// Preconditions:   pin < NUM_DIGITAL_PINS.
+// Postconditions:  The decay is used from the next release on. 0 turns
+//					the model off.
+//----------------------------------------------------------------------
+void shim_setPinDecay(uint8_t pin, unsigned long us);
+
+#endif
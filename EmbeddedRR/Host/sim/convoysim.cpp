@@ -0,0 +1,801 @@
+//----------------------------- convoysim.cpp --------------------------
+// Filename:      	convoysim.cpp
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Discrete-event simulator of the convoy: Rover1.ino
+//					following a tape line and streaming its motor targets
+//					to Rover2.ino, which replays them. Both sketches run
+//					unchanged as modules (see sketch.h) on their own
+//					virtual clocks. The rover whose clock is behind runs
+//					its next loop(), then its pose is moved along by
+//					differential drive kinematics for the time the loop
+//					took, using the motor speeds it started with.
+//					Before every loop the four QRE1113 decay times are
+//					set from how much of each sensor spot covers the
+//					tape, plus noise if asked for. The radio delivers
+//					TX_64 frames between the rovers as RX_64 frames
+//					after the air time and answers with TX status frames. The simulator plays
+//					the master and starts the leader, then the follower
+//					once it holds navigation data.
+//					Usage: convoysim [-c course] [-t seconds] [-f ms]
+//						[-p loop_us] [-l loss] [-n noise] [-s seed]
+//						[-o trace] [leader follower]
+//					  -c  course polyline, one "x y" point in mm per line
+//					      (default: 1.5 x 0.9 m rounded rectangle)
+//					  -p  least virtual time per loop() (default 1000 us),
+//					      charged when the loop itself took less
+//					  -t  virtual run time (default 60 s)
+//					  -f  earliest follower start after the leader
+//					      (default 3000 ms)
+//					  -l  probability a frame is lost (default 0)
+//					  -n  IR noise, every decay time is off by up to
+//					      this many us, drawn per loop (default 0)
+//					  -s  seed for the losses and noise (default 1)
+//					  -o  write poses every 10 ms as csv
+//					leader and follower are the sketch modules, by
+//					default Rover1_sim.so and Rover2_sim.so next to the
+//					simulator. Each rover needs its own module file.
+//					The follower starts from the leader's start pose;
+//					collisions are not modelled. A frame is delivered
+//					no earlier than the receiver's clock, so it may be
+//					up to one sender loop late (reported as late).
+//------------------------------ Includes  ----------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <vector>
+#include <algorithm>
+
+#include "sketch.h"
+
+//-------------------------- Configuration  ---------------------------
+// rover geometry and drive
+#define WHEEL_BASE_MM 150.0 	// distance between the wheels
+#define MM_PER_SPEED 2.7 		// wheel mm/s per motor speed unit (0 - 255)
+#define SENSOR_AHEAD_MM 70.0 	// sensor bar ahead of the axle
+#define SENSOR_SPOT_MM 6.0 		// diameter of the area a QRE1113 sees
+#define SENSOR_UPDATE_MM 0.2 	// movement before the decay times are updated
+
+// course
+#define TAPE_WIDTH_MM 19.0 		// 3/4" electrical tape
+#define IR_DARK_US 2400 		// QRE1113 decay over the tape
+#define IR_LIGHT_US 180 		// and over the floor
+#define COURSE_STEP_MM 5.0 		// spacing of the default course points
+#define COURSE_MAX 100000 		// points in a course file
+#define GRID_MM 25.0 			// cell size of the segment grid
+
+// radio (802.15.4 at 250 kbit/s)
+#define RADIO_BASE_US 1500 		// channel access and MAC overhead per frame
+#define RADIO_BYTE_US 32 		// air time per frame byte
+#define RADIO_ACK_US 1000 		// TX status after a delivered frame
+#define RADIO_RETRY_US 12000 	// TX status after a lost frame and 3 retries
+#define RADIO_RSSI 0x28 		// -40 dBm
+#define API_FRAME_SIZE 128 		// largest unescaped frame
+
+// run
+#define RUN_S 60 				// default virtual run time
+#define LOOP_US 1000 			// default least virtual time per loop()
+#define START_MS 1000 			// master starts the leader
+#define FOLLOW_MS 3000 			// earliest follower start after the leader
+#define SAMPLE_US 10000 		// spacing of trail and trace samples
+#define TRAIL_WINDOW 500 		// trail samples searched around the last match
+#define FOLLOWER_READY 5 		// STATE_READY in Rover2.ino
+
+#define LEADER 0
+#define FOLLOWER 1
+#define ROVERS 2
+
+static const uint8_t MASTER_ADDR[8] = { 0x00, 0x13, 0xA2, 0x00, 0x40, 0xF9, 0xCE, 0xDC };
+static const uint8_t ROVER_ADDR[ROVERS][8] = {
+	{ 0x00, 0x13, 0xA2, 0x00, 0x40, 0xF9, 0xCE, 0xDE },	// Rover1
+	{ 0x00, 0x13, 0xA2, 0x00, 0x41, 0x03, 0xDA, 0x0F }	// Rover2
+};
+
+// lateral sensor offsets, left positive (IR_LL, IR_L, IR_R, IR_RR)
+static const double IR_OFFSET_MM[SKETCH_IR_COUNT] = { 21.0, 7.0, -7.0, -21.0 };
+
+//------------------------------ Globals  -----------------------------
+struct Point {
+	double x;
+	double y;
+};
+
+// Samples in any unit
+struct Samples {
+	std::vector<double> values;
+
+	void add(double v) { values.push_back(v); }
+
+	void print(const char *name, const char *unit) {
+		if (values.empty()) {
+			printf("%-12s no samples\n", name);
+			return;
+		}
+		std::sort(values.begin(), values.end());
+		double sum = 0;
+		for (size_t i = 0; i < values.size(); i++)
+			sum += values[i];
+		printf("%-12s mean %8.2f  p50 %8.2f  p95 %8.2f  max %8.2f %s (%zu)\n", name,
+				sum / values.size(), values[values.size() / 2], values[values.size() * 95 / 100],
+				values.back(), unit, values.size());
+	}
+};
+
+// A trail sample
+struct TrailPoint {
+	unsigned long long t;		// virtual us
+	Point p;
+};
+
+struct Rover {
+	const char *name;
+	void *module;
+	const SketchApi *api;
+	double x, y, heading;		// axle centre in mm, heading in radians
+	Point sensed;				// centre of the sensor bar at the last update
+	double sensedHeading;
+	bool started;				// the master sent the start command
+	unsigned long long startTime;
+	unsigned long long lastSample;
+	unsigned long loops;
+	unsigned long long busy;	// virtual us spent in loop()
+	int state;					// sketch state after the last loop
+	unsigned long stateChanges;
+	unsigned long framesTx;
+	unsigned long framesRx;
+	unsigned long framesLost;
+	unsigned long lateFrames;	// delivered after their arrival time
+	unsigned long long maxLate;
+} rovers[ROVERS];
+
+std::vector<Point> course;
+
+// Course segments near each cell of a grid over the course, so sensors
+// only measure the tape close to them
+struct Grid {
+	Point origin;
+	int columns, rows;
+	std::vector<std::vector<int> > cells;	// segment end indices
+} grid;
+std::vector<TrailPoint> trail;	// leader axle positions
+size_t trailHint = 0;			// last trail segment matched
+unsigned long masterRx = 0;
+double lossRate = 0;
+unsigned long irNoise = 0;
+unsigned long loopMicros = LOOP_US;
+FILE *trace = NULL;
+
+Samples lineError;				// leader sensor bar to the tape centre
+Samples pathError;				// follower to the leader's trail
+Samples lag;					// follower behind the leader at that point
+
+//----------------------------------------------------------------------
+//-------------------------------- Course ------------------------------
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// defaultCourse -- Builds a closed 1500 x 900 mm rounded rectangle with
+//					300 mm corner radii, starting on a long side.
+// Preconditions:   None.
+// Postconditions:  course holds the points, the last equals the first.
+//----------------------------------------------------------------------
+void defaultCourse() {
+	const double w = 1500, h = 900, r = 300;
+	// centre of the corner after each side, counter clockwise
+	const Point corner[4] = { { w - r, r }, { w - r, h - r }, { r, h - r }, { r, r } };
+
+	course.clear();
+	for (int side = 0; side < 4; side++) {
+		double len = side % 2 == 0 ? w - 2 * r : h - 2 * r;
+		double dir = side * M_PI / 2;
+		const Point &from = corner[(side + 3) % 4];
+		Point start = { from.x + r * sin(dir), from.y - r * cos(dir) };
+		for (double d = 0; d < len; d += COURSE_STEP_MM) {
+			Point p = { start.x + d * cos(dir), start.y + d * sin(dir) };
+			course.push_back(p);
+		}
+		for (double a = 0; a < M_PI / 2; a += COURSE_STEP_MM / r) {
+			Point p = { corner[side].x + r * sin(dir + a), corner[side].y - r * cos(dir + a) };
+			course.push_back(p);
+		}
+	}
+	course.push_back(course[0]);
+}
+
+//----------------------------------------------------------------------
+// loadCourse ----- Reads a course polyline.
+// Preconditions:   None.
+// Postconditions:  Returns false and displays the error on failure.
+//----------------------------------------------------------------------
+bool loadCourse(const char *path) {
+	char line[256];
+	int lineNum = 0;
+	FILE *fp = fopen(path, "r");
+	if (fp == NULL) {
+		perror(path);
+		return false;
+	}
+
+	course.clear();
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		char *comment = strchr(line, '#');
+		Point p;
+		char extra;
+		lineNum++;
+		if (comment != NULL)
+			*comment = '\0';
+
+		int fields = sscanf(line, "%lf %lf %c", &p.x, &p.y, &extra);
+		if (fields <= 0)
+			continue; // blank line
+		if (fields != 2 || course.size() == COURSE_MAX) {
+			fprintf(stderr, "%s:%i: expected <x> <y>\n", path, lineNum);
+			fclose(fp);
+			return false;
+		}
+		course.push_back(p);
+	}
+	fclose(fp);
+
+	if (course.size() < 2) {
+		fprintf(stderr, "%s: a course needs at least 2 points\n", path);
+		return false;
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------
+// segmentDistance  Distance from a point to a segment.
+// Preconditions:   None.
+// Postconditions:  Returns the distance, sets *along to the position of
+//					the closest point on the segment (0 to 1).
+//----------------------------------------------------------------------
+double segmentDistance(Point p, Point a, Point b, double *along) {
+	double dx = b.x - a.x, dy = b.y - a.y;
+	double len2 = dx * dx + dy * dy;
+	double u = len2 > 0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / len2 : 0;
+	u = u < 0 ? 0 : (u > 1 ? 1 : u);
+	*along = u;
+	return hypot(p.x - a.x - u * dx, p.y - a.y - u * dy);
+}
+
+//----------------------------------------------------------------------
+// courseDistance - Distance from a point to the tape centre line.
+// Preconditions:   course holds at least 2 points.
+// Postconditions:  Returns the distance in mm.
+//----------------------------------------------------------------------
+double courseDistance(Point p) {
+	double best = INFINITY, along;
+	for (size_t i = 1; i < course.size(); i++) {
+		double d = segmentDistance(p, course[i - 1], course[i], &along);
+		if (d < best)
+			best = d;
+	}
+	return best;
+}
+
+//----------------------------------------------------------------------
+// buildGrid ------ Files every course segment under the grid cells that
+//					lie within the reach of a sensor from it.
+// Preconditions:   course holds at least 2 points.
+// Postconditions:  grid covers the course.
+//----------------------------------------------------------------------
+void buildGrid() {
+	const double reach = (TAPE_WIDTH_MM + SENSOR_SPOT_MM) / 2;
+	double minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY;
+	for (size_t i = 0; i < course.size(); i++) {
+		minX = std::min(minX, course[i].x);
+		minY = std::min(minY, course[i].y);
+		maxX = std::max(maxX, course[i].x);
+		maxY = std::max(maxY, course[i].y);
+	}
+
+	grid.origin.x = minX - reach;
+	grid.origin.y = minY - reach;
+	grid.columns = (int)((maxX - minX + 2 * reach) / GRID_MM) + 1;
+	grid.rows = (int)((maxY - minY + 2 * reach) / GRID_MM) + 1;
+	grid.cells.assign(grid.columns * grid.rows, std::vector<int>());
+
+	for (size_t i = 1; i < course.size(); i++) {
+		const Point &a = course[i - 1], &b = course[i];
+		int x0 = (int)((std::min(a.x, b.x) - reach - grid.origin.x) / GRID_MM);
+		int x1 = (int)((std::max(a.x, b.x) + reach - grid.origin.x) / GRID_MM);
+		int y0 = (int)((std::min(a.y, b.y) - reach - grid.origin.y) / GRID_MM);
+		int y1 = (int)((std::max(a.y, b.y) + reach - grid.origin.y) / GRID_MM);
+		for (int y = std::max(y0, 0); y <= y1 && y < grid.rows; y++) {
+			for (int x = std::max(x0, 0); x <= x1 && x < grid.columns; x++)
+				grid.cells[y * grid.columns + x].push_back(i);
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+// tapeDistance --- Distance from a point to the tape centre line when a
+//					sensor there could see the tape.
+// Preconditions:   buildGrid was called.
+// Postconditions:  Returns the distance in mm, exact up to the reach of
+//					a sensor and INFINITY or a larger distance beyond.
+//----------------------------------------------------------------------
+double tapeDistance(Point p) {
+	int x = (int)floor((p.x - grid.origin.x) / GRID_MM);
+	int y = (int)floor((p.y - grid.origin.y) / GRID_MM);
+	if (x < 0 || y < 0 || x >= grid.columns || y >= grid.rows)
+		return INFINITY;
+
+	const std::vector<int> &cell = grid.cells[y * grid.columns + x];
+	double best = INFINITY, along;
+	for (size_t i = 0; i < cell.size(); i++)
+		best = std::min(best, segmentDistance(p, course[cell[i] - 1], course[cell[i]], &along));
+	return best;
+}
+
+//----------------------------------------------------------------------
+// irDecay -------- QRE1113 decay time at a distance from the centre line.
+// Preconditions:   None.
+// Postconditions:  Returns the decay blended by the part of the sensor
+//					spot that covers the tape.
+//----------------------------------------------------------------------
+unsigned long irDecay(double distance) {
+	double r = SENSOR_SPOT_MM / 2;
+	double low = std::max(distance - r, -TAPE_WIDTH_MM / 2);
+	double high = std::min(distance + r, TAPE_WIDTH_MM / 2);
+	double covered = high > low ? (high - low) / SENSOR_SPOT_MM : 0;
+	return IR_LIGHT_US + (unsigned long)(covered * (IR_DARK_US - IR_LIGHT_US));
+}
+
+//----------------------------------------------------------------------
+//-------------------------------- Rovers ------------------------------
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// sensorPoint ---- Position of a point on the sensor bar.
+// Preconditions:   None.
+// Postconditions:  Returns the point offset mm to the left of centre.
+//----------------------------------------------------------------------
+Point sensorPoint(const Rover *rover, double offset) {
+	Point p = { rover->x + SENSOR_AHEAD_MM * cos(rover->heading) - offset * sin(rover->heading),
+			rover->y + SENSOR_AHEAD_MM * sin(rover->heading) + offset * cos(rover->heading) };
+	return p;
+}
+
+//----------------------------------------------------------------------
+// setSensors ----- Sets the IR decay times of a rover from its pose.
+// Preconditions:   The rover module is loaded.
+// Postconditions:  The next sensor reads see the course under the bar,
+//					unless it moved less than SENSOR_UPDATE_MM and there
+//					is no noise.
+//----------------------------------------------------------------------
+void setSensors(Rover *rover) {
+	Point centre = sensorPoint(rover, 0);
+	if (irNoise == 0 && rover->loops > 0 && hypot(centre.x - rover->sensed.x, centre.y - rover->sensed.y) < SENSOR_UPDATE_MM &&
+			fabs(rover->heading - rover->sensedHeading) * IR_OFFSET_MM[0] < SENSOR_UPDATE_MM)
+		return; // idle loops are far more frequent than movement
+
+	rover->sensed = centre;
+	rover->sensedHeading = rover->heading;
+	for (int i = 0; i < SKETCH_IR_COUNT; i++) {
+		long decay = irDecay(tapeDistance(sensorPoint(rover, IR_OFFSET_MM[i])));
+		if (irNoise > 0)
+			decay += lround((2 * drand48() - 1) * irNoise);
+		rover->api->setIrDecay(i, decay > 1 ? decay : 1);
+	}
+}
+
+//----------------------------------------------------------------------
+// drive ---------- Moves a rover along the arc its wheels follow.
+// Preconditions:   None.
+// Postconditions:  The pose is us microseconds further on.
+//----------------------------------------------------------------------
+void drive(Rover *rover, int left, int right, unsigned long long us) {
+	double t = us / 1e6;
+	double vl = left * MM_PER_SPEED, vr = right * MM_PER_SPEED;
+	double v = (vl + vr) / 2, w = (vr - vl) / WHEEL_BASE_MM;
+
+	if (fabs(w) < 1e-9) {
+		rover->x += v * t * cos(rover->heading);
+		rover->y += v * t * sin(rover->heading);
+	}
+	else {
+		double h = rover->heading + w * t;
+		rover->x += v / w * (sin(h) - sin(rover->heading));
+		rover->y -= v / w * (cos(h) - cos(rover->heading));
+		rover->heading = remainder(h, 2 * M_PI);
+	}
+}
+
+//----------------------------------------------------------------------
+// matchTrail ----- Finds the point of the leader's trail closest to the
+//					follower within TRAIL_WINDOW samples of the last
+//					match, so a later lap over the same ground is not
+//					matched.
+// Preconditions:   trail holds at least 2 points.
+// Postconditions:  Returns the distance and sets *when to the leader's
+//					time at that point.
+//----------------------------------------------------------------------
+double matchTrail(Point p, double *when) {
+	double best = INFINITY, along;
+	size_t from = std::max(trailHint, (size_t)TRAIL_WINDOW) - TRAIL_WINDOW;
+	size_t to = std::min(trailHint + TRAIL_WINDOW, trail.size());
+	for (size_t i = std::max(from, (size_t)1); i < to; i++) {
+		double d = segmentDistance(p, trail[i - 1].p, trail[i].p, &along);
+		if (d < best) {
+			best = d;
+			trailHint = i;
+			*when = trail[i - 1].t + along * (trail[i].t - trail[i - 1].t);
+		}
+	}
+	return best;
+}
+
+//----------------------------------------------------------------------
+//--------------------------------- Radio ------------------------------
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// putEscaped ----- Appends a byte to an API mode 2 frame.
+// Preconditions:   frame has room for two more bytes.
+// Postconditions:  The byte is appended, escaped if needed.
+//----------------------------------------------------------------------
+void putEscaped(uint8_t *frame, size_t *len, uint8_t b) {
+	if (b == 0x7E || b == 0x7D || b == 0x11 || b == 0x13) {
+		frame[(*len)++] = 0x7D;
+		frame[(*len)++] = b ^ 0x20;
+	}
+	else {
+		frame[(*len)++] = b;
+	}
+}
+
+//----------------------------------------------------------------------
+// buildFrame ----- Builds an escaped API frame from the frame data.
+// Preconditions:   frame holds at least 2 * (dataLen + 4) bytes.
+// Postconditions:  Returns the length of the frame.
+//----------------------------------------------------------------------
+size_t buildFrame(uint8_t *frame, const uint8_t *data, size_t dataLen) {
+	size_t len = 0;
+	uint8_t checksum = 0;
+
+	frame[len++] = 0x7E;
+	putEscaped(frame, &len, (dataLen >> 8) & 0xFF);
+	putEscaped(frame, &len, dataLen & 0xFF);
+	for (size_t i = 0; i < dataLen; i++) {
+		putEscaped(frame, &len, data[i]);
+		checksum += data[i];
+	}
+	putEscaped(frame, &len, 0xFF - checksum);
+
+	return len;
+}
+
+//----------------------------------------------------------------------
+// deliver -------- Hands a payload to a rover as an RX_64 frame.
+// Preconditions:   len <= API_FRAME_SIZE - 11.
+// Postconditions:  The frame arrives at the rover's serial port at
+//					atMicros, or now if its clock is already later.
+//----------------------------------------------------------------------
+void deliver(Rover *rover, const uint8_t *source, const uint8_t *payload, size_t len,
+		unsigned long long atMicros) {
+	uint8_t data[API_FRAME_SIZE];
+	uint8_t frame[API_FRAME_SIZE * 2];
+	unsigned long long now = rover->api->getMicros();
+
+	// api id, source, rssi, options, payload
+	data[0] = 0x80;
+	memcpy(&data[1], source, 8);
+	data[9] = RADIO_RSSI;
+	data[10] = 0;
+	memcpy(&data[11], payload, len);
+
+	if (now > atMicros) {
+		rover->lateFrames++;
+		rover->maxLate = std::max(rover->maxLate, now - atMicros);
+		atMicros = now;
+	}
+	rover->api->inject(frame, buildFrame(frame, data, len + 11), atMicros);
+	rover->framesRx++;
+}
+
+//----------------------------------------------------------------------
+// radioTx -------- Receives the bytes a rover sends to its xbee, delivers
+//					TX_64 payloads and answers with a TX status.
+// Preconditions:   from is a roster index.
+// Postconditions:  Frames and responses are scheduled on the serial
+//					ports. A lost frame is answered with a no ack status
+//					after the retries.
+//----------------------------------------------------------------------
+void radioTx(int from, const uint8_t *bytes, size_t len) {
+	Rover *sender = &rovers[from];
+	uint8_t data[API_FRAME_SIZE * 2];
+	size_t dataLen = 0;
+
+	// unescape, skipping the start byte
+	for (size_t i = 1; i < len && dataLen < sizeof(data); i++) {
+		if (bytes[i] == 0x7D && i + 1 < len)
+			data[dataLen++] = bytes[++i] ^ 0x20;
+		else
+			data[dataLen++] = bytes[i];
+	}
+
+	// length(2), api id, frame id, destination(8), options, payload
+	size_t frameLen = dataLen >= 2 ? (data[0] << 8) | data[1] : 0;
+	if (dataLen < 13 || frameLen < 11 || frameLen + 2 > dataLen || data[2] != 0x00)
+		return;
+
+	unsigned long long now = sender->api->getMicros();
+	unsigned long long arrival = now + RADIO_BASE_US + (frameLen + 4) * RADIO_BYTE_US;
+	bool lost = drand48() < lossRate;
+	const uint8_t *dest = &data[4];
+	sender->framesTx++;
+
+	if (lost) {
+		sender->framesLost++;
+	}
+	else if (memcmp(dest, MASTER_ADDR, 8) == 0) {
+		masterRx++;
+	}
+	else {
+		for (int r = 0; r < ROVERS; r++) {
+			if (r != from && memcmp(dest, ROVER_ADDR[r], 8) == 0)
+				deliver(&rovers[r], ROVER_ADDR[from], &data[13], frameLen - 11, arrival);
+		}
+	}
+
+	if (data[3] != 0) {
+		uint8_t status[3] = { 0x89, data[3], (uint8_t)(lost ? 0x01 : 0x00) };
+		uint8_t frame[16];
+		size_t statusLen = buildFrame(frame, status, sizeof(status));
+		sender->api->inject(frame, statusLen, lost ? now + RADIO_RETRY_US : arrival + RADIO_ACK_US);
+	}
+}
+
+void leaderTx(const uint8_t *bytes, size_t len) {
+	radioTx(LEADER, bytes, len);
+}
+
+void followerTx(const uint8_t *bytes, size_t len) {
+	radioTx(FOLLOWER, bytes, len);
+}
+
+//----------------------------------------------------------------------
+// sendStart ------ Sends the master's 0x6 Start command to a rover.
+// Preconditions:   The rover is set up.
+// Postconditions:  The command arrives at atMicros.
+//----------------------------------------------------------------------
+void sendStart(Rover *rover, unsigned long long atMicros) {
+	unsigned long time = atMicros / 1000;
+	uint8_t packet[7] = { (uint8_t)(time >> 24), (uint8_t)(time >> 16), (uint8_t)(time >> 8),
+			(uint8_t)time, 0, 0, 0x6 };
+
+	deliver(rover, MASTER_ADDR, packet, sizeof(packet), atMicros);
+	rover->started = true;
+	rover->startTime = atMicros;
+}
+
+//----------------------------------------------------------------------
+//------------------------------ Simulation ----------------------------
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+// loadSketch ----- Loads a sketch module and runs its setup().
+// Preconditions:   None.
+// Postconditions:  Returns false and displays the error on failure.
+//----------------------------------------------------------------------
+bool loadSketch(Rover *rover, const char *path, SketchTxHandler tx) {
+	rover->module = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+	if (rover->module == NULL) {
+		fprintf(stderr, "%s\n", dlerror());
+		return false;
+	}
+
+	SketchGetApi getApi = (SketchGetApi)dlsym(rover->module, SKETCH_API_NAME);
+	if (getApi == NULL) {
+		fprintf(stderr, "%s: no %s\n", path, SKETCH_API_NAME);
+		return false;
+	}
+
+	rover->api = getApi();
+	rover->api->setup();
+	rover->api->setTxHandler(tx);
+	return true;
+}
+
+//----------------------------------------------------------------------
+// step ----------- Runs one loop() of a rover and moves it.
+// Preconditions:   The rover module is loaded.
+// Postconditions:  The rover's clock has advanced by at least loopMicros,
+//					its pose has moved and the metrics are updated.
+//----------------------------------------------------------------------
+void step(Rover *rover) {
+	int left, right;
+	unsigned long long before = rover->api->getMicros();
+
+	setSensors(rover);
+	rover->api->getMotors(&left, &right);
+	rover->api->loop();
+	if (rover->api->getMicros() - before < loopMicros)
+		rover->api->advanceMicros(before + loopMicros - rover->api->getMicros());
+
+	unsigned long long now = rover->api->getMicros();
+	drive(rover, left, right, now - before);
+	rover->loops++;
+	rover->busy += now - before;
+	if (rover->api->getState() != rover->state) {
+		rover->state = rover->api->getState();
+		rover->stateChanges++;
+	}
+
+	if (now - rover->lastSample < SAMPLE_US)
+		return;
+	rover->lastSample = now;
+
+	if (trace != NULL) {
+		rover->api->getMotors(&left, &right);
+		fprintf(trace, "%.3f,%s,%.1f,%.1f,%.4f,%i,%i,%i\n", now / 1000.0, rover->name, rover->x,
+				rover->y, rover->heading, left, right, rover->api->getState());
+	}
+
+	Point axle = { rover->x, rover->y };
+	if (rover == &rovers[LEADER] && rover->started && now >= rover->startTime) {
+		TrailPoint tp = { now, axle };
+		trail.push_back(tp);
+		lineError.add(courseDistance(sensorPoint(rover, 0)));
+	}
+	else if (rover == &rovers[FOLLOWER] && rover->started && trail.size() >= 2 &&
+			(left != 0 || right != 0)) {
+		double when;
+		pathError.add(matchTrail(axle, &when));
+		lag.add((now - when) / 1000.0);
+	}
+}
+
+//----------------------------------------------------------------------
+// hostNanos ------ Host monotonic time.
+// Preconditions:   None.
+// Postconditions:  Returns nanoseconds.
+//----------------------------------------------------------------------
+long long hostNanos() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+//----------------------------------------------------------------------
+// printRover ----- Displays the counters of a rover.
+// Preconditions:   None.
+// Postconditions:  One line is printed.
+//----------------------------------------------------------------------
+void printRover(const Rover *rover) {
+	printf("%-9s %lu loops (%.2f ms mean), state %i (%lu changes), frames tx %lu lost %lu rx %lu "
+			"(%lu late, max %.2f ms), rx overflows %lu\n", rover->name, rover->loops,
+			rover->loops ? rover->busy / 1000.0 / rover->loops : 0, rover->api->getState(),
+			rover->stateChanges,
+			rover->framesTx, rover->framesLost, rover->framesRx, rover->lateFrames,
+			rover->maxLate / 1000.0, rover->api->getOverflows());
+}
+
+int main(int argc, char *argv[]) {
+	const char *usage = "Usage: %s [-c course] [-t seconds] [-f ms] [-p loop_us] [-l loss] "
+			"[-n noise] [-s seed] [-o trace] [leader follower]\n";
+	const char *coursePath = NULL;
+	const char *tracePath = NULL;
+	double runSeconds = RUN_S;
+	unsigned long followMs = FOLLOW_MS;
+	long seed = 1;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "c:t:f:p:l:n:s:o:")) != -1) {
+		switch (opt) {
+			case 'c':
+				coursePath = optarg;
+				break;
+			case 't':
+				runSeconds = atof(optarg);
+				break;
+			case 'f':
+				followMs = strtoul(optarg, NULL, 10);
+				break;
+			case 'p':
+				loopMicros = strtoul(optarg, NULL, 10);
+				break;
+			case 'l':
+				lossRate = atof(optarg);
+				break;
+			case 'n':
+				irNoise = strtoul(optarg, NULL, 10);
+				break;
+			case 's':
+				seed = atol(optarg);
+				break;
+			case 'o':
+				tracePath = optarg;
+				break;
+			default:
+				fprintf(stderr, usage, argv[0]);
+				return 1;
+		}
+	}
+	if ((argc - optind != 0 && argc - optind != 2) || runSeconds <= 0 || loopMicros == 0 ||
+			lossRate < 0 || lossRate > 1) {
+		fprintf(stderr, usage, argv[0]);
+		return 1;
+	}
+
+	if (coursePath == NULL)
+		defaultCourse();
+	else if (!loadCourse(coursePath))
+		return 1;
+	buildGrid();
+
+	if (tracePath != NULL) {
+		trace = fopen(tracePath, "w");
+		if (trace == NULL) {
+			perror(tracePath);
+			return 1;
+		}
+		fprintf(trace, "ms,rover,x,y,heading,left,right,state\n");
+	}
+	srand48(seed);
+
+	// both rovers start on the first course point facing the second
+	const char *modules[ROVERS] = { SIM_MODULE_DIR "/Rover1_sim.so", SIM_MODULE_DIR "/Rover2_sim.so" };
+	SketchTxHandler handlers[ROVERS] = { leaderTx, followerTx };
+	const char *names[ROVERS] = { "Leader", "Follower" };
+	for (int r = 0; r < ROVERS; r++) {
+		memset(&rovers[r], 0, sizeof(rovers[r]));
+		rovers[r].name = names[r];
+		rovers[r].x = course[0].x;
+		rovers[r].y = course[0].y;
+		rovers[r].heading = atan2(course[1].y - course[0].y, course[1].x - course[0].x);
+		if (!loadSketch(&rovers[r], argc - optind == 2 ? argv[optind + r] : modules[r], handlers[r]))
+			return 1;
+	}
+
+	unsigned long long end = runSeconds * 1e6;
+	long long hostStart = hostNanos();
+	sendStart(&rovers[LEADER], START_MS * 1000ULL);
+
+	for (;;) {
+		Rover *next = &rovers[LEADER];
+		if (rovers[FOLLOWER].api->getMicros() < next->api->getMicros())
+			next = &rovers[FOLLOWER];
+
+		unsigned long long now = next->api->getMicros();
+		if (now >= end)
+			break;
+
+		// the master starts the follower once it has navigation data
+		if (next == &rovers[FOLLOWER] && !next->started &&
+				now >= (START_MS + followMs) * 1000ULL && next->api->getState() == FOLLOWER_READY)
+			sendStart(next, now);
+
+		step(next);
+	}
+
+	double hostSeconds = (hostNanos() - hostStart) / 1e9;
+	double length = 0;
+	for (size_t i = 1; i < course.size(); i++)
+		length += hypot(course[i].x - course[i - 1].x, course[i].y - course[i - 1].y);
+
+	printf("Course:   %zu points, %.2f m, tape %.0f mm\n", course.size(), length / 1000, TAPE_WIDTH_MM);
+	printRover(&rovers[LEADER]);
+	printRover(&rovers[FOLLOWER]);
+	if (rovers[FOLLOWER].started)
+		printf("Follower started at %.3f s\n", rovers[FOLLOWER].startTime / 1e6);
+	else
+		printf("Follower never became ready\n");
+	printf("Master:   %lu frames received\n", masterRx);
+	lineError.print("Line error", "mm");
+	pathError.print("Path error", "mm");
+	lag.print("Lag", "ms");
+	printf("Host: %.3f s for %.3f s virtual (%.0fx real time)\n", hostSeconds, end / 1e6,
+			end / 1e6 / hostSeconds);
+
+	if (trace != NULL)
+		fclose(trace);
+	return 0;
+}
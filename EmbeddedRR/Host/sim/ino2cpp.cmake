@@ -0,0 +1,21 @@
+# Converts a sketch to C++ the way the Arduino builder does: Arduino.h is
+# included and every function defined at file scope is declared first, so
+# the .ino compiles unchanged.
+#   cmake -DINO=<sketch.ino> -DOUT=<sketch.cpp> -P ino2cpp.cmake
+file(READ "${INO}" content)
+string(REPLACE "\r" "" content "${content}")
+
+# definitions start in the first column: <type> <name>(<params>) {
+string(REGEX MATCHALL "\n[A-Za-z_][A-Za-z0-9_]*[ \t*]+[A-Za-z_][A-Za-z0-9_]*[ \t]*\\([^)]*\\)[ \t]*{"
+	definitions "\n${content}")
+
+set(prototypes "")
+foreach(definition ${definitions})
+	string(STRIP "${definition}" definition)
+	string(REGEX REPLACE "[ \t]*{$" ";" prototype "${definition}")
+	set(prototypes "${prototypes}${prototype}\n")
+endforeach()
+
+file(WRITE "${OUT}.tmp" "#include <Arduino.h>\n${prototypes}#line 1 \"${INO}\"\n${content}")
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different "${OUT}.tmp" "${OUT}")
+file(REMOVE "${OUT}.tmp")
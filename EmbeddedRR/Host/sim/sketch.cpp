@@ -0,0 +1,91 @@
+//----------------------------- sketch.cpp -----------------------------
+// Filename:      	sketch.cpp
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Exports a rover sketch to the convoy simulator. Built
+//					into every sketch module next to the converted .ino
+//					(see ino2cpp.cmake), everything else in the module
+//					is hidden.
+//------------------------------ Includes  ----------------------------
+#include <Rover_Sensors.h>
+#include <Adafruit_MotorShield.h>
+
+#include "shim.h"
+#include "sketch.h"
+
+//------------------------------ Sketch  ------------------------------
+// defined by the .ino and the rover library
+void setup();
+void loop();
+extern int currentState;
+extern Adafruit_DCMotor *leftMotor;
+extern Adafruit_DCMotor *rightMotor;
+
+static const uint8_t s_irPins[SKETCH_IR_COUNT] = { IR_LL, IR_L, IR_R, IR_RR };
+
+//----------------------------------------------------------------------
+// motorSpeed ----- Signed speed a motor is driven at.
+// Preconditions:   None.
+// Postconditions:  Returns the speed, negative when BACKWARD and 0 when
+//					released or braking.
+//----------------------------------------------------------------------
+static int motorSpeed(Adafruit_DCMotor *motor) {
+	switch (motor->getDirection()) {
+		case FORWARD:
+			return motor->getSpeed();
+		case BACKWARD:
+			return -motor->getSpeed();
+		default:
+			return 0;
+	}
+}
+
+static void sketchSetup() {
+	shim_reset();
+	setup();
+}
+
+static void sketchLoop() {
+	loop();
+}
+
+static void setTxHandler(SketchTxHandler handler) {
+	Serial.setTxHandler(handler);
+}
+
+static void inject(const uint8_t *data, size_t len, unsigned long long atMicros) {
+	Serial.inject(data, len, atMicros);
+}
+
+static unsigned long getOverflows() {
+	return Serial.getOverflows();
+}
+
+static void setIrDecay(int sensor, unsigned long us) {
+	if (sensor >= 0 && sensor < SKETCH_IR_COUNT)
+		shim_setPinDecay(s_irPins[sensor], us);
+}
+
+static void getMotors(int *left, int *right) {
+	*left = motorSpeed(leftMotor);
+	*right = motorSpeed(rightMotor);
+}
+
+static int getState() {
+	return currentState;
+}
+
+static const SketchApi s_api = {
+	sketchSetup, sketchLoop, shim_getMicros, shim_advanceMicros, setTxHandler,
+	inject, getOverflows, setIrDecay, getMotors, getState
+};
+
+//----------------------------------------------------------------------
+// sketch_getApi -- Entry point looked up by the simulator.
+// Preconditions:   None.
+// Postconditions:  Returns the functions of this module.
+//----------------------------------------------------------------------
+extern "C" __attribute__((visibility("default"))) const SketchApi *sketch_getApi() {
+	return &s_api;
+}
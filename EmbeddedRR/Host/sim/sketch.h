@@ -0,0 +1,40 @@
+//------------------------------ sketch.h ------------------------------
+// Filename:      	sketch.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Interface of a rover sketch built as a loadable 
+//					module for the convoy simulator. Each module holds
+//					an unmodified .ino, the rover library and its own 
+//					copy of the Arduino shim, so several rovers can run
+//					in one process without sharing globals. 
+//------------------------------ Includes  ----------------------------
+#ifndef _sketch_h_
+#define _sketch_h_
+
+#include <stdint.h>
+#include <stddef.h>
+
+//---------------------------- Definitions -----------------------------
+#define SKETCH_API_NAME "sketch_getApi"	// symbol exported by every module
+#define SKETCH_IR_COUNT 4				// IR sensors from left-most to right-most
+
+typedef void (*SketchTxHandler)(const uint8_t *data, size_t len);
+
+// Functions of one module. Times are on the module's virtual clock.
+struct SketchApi {
+	void (*setup)();
+	void (*loop)();
+	unsigned long long (*getMicros)();
+	void (*advanceMicros)(unsigned long long us);
+	void (*setTxHandler)(SketchTxHandler handler);
+	void (*inject)(const uint8_t *data, size_t len, unsigned long long atMicros);
+	unsigned long (*getOverflows)();
+	void (*setIrDecay)(int sensor, unsigned long us);
+	void (*getMotors)(int *left, int *right);	// signed speed, 0 when released
+	int (*getState)();							// currentState of the sketch
+};
+
+typedef const struct SketchApi *(*SketchGetApi)();
+
+#endif
@@ -0,0 +1,167 @@
+//---------------------------- tracedump.cpp ---------------------------
+// Filename:      	tracedump.cpp
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Decodes the binary dumps of Rover_Trace into text.
+//					The input is searched for dumps, so a capture of the
+//					rover's serial port with other output around them
+//					works. Every dump is printed as a header and one
+//					line per event, oldest first.
+//					Usage: tracedump [-u] [capture]
+//					  -u  display micros() instead of the time before
+//					      the dump
+//					Without a capture the dumps are read from stdin.
+//------------------------------ Includes  ----------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+#include <Rover_Trace.h>
+
+//------------------------------ Globals  -----------------------------
+static const char *names[] = TRACE_NAMES;
+#define NAME_COUNT (sizeof(names) / sizeof(names[0]))
+
+bool rawTime = false;
+
+//----------------------------------------------------------------------
+// readLe --------- Little endian value at data.
+// Preconditions:   data holds bytes bytes, bytes <= 4.
+// Postconditions:  Returns the value.
+//----------------------------------------------------------------------
+unsigned long readLe(const unsigned char *data, int bytes) {
+	unsigned long value = 0;
+	for (int i = bytes - 1; i >= 0; i--)
+		value = (value << 8) | data[i];
+	return value;
+}
+
+//----------------------------------------------------------------------
+// printEvent ----- Displays one event.
+// Preconditions:   data holds TRACE_EVENT_SIZE bytes, now is micros()
+//					of the dump.
+// Postconditions:  One line is printed.
+//----------------------------------------------------------------------
+void printEvent(const unsigned char *data, unsigned long now) {
+	uint8_t id = data[0];
+	uint32_t time = readLe(data + 1, 4);
+	int16_t a = (int16_t)readLe(data + 5, 2);
+	int16_t b = (int16_t)readLe(data + 7, 2);
+
+	if (rawTime)
+		printf("%10lu us  ", (unsigned long)time);
+	else // micros() wraps after 71 minutes, the difference does not care
+		printf("%10.3f ms  ", -(long)(uint32_t)(now - time) / 1000.0);
+
+	switch (id) {
+		case TRACE_CMD:
+			printf("%-11s cmd 0x%X lData 0x%X rData 0x%X\n", names[id],
+					(a >> 10) & 0x3F, a & 0x3FF, (uint16_t)b);
+			break;
+		case TRACE_XBEE_ERROR:
+			printf("%-11s code %d in %s\n", names[id], a,
+					b == TRACE_AT_ACK ? "com_getAck" : "com_receiveData");
+			break;
+		case TRACE_XBEE_API:
+			printf("%-11s api id 0x%02X\n", names[id], (uint16_t)a);
+			break;
+		case TRACE_UNTRUSTED:
+			printf("%-11s address lsb 0x%04X%04X\n", names[id], (uint16_t)b, (uint16_t)a);
+			break;
+		case TRACE_NO_SENSOR:
+			printf("%-11s %s\n", names[id], a == 0 ? "accelerometer" : "magnetometer");
+			break;
+		default:
+			if (id < NAME_COUNT)
+				printf("%-11s %6d %6d\n", names[id], a, b);
+			else
+				printf("user+%-6d %6d %6d\n", id - TRACE_USER, a, b);
+			break;
+	}
+}
+
+//----------------------------------------------------------------------
+// decode --------- Finds and displays every dump in a capture.
+// Preconditions:   None.
+// Postconditions:  Returns the number of dumps found.
+//----------------------------------------------------------------------
+int decode(const std::vector<unsigned char> &input) {
+	int dumps = 0;
+	size_t pos = 0;
+
+	while (pos + TRACE_HEADER_SIZE <= input.size()) {
+		const unsigned char *data = &input[pos];
+		if (memcmp(data, "RTRC", 4) != 0) {
+			pos++;
+			continue;
+		}
+		if (data[4] != TRACE_VERSION) {
+			fprintf(stderr, "Skipping dump at %zu: version %u\n", pos, data[4]);
+			pos++;
+			continue;
+		}
+
+		unsigned int events = readLe(data + 5, 2);
+		unsigned long lost = readLe(data + 7, 4);
+		unsigned long now = readLe(data + 11, 4);
+		size_t size = TRACE_HEADER_SIZE + (size_t)events * TRACE_EVENT_SIZE;
+		if (pos + size > input.size()) {
+			fprintf(stderr, "Dump at %zu is cut off: %u events\n", pos, events);
+			break;
+		}
+
+		dumps++;
+		printf("dump %d at micros() %lu: %u events, %lu older events lost\n", dumps, now, events, lost);
+		for (unsigned int i = 0; i < events; i++)
+			printEvent(data + TRACE_HEADER_SIZE + i * TRACE_EVENT_SIZE, now);
+		pos += size;
+	}
+
+	return dumps;
+}
+
+//----------------------------------------------------------------------
+// main ----------- Decodes a capture.
+// Preconditions:   None.
+// Postconditions:  Returns 0 when at least one dump was found.
+//----------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+	int opt;
+
+	while ((opt = getopt(argc, argv, "u")) != -1) {
+		switch (opt) {
+			case 'u':
+				rawTime = true;
+				break;
+			default:
+				fprintf(stderr, "Usage: %s [-u] [capture]\n", argv[0]);
+				return 1;
+		}
+	}
+
+	FILE *in = stdin;
+	if (optind < argc) {
+		in = fopen(argv[optind], "rb");
+		if (in == NULL) {
+			perror(argv[optind]);
+			return 1;
+		}
+	}
+
+	std::vector<unsigned char> input;
+	unsigned char buffer[4096];
+	size_t n;
+	while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0)
+		input.insert(input.end(), buffer, buffer + n);
+	if (in != stdin)
+		fclose(in);
+
+	if (decode(input) == 0) {
+		fprintf(stderr, "No trace dump found\n");
+		return 1;
+	}
+	return 0;
+}
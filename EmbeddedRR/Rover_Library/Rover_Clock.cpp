@@ -0,0 +1,191 @@
+//---------------------------- Rover_Clock -----------------------------
+// Filename:      	Rover_Clock.cpp
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Estimates the leading rover's clock on the following
+//					rover from NTP style exchanges of CLOCK_CMD
+//					roverPackets.
+//----------------------------------------------------------------------
+#include "Rover_Clock.h"
+
+//---------------------------- Initialization --------------------------
+ClockSample ck_samples[CLOCK_SAMPLES]; 	// last samples, oldest overwritten
+uint8_t ck_count = 0; 					// samples held, saturates at CLOCK_SAMPLES
+uint8_t ck_next = 0; 					// slot of the next sample
+ClockSample ck_best; 					// sample in use
+ClockSample ck_anchor; 					// first full filter, base of the drift
+bool ck_anchored = false;
+bool ck_synced = false;
+long ck_drift = 0; 						// leader ms per local ms - 1, CLOCK_DRIFT_SHIFT fraction
+
+int ck_seq = 0; 						// sequence number of the last request
+unsigned long ck_requestAt = 0; 		// t1 of the last request
+bool ck_requested = false; 				// whether a request was made
+bool ck_waiting = false; 				// whether the last request is unanswered
+
+//------------------------------ Class Functions -----------------------
+//----------------------------------------------------------------------
+// clock_reset ---- Forgets every sample.
+// Preconditions:   None.
+// Postconditions:  Not synced, the offset and drift are 0 and the next
+//					clock_request starts an exchange.
+//----------------------------------------------------------------------
+void clock_reset() {
+	ck_count = 0;
+	ck_next = 0;
+	ck_best = ClockSample();
+	ck_anchored = false;
+	ck_synced = false;
+	ck_drift = 0;
+	ck_requested = false;
+	ck_waiting = false;
+}
+
+//----------------------------------------------------------------------
+// clock_request -- Starts an exchange when one is due, CLOCK_FAST_MS
+//					after the last until the filter is full, then
+//					CLOCK_PERIOD_MS. An unanswered request is given
+//					CLOCK_DELAY_MAX.
+// Preconditions:   None.
+// Postconditions:  Returns the sequence number to send right away as
+//					(CLOCK_CMD, sequence, CLOCK_REQUEST), or CLOCK_NONE.
+//----------------------------------------------------------------------
+int clock_request() {
+	unsigned long now = millis();
+	unsigned long period = ck_count < CLOCK_SAMPLES ? CLOCK_FAST_MS : CLOCK_PERIOD_MS;
+	if (ck_waiting) // give up on an answer after CLOCK_DELAY_MAX
+		period = max(period, (unsigned long)CLOCK_DELAY_MAX);
+	if (ck_requested && now - ck_requestAt < period)
+		return CLOCK_NONE;
+
+	ck_seq = (ck_seq + 1) & CLOCK_HOLD_MAX; // stays positive in the 10 bit lData
+	ck_requestAt = now;
+	ck_requested = true;
+	ck_waiting = true;
+	return ck_seq;
+}
+
+//----------------------------------------------------------------------
+// clock_answer --- Leader side, how to answer a request.
+// Preconditions:   age is how long ago the request was received.
+// Postconditions:  Returns the rData to send right away as (CLOCK_CMD,
+//					sequence, rData), or CLOCK_NONE if the request is
+//					too old to answer.
+//----------------------------------------------------------------------
+int clock_answer(unsigned int age) {
+	if (age > CLOCK_HOLD_MAX)
+		return CLOCK_NONE;
+	return age;
+}
+
+//----------------------------------------------------------------------
+// clock_update --- Follower side, takes the sample of an answer.
+// Preconditions:   timestamp, lData and rData are the answer, received
+//					is millis() when it was received.
+// Postconditions:  Returns true if it answered the last request and the
+//					sample was used. The offset and drift are updated.
+//----------------------------------------------------------------------
+bool clock_update(unsigned long timestamp, int lData, int rData, unsigned long received) {
+	if (!ck_waiting || lData != ck_seq || rData < 0)
+		return false;
+	ck_waiting = false;
+
+	unsigned long t1 = ck_requestAt;
+	unsigned long t3 = timestamp;
+	unsigned long t2 = t3 - rData;
+	long delay = (long)(received - t1) - rData;
+	if ((long)(received - t1) < 0 || delay > CLOCK_DELAY_MAX)
+		return false;
+
+	ClockSample* sample = &ck_samples[ck_next];
+	sample->local = t1 + (received - t1) / 2;
+	sample->offset = ((long)(t2 - t1) + (long)(t3 - received)) / 2;
+	sample->delay = delay < 0 ? 0 : delay; // both clocks round down
+	ck_next = (ck_next + 1) % CLOCK_SAMPLES;
+	if (ck_count < CLOCK_SAMPLES)
+		ck_count++;
+
+	// least delay in the filter, the newest of equals
+	uint8_t oldest = (ck_next + CLOCK_SAMPLES - ck_count) % CLOCK_SAMPLES;
+	uint8_t best = oldest;
+	for (uint8_t i = 1; i < ck_count; i++) {
+		uint8_t slot = (oldest + i) % CLOCK_SAMPLES;
+		if (ck_samples[slot].delay <= ck_samples[best].delay)
+			best = slot;
+	}
+	ck_best = ck_samples[best];
+	ck_synced = true;
+
+	if (!ck_anchored) {
+		if (ck_count == CLOCK_SAMPLES) {
+			ck_anchor = ck_best;
+			ck_anchored = true;
+		}
+	}
+	else {
+		long base = ck_best.local - ck_anchor.local;
+		if (base >= CLOCK_DRIFT_BASE_MS) {
+			// once per exchange, 64 bits so a long baseline cannot overflow
+			int64_t drift = ((int64_t)(ck_best.offset - ck_anchor.offset) << CLOCK_DRIFT_SHIFT) / base;
+			if (drift <= CLOCK_DRIFT_MAX && drift >= -CLOCK_DRIFT_MAX)
+				ck_drift = drift;
+		}
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------
+// clock_isSynced - Getter for whether there is an offset.
+// Preconditions:   None.
+// Postconditions:  Returns true after the first sample.
+//----------------------------------------------------------------------
+bool clock_isSynced() {
+	return ck_synced;
+}
+
+//----------------------------------------------------------------------
+// clock_getOffset  Getter for the offset at a local time.
+// Preconditions:   None.
+// Postconditions:  Returns leader time - local, 0 if not synced.
+//----------------------------------------------------------------------
+long clock_getOffset(unsigned long local) {
+	if (!ck_synced)
+		return 0;
+
+	// drift * dt in two 32 bit products, |ck_drift| < 2^17 so each fits
+	// while dt >> 14 is under 2^14, about 3 days from the sample
+	long dt = local - ck_best.local;
+	long high = dt >> 14; // arithmetic shift, rounds down
+	long low = dt & 0x3FFF;
+	return ck_best.offset + ((ck_drift * high + ((ck_drift * low) >> 14)) >> (CLOCK_DRIFT_SHIFT - 14));
+}
+
+//----------------------------------------------------------------------
+// clock_toLeader - Converts a local time to leader time.
+// Preconditions:   None.
+// Postconditions:  Returns local + clock_getOffset(local).
+//----------------------------------------------------------------------
+unsigned long clock_toLeader(unsigned long local) {
+	return local + clock_getOffset(local);
+}
+
+//----------------------------------------------------------------------
+// clock_getDrift - Getter for the drift estimate.
+// Preconditions:   None.
+// Postconditions:  Returns how many ppm the leader's clock is faster,
+//					0 until there is a baseline of CLOCK_DRIFT_BASE_MS.
+//----------------------------------------------------------------------
+long clock_getDrift() {
+	return (ck_drift * 15625) >> (CLOCK_DRIFT_SHIFT - 6); // 10^6 / 2^24 = 15625 / 2^18
+}
+
+//----------------------------------------------------------------------
+// clock_getDelay - Getter for the delay of the sample in use.
+// Preconditions:   None.
+// Postconditions:  Returns ms, 0xFFFF if not synced.
+//----------------------------------------------------------------------
+unsigned int clock_getDelay() {
+	return ck_synced ? ck_best.delay : 0xFFFF;
+}
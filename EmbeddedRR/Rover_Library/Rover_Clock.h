@@ -0,0 +1,125 @@
+//---------------------------- Rover_Clock -----------------------------
+// Filename:      	Rover_Clock.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Estimates the leading rover's clock on the following
+//					rover from NTP style exchanges of CLOCK_CMD
+//					roverPackets. The follower sends a request stamped
+//					t1, the leader answers stamped t3 with how long it
+//					held the request (t3 - t2) and the follower notes
+//					the receive time t4:
+//						offset = ((t2 - t1) + (t3 - t4)) / 2
+//						delay  = (t4 - t1) - (t3 - t2)
+//					The sample with the least delay of the last
+//					CLOCK_SAMPLES is used, since it was held up least
+//					on either way. The drift is the slope of the offset
+//					from the first full filter to the current sample, so
+//					the estimate keeps up with the crystals between
+//					exchanges. The rovers send the packets, this module
+//					only does the arithmetic.
+//------------------------------ Includes ------------------------------
+#ifndef _Rover_Clock_h_
+#define _Rover_Clock_h_
+
+#include <Arduino.h>
+
+//---------------------------- Definitions -----------------------------
+// Configuration
+#define CLOCK_CMD 0xB 				// roverPacket command of the exchange
+#define CLOCK_FAST_MS 250 			// between requests until the filter is full
+#define CLOCK_PERIOD_MS 1000 		// between requests afterwards
+#define CLOCK_SAMPLES 8 			// samples in the filter
+#define CLOCK_DRIFT_BASE_MS 10000 	// least time between the samples of the drift
+#define CLOCK_DRIFT_SHIFT 24 		// fraction bits of the drift (leader ms per local ms - 1)
+#define CLOCK_DRIFT_MAX 83886 		// 5000 ppm in 2^-CLOCK_DRIFT_SHIFT, a larger slope is ignored
+#define CLOCK_DELAY_MAX 2000 		// ms, slower exchanges are ignored
+
+// Exchange (lData, rData): request (sequence, CLOCK_REQUEST), answer
+// (sequence, ms the leader held the request)
+#define CLOCK_REQUEST -1
+#define CLOCK_HOLD_MAX 511 			// 10 bit rData
+#define CLOCK_NONE -1 				// no packet to send
+
+// One exchange
+struct ClockSample {
+	unsigned long local = 0; 	// millis() halfway through
+	long offset = 0; 			// leader time - millis()
+	unsigned int delay = 0; 	// ms on the air and in the queues, both ways
+};
+
+//------------------------------ Class Functions ------------------------
+//----------------------------------------------------------------------
+// clock_reset ---- Forgets every sample.
+// Preconditions:   None.
+// Postconditions:  Not synced, the offset and drift are 0 and the next
+//					clock_request starts an exchange.
+//----------------------------------------------------------------------
+void clock_reset();
+
+//----------------------------------------------------------------------
+// clock_request -- Starts an exchange when one is due, CLOCK_FAST_MS
+//					after the last until the filter is full, then
+//					CLOCK_PERIOD_MS. An unanswered request is given
+//					CLOCK_DELAY_MAX.
+// Preconditions:   None.
+// Postconditions:  Returns the sequence number to send right away as
+//					(CLOCK_CMD, sequence, CLOCK_REQUEST), or CLOCK_NONE.
+//----------------------------------------------------------------------
+int clock_request();
+
+//----------------------------------------------------------------------
+// clock_answer --- Leader side, how to answer a request.
+// Preconditions:   age is how long ago the request was received.
+// Postconditions:  Returns the rData to send right away as (CLOCK_CMD,
+//					sequence, rData), or CLOCK_NONE if the request is
+//					too old to answer.
+//----------------------------------------------------------------------
+int clock_answer(unsigned int age);
+
+//----------------------------------------------------------------------
+// clock_update --- Follower side, takes the sample of an answer.
+// Preconditions:   timestamp, lData and rData are the answer, received
+//					is millis() when it was received.
+// Postconditions:  Returns true if it answered the last request and the
+//					sample was used. The offset and drift are updated.
+//----------------------------------------------------------------------
+bool clock_update(unsigned long timestamp, int lData, int rData, unsigned long received);
+
+//----------------------------------------------------------------------
+// clock_isSynced - Getter for whether there is an offset.
+// Preconditions:   None.
+// Postconditions:  Returns true after the first sample.
+//----------------------------------------------------------------------
+bool clock_isSynced();
+
+//----------------------------------------------------------------------
+// clock_getOffset  Getter for the offset at a local time.
+// Preconditions:   None.
+// Postconditions:  Returns leader time - local, 0 if not synced.
+//----------------------------------------------------------------------
+long clock_getOffset(unsigned long local);
+
+//----------------------------------------------------------------------
+// clock_toLeader - Converts a local time to leader time.
+// Preconditions:   None.
+// Postconditions:  Returns local + clock_getOffset(local).
+//----------------------------------------------------------------------
+unsigned long clock_toLeader(unsigned long local);
+
+//----------------------------------------------------------------------
+// clock_getDrift - Getter for the drift estimate.
+// Preconditions:   None.
+// Postconditions:  Returns how many ppm the leader's clock is faster,
+//					0 until there is a baseline of CLOCK_DRIFT_BASE_MS.
+//----------------------------------------------------------------------
+long clock_getDrift();
+
+//----------------------------------------------------------------------
+// clock_getDelay - Getter for the delay of the sample in use.
+// Preconditions:   None.
+// Postconditions:  Returns ms, 0xFFFF if not synced.
+//----------------------------------------------------------------------
+unsigned int clock_getDelay();
+
+#endif
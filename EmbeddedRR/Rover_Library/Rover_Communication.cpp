@@ -31,19 +31,39 @@ Tx64Request c_tx64Slave; 				// reusable tx object to slave
 	Tx64Request c_tx64SlaveAck; 		// reusable tx object to slave for rover acks
 #endif
 
-QueueArray<RoverPacket> c_packetQueue;
+// packetQueue entry, with the time it was queued
+struct QueuedPacket {
+	RoverPacket packet;
+	uint16_t queuedAt = 0; // low 16 bits of millis()
+};
 
+QueueArray<QueuedPacket> c_packetQueue;
+uint16_t c_decodedAge = 0; 				// ms the last decoded packet was queued
+
+bool c_heldEStop = false; 				// high priority packet queued while waiting for an ack
 uint8_t c_lastRssi = 0; 				// magnitude of last rssi - higher is worse
-unsigned int c_failedEncodes = 0;		// count of failed attempts to encode a packet because buffer was full
-unsigned int c_msgsToMaster = 0;		// count of msgs sent to master
-unsigned int c_msgsFromMaster = 0;		// count of msgs received from master
-unsigned int c_acksFromMaster = 0;		// count of acks from master
-unsigned int c_msgsToSlave = 0;			// count of msgs sent to slave
-unsigned int c_msgsFromSlave = 0;		// count of msgs received from slave
-unsigned int c_acksFromSlave = 0;		// count of acks from slave
-unsigned int c_encodedPackets = 0;		// count of roverPackets encoded
-unsigned int c_decodedPackets = 0;		// count of roverPackets decoded
-unsigned int c_queuedPackets = 0;		// count of roverPackets unwrapped and queued
+uint8_t c_worstRssi = 0; 				// highest magnitude since the last reset
+unsigned int c_queueHighWater[COM_QUEUES]; // deepest each queue got since the last reset
+unsigned int c_queueCapacity[COM_QUEUES]; // records each queue holds, 0 if on the heap
+unsigned int c_queueDrops[COM_QUEUES]; // packets each queue dropped since the last reset
+uint8_t c_payloadStats[COM_STATS_SIZE]; // statistics frame
+unsigned long c_failedEncodes = 0;		// count of failed attempts to encode a packet because buffer was full
+unsigned long c_msgsToMaster = 0;		// count of msgs sent to master
+unsigned long c_msgsFromMaster = 0;		// count of msgs received from master
+unsigned long c_acksFromMaster = 0;		// count of acks from master
+unsigned long c_msgsToSlave = 0;			// count of msgs sent to slave
+unsigned long c_msgsFromSlave = 0;		// count of msgs received from slave
+unsigned long c_acksFromSlave = 0;		// count of acks from slave
+unsigned long c_encodedPackets = 0;		// count of roverPackets encoded
+unsigned long c_decodedPackets = 0;		// count of roverPackets decoded
+unsigned long c_queuedPackets = 0;		// count of roverPackets unwrapped and queued
+
+#ifdef COM_HISTOGRAMS
+	uint16_t c_histograms[COM_HIST_KINDS][COM_HIST_COMMANDS][COM_HIST_BUCKETS]; // counts, see com_histBucket
+	uint8_t c_payloadHist[2 + COM_HIST_PER_FRAME * COM_HIST_ENTRY_SIZE]; // histogram frame
+	long c_clockOffset = 0; 			// sender time - millis()
+	bool c_clockSynced = false; 		// whether c_clockOffset was set
+#endif
 
 //------------------------------ Class Functions -----------------------
 //----------------------------------------------------------------------
@@ -81,10 +101,86 @@ void com_setupComs(uint32_t msb_master, uint32_t lsb_master, uint32_t msb_slave,
 	#endif
 }
 
+//----------------------------------------------------------------------
+// com_takeResponse Stores the frame xbee just read in rx16 or rx64 and 
+//					counts it by sender.
+// Preconditions:   xbee.readPacket was called.
+// Postconditions:  Returns RCV_SIXTEEN, RCV_SIXTYFOUR, RCV_UNTRUSTED or
+//					RCV_ERROR like com_receiveData.
+//----------------------------------------------------------------------
+static int com_takeResponse(bool ack) {
+	int retVal = RCV_ERROR;
+	#ifndef COM_USE_ROVER_ACKS
+		(void)ack;
+	#endif
+	
+	if (xbee.getResponse().isAvailable()) { // got something
+		if (xbee.getResponse().getApiId() == RX_16_RESPONSE || xbee.getResponse().getApiId() == RX_64_RESPONSE) {
+			// got a rx packet
+
+			if (xbee.getResponse().getApiId() == RX_16_RESPONSE) {
+				xbee.getResponse().getRx16Response(c_rx16);
+				retVal = RCV_SIXTEEN;
+				
+				// determine from who DEBUG
+				// uint16_t sender16 = c_rx16.getRemoteAddress16();
+			}
+			else {
+				xbee.getResponse().getRx64Response(c_rx64);
+				retVal = RCV_SIXTYFOUR;
+				
+				// determine from who DEBUG
+				uint32_t senderMsb = c_rx64.getRemoteAddress64().getMsb();
+				uint32_t senderLsb = c_rx64.getRemoteAddress64().getLsb();
+				if (senderLsb == c_addr64Master.getLsb() && senderMsb == c_addr64Master.getMsb()) {
+					c_msgsFromMaster++; // Got the message from master
+					#ifdef COM_USE_ROVER_ACKS
+						if (ack) {
+							xbee.send(c_tx64MasterAck);
+							#ifdef COM_DEBUG_ENCODE
+								Serial.println("\nRX: Sent RoverPacket ACK to master");
+								delay(100);
+							#endif
+						}
+						
+					#endif
+				}
+				else if (senderLsb == c_addr64Slave.getLsb() && senderMsb == c_addr64Slave.getMsb()) {
+					c_msgsFromSlave++; // Got the message from slave
+					#ifdef COM_USE_ROVER_ACKS
+						if (ack) {
+							xbee.send(c_tx64SlaveAck);
+							#ifdef COM_DEBUG_ENCODE
+								Serial.println("\nRX: Sent RoverPacket ACK to slave");
+								delay(100);
+							#endif
+						}
+					#endif
+				}
+				else {
+					TRACE(TRACE_UNTRUSTED, senderLsb & 0xFFFF, senderLsb >> 16);
+					retVal = RCV_UNTRUSTED; // Untrusted source
+				}
+			}
+		}
+		else {
+			// not something we were expecting
+			TRACE(TRACE_XBEE_API, xbee.getResponse().getApiId(), 0);
+		}
+	}
+	else if (xbee.getResponse().isError()) {
+		TRACE(TRACE_XBEE_ERROR, xbee.getResponse().getErrorCode(), TRACE_AT_RECEIVE);
+	}
+	
+	return retVal;
+}
+
 //----------------------------------------------------------------------
 // com_getAck -----	Waits for a TX_STATUS_RESPONSE packet from xbee and 
 // 					returns an integer reporting the status of the ACK 
 //					message. The TxStatusResponse is stored in txStatus.
+//					Rover packets received ahead of it are queued as by
+//					com_unwrapAndQueue64.
 // Preconditions:   xbee object is configured.
 // Postconditions:  Returns ACK_SUCCESS (0) if the recieved packet 
 //					contains a success ACK response,
@@ -94,38 +190,47 @@ void com_setupComs(uint32_t msb_master, uint32_t lsb_master, uint32_t msb_slave,
 //----------------------------------------------------------------------
 int com_getAck(int timeout) {
 	int retVal = ACK_FAILURE;
+	unsigned long start = millis();
+	long left = timeout;
   
 	// after sending a tx request, we expect a status response
-	// wait up to 5 seconds for the status response
-	if (xbee.readPacket(timeout)) {
-		// got a response!
+	// wait up to timeout ms for the status response
+	while (left > 0) {
+		if (xbee.readPacket(left)) {
+			// got a response!
 
-		// should be a znet tx status
-		if (xbee.getResponse().getApiId() == TX_STATUS_RESPONSE) {
-			TxStatusResponse txStatus = TxStatusResponse();
-			xbee.getResponse().getTxStatusResponse(txStatus);
+			// should be a znet tx status
+			if (xbee.getResponse().getApiId() == TX_STATUS_RESPONSE) {
+				TxStatusResponse txStatus = TxStatusResponse();
+				xbee.getResponse().getTxStatusResponse(txStatus);
 
-			// get the delivery status, the fifth byte
-			if (txStatus.getStatus() == SUCCESS) {
-				retVal = ACK_SUCCESS;
-			}
-			else {
-				// the remote XBee did not receive our packet.
-				retVal = txStatus.getStatus();
+				// get the delivery status, the fifth byte
+				if (txStatus.getStatus() == SUCCESS) {
+					retVal = ACK_SUCCESS;
+				}
+				else {
+					// the remote XBee did not receive our packet.
+					retVal = txStatus.getStatus();
+				}
+				break;
 			}
+			
+			// a frame from master or the other rover (e.g. a clock sync
+			// request) was ahead of the status, queue its packets. No
+			// rover ack, its tx status would be taken for this one.
+			if (com_takeResponse(false) == RCV_SIXTYFOUR && com_unwrapAndQueue64())
+				c_heldEStop = true; // reported by the next com_unwrapAndQueue64
 		}
-    
-	}
-	else if (xbee.getResponse().isError()) {
-		#ifdef COM_DEBUG_XBEE
-			Serial.print("Error reading ACK packet. Error code: ");
-			Serial.println(xbee.getResponse().getErrorCode());
-			delay(100);
-		#endif
-	}
-	else {
-		// local XBee did not provide a timely TX Status Response.
-		// Radio is not configured properly or connected.
+		else if (xbee.getResponse().isError()) {
+			// e.g. a frame cut short by a full serial buffer
+			TRACE(TRACE_XBEE_ERROR, xbee.getResponse().getErrorCode(), TRACE_AT_ACK);
+		}
+		else {
+			// local XBee did not provide a timely TX Status Response.
+			// Radio is not configured properly or connected.
+			break;
+		}
+		left = timeout - (long)(millis() - start);
 	}
 	
 	return retVal;
@@ -156,6 +261,8 @@ int com_getRoverAck64(int timeout) {
 	// Parse the xbee packet
 	int packetSize = c_rx64.getDataLength();
 	c_lastRssi = c_rx64.getRssi();
+	if (c_lastRssi > c_worstRssi)
+		c_worstRssi = c_lastRssi;
     uint8_t* data = c_rx64.getData();
 	
 	#ifdef COM_DEBUG_UNWRAP
@@ -243,85 +350,12 @@ int com_getRoverAck64() {
 //                  Returns RCV_ERROR (-1) if an error occured.
 //----------------------------------------------------------------------
 int com_receiveData(int timeout, bool ack) {
-	int retVal = RCV_ERROR;
-	
 	if (timeout == 0)
 		xbee.readPacket();
 	else
 		xbee.readPacket(timeout);
 	
-	if (xbee.getResponse().isAvailable()) { // got something
-		if (xbee.getResponse().getApiId() == RX_16_RESPONSE || xbee.getResponse().getApiId() == RX_64_RESPONSE) {
-			// got a rx packet
-
-			if (xbee.getResponse().getApiId() == RX_16_RESPONSE) {
-				xbee.getResponse().getRx16Response(c_rx16);
-				retVal = RCV_SIXTEEN;
-				
-				// determine from who DEBUG
-				// uint16_t sender16 = c_rx16.getRemoteAddress16();
-			}
-			else {
-				xbee.getResponse().getRx64Response(c_rx64);
-				retVal = RCV_SIXTYFOUR;
-				
-				// determine from who DEBUG
-				uint32_t senderMsb = c_rx64.getRemoteAddress64().getMsb();
-				uint32_t senderLsb = c_rx64.getRemoteAddress64().getLsb();
-				if (senderLsb == c_addr64Master.getLsb() && senderMsb == c_addr64Master.getMsb()) {
-					c_msgsFromMaster++; // Got the message from master
-					#ifdef COM_USE_ROVER_ACKS
-						if (ack) {
-							xbee.send(c_tx64MasterAck);
-							#ifdef COM_DEBUG_ENCODE
-								Serial.println("\nRX: Sent RoverPacket ACK to master");
-								delay(100);
-							#endif
-						}
-						
-					#endif
-				}
-				else if (senderLsb == c_addr64Slave.getLsb() && senderMsb == c_addr64Slave.getMsb()) {
-					c_msgsFromSlave++; // Got the message from slave
-					#ifdef COM_USE_ROVER_ACKS
-						if (ack) {
-							xbee.send(c_tx64SlaveAck);
-							#ifdef COM_DEBUG_ENCODE
-								Serial.println("\nRX: Sent RoverPacket ACK to slave");
-								delay(100);
-							#endif
-						}
-					#endif
-				}
-				else {
-					#ifdef COM_DEBUG_XBEE
-						Serial.print("RX: Untrusted source: ");
-						Serial.print(senderMsb);
-						Serial.println(senderLsb);
-						delay(100);
-					#endif
-					retVal = RCV_UNTRUSTED; // Untrusted source
-				}
-			}
-		}
-		else {
-			// not something we were expecting
-			#ifdef COM_DEBUG_XBEE
-				Serial.print("RX: Unexpected response. API ID: ");   
-				Serial.println(xbee.getResponse().getApiId());
-				delay(100);
-			#endif
-		}
-	}
-	else if (xbee.getResponse().isError()) {
-		#ifdef COM_DEBUG_XBEE
-			Serial.print("RX: Error reading packet. Error code: ");  
-			Serial.println(xbee.getResponse().getErrorCode());
-			delay(100);
-		#endif
-	}
-	
-	return retVal;
+	return com_takeResponse(ack);
 }
 
 // Overloaded receiveData with a default 0s timeout.
@@ -379,7 +413,8 @@ int com_sendMaster64(bool checkAck) {
 
 //----------------------------------------------------------------------
 // com_sendSlave64  Sends the currently loaded payload to the slave and
-//					then checks for an ack if checkAck is true.	
+//					then checks for an ack if checkAck is true. The
+//					frame only holds the loaded packets.
 // Preconditions:   xbee object is configured.
 // Postconditions:  payloadSlave is wiped and payloadEndSlave index is 
 //					reset to 0 if we arent checking for an ack or the 
@@ -391,6 +426,11 @@ int com_sendSlave64(bool checkAck) {
 	c_msgsToSlave++; // Debug
 	int retVal;
 	
+	// only the loaded packets, a short frame is off the serial lines sooner
+	// and both ways of a clock sync exchange take the same time
+	uint8_t len = c_payloadEndSlave > 0 ? c_payloadEndSlave : sizeof(c_payloadSlave);
+	c_tx64Slave.setPayloadLength(len);
+	
 	if (checkAck) { 
 		// Send the normal payload
 		xbee.send(c_tx64Slave);
@@ -411,7 +451,7 @@ int com_sendSlave64(bool checkAck) {
 			xbee.send(c_tx64Slave); // recipient doesn't know we aren't checking for an ack
 		#endif
 		#ifndef COM_USE_ROVER_ACKS
-			Tx64Request txNoACK = Tx64Request(c_addr64Slave, 0x01, c_payloadSlave, sizeof(c_payloadSlave), 0x0);
+			Tx64Request txNoACK = Tx64Request(c_addr64Slave, 0x01, c_payloadSlave, len, 0x0);
 			xbee.send(txNoACK);
 		#endif
 		
@@ -425,6 +465,34 @@ int com_sendSlave64(bool checkAck) {
 	return retVal;
 }
 
+#ifdef COM_HISTOGRAMS
+//----------------------------------------------------------------------
+// com_histBucket - Histogram bucket of a time.
+// Preconditions:   None.
+// Postconditions:  Returns 0 for ms <= 0, otherwise the bit length of ms
+//					limited to COM_HIST_BUCKETS - 1.
+//----------------------------------------------------------------------
+static uint8_t com_histBucket(long ms) {
+	uint8_t bucket = 0;
+	while (ms > 0 && bucket < COM_HIST_BUCKETS - 1) {
+		ms >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+//----------------------------------------------------------------------
+// com_recordHistogram Counts a time in a histogram.
+// Preconditions:   kind < COM_HIST_KINDS, cmd < COM_HIST_COMMANDS.
+// Postconditions:  The bucket is incremented unless it is saturated.
+//----------------------------------------------------------------------
+static void com_recordHistogram(uint8_t kind, uint8_t cmd, long ms) {
+	uint16_t* count = &c_histograms[kind][cmd][com_histBucket(ms)];
+	if (*count < 0xFFFF)
+		(*count)++;
+}
+#endif
+
 //----------------------------------------------------------------------
 // com_unwrapAndQueue64 Parses the data in the last rx64 xbee packet as 
 //					7 byte rover packets that are enqueued.
@@ -435,11 +503,14 @@ int com_sendSlave64(bool checkAck) {
 // 					also updated at this step.
 //----------------------------------------------------------------------
 bool com_unwrapAndQueue64() {
-	bool retVal = false; // bool to return if a high priority packet was received
+	bool retVal = c_heldEStop; // bool to return if a high priority packet was received
+	c_heldEStop = false;
 	
 	// Parse the xbee packet
 	int packetSize = c_rx64.getDataLength();
 	c_lastRssi = c_rx64.getRssi();
+	if (c_lastRssi > c_worstRssi)
+		c_worstRssi = c_lastRssi;
     uint8_t* data = c_rx64.getData();
     
 	#ifdef COM_DEBUG_UNWRAP
@@ -489,8 +560,19 @@ bool com_unwrapAndQueue64() {
 		#endif
 		
 		// Queue the packet
-		c_packetQueue.enqueue(thePacket);
+		QueuedPacket queued;
+		queued.packet = thePacket;
+		queued.queuedAt = millis();
+		#ifdef COM_HISTOGRAMS
+			if (c_clockSynced) {
+				unsigned long timestamp = ((unsigned long)thePacket.byte0 << 24) | ((unsigned long)thePacket.byte1 << 16) |
+						((unsigned long)thePacket.byte2 << 8) | thePacket.byte3;
+				com_recordHistogram(COM_HIST_LATENCY, thePacket.byte6 & 0x0F, (long)(millis() + c_clockOffset - timestamp));
+			}
+		#endif
+		c_packetQueue.enqueue(queued);
 		c_queuedPackets++; // Debug
+		com_noteQueueDepth(COM_QUEUE_PACKETS, c_packetQueue.count());
 		
 		#ifdef COM_DEBUG_QUEUE
 			Serial.println();
@@ -526,7 +608,9 @@ bool com_decodeNext(unsigned long* timestamp, unsigned char* cmd, int* lData, in
 		return false;
 	
 	// Dequeue the packet
-	RoverPacket thePacket = c_packetQueue.dequeue();
+	QueuedPacket queued = c_packetQueue.dequeue();
+	const RoverPacket& thePacket = queued.packet;
+	c_decodedAge = (uint16_t)millis() - queued.queuedAt;
 	c_decodedPackets++; // Debug
 	
 	#ifdef COM_DEBUG_QUEUE
@@ -566,24 +650,40 @@ bool com_decodeNext(unsigned long* timestamp, unsigned char* cmd, int* lData, in
 	(*timestamp) <<= 8;
 	(*timestamp) += thePacket.byte3;
 	
+	// sign extend through 16 bits so the result does not depend on the
+	// width of int (16 on the rovers, 32 on a host build)
+	int16_t data;
+	
 	// data left 32-39, 40-41
-	(*lData) = thePacket.byte4;
-	(*lData) <<= 8; // set the sign bit
-	(*lData) >>= 6; // repeat the sign bit
-	(*lData) += thePacket.byte5 >> 6; // grab last 2 bits
+	data = thePacket.byte4 << 8; // set the sign bit
+	data >>= 6; // repeat the sign bit
+	(*lData) = data + (thePacket.byte5 >> 6); // grab last 2 bits
 	
 	// data right 42-47, 48-51
-	(*rData) = thePacket.byte5;
-	(*rData) <<= 10; // set the sign bit and discard first two bits
-	(*rData) >>= 6; // repeat the sign bit
-	(*rData) += thePacket.byte6 >> 4; // grab last 4 bits
+	data = thePacket.byte5 << 10; // set the sign bit and discard first two bits
+	data >>= 6; // repeat the sign bit
+	(*rData) = data + (thePacket.byte6 >> 4); // grab last 4 bits
 	
 	// command 52-55
 	(*cmd) = thePacket.byte6 & 0x0F;
 	
+	#ifdef COM_HISTOGRAMS
+		com_recordHistogram(COM_HIST_RESIDENCE, *cmd, c_decodedAge);
+	#endif
+	
 	return true;
 }
 
+//----------------------------------------------------------------------
+// com_getDecodedAge Getter for how long the packet of the last
+//					com_decodeNext waited in packetQueue.
+// Preconditions:   None.
+// Postconditions:  Returns ms since it was received, up to 65535.
+//----------------------------------------------------------------------
+unsigned int com_getDecodedAge() {
+	return c_decodedAge;
+}
+
 //----------------------------------------------------------------------
 // com_encodeSlavePacket Encodes data as a roverPacket and loads it in 
 //					to the payload for the slave. An integer indicating 
@@ -783,93 +883,103 @@ uint8_t com_getLastRssi() {
 	return c_lastRssi;
 }
 
+//----------------------------------------------------------------------
+// com_getWorstRssi  Getter for the highest rssi magnitude since the
+//					statistics were reset.
+// Preconditions:   None.
+// Postconditions:  Returns an uint8_t.
+//----------------------------------------------------------------------
+uint8_t com_getWorstRssi() {
+	return c_worstRssi;
+}
+
 //----------------------------------------------------------------------
 // com_getMsgsToMaster  Getter for msgsToMaster.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getMsgsToMaster() {
+unsigned long com_getMsgsToMaster() {
 	return c_msgsToMaster;
 }
 
 //----------------------------------------------------------------------
 // com_getMsgsToSlave  Getter for msgsToSlave.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getMsgsToSlave() {
+unsigned long com_getMsgsToSlave() {
 	return c_msgsToSlave;
 }
 
 //----------------------------------------------------------------------
 // com_getMsgsToMaster  Getter for msgsFromMaster.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getMsgsFromMaster() {
+unsigned long com_getMsgsFromMaster() {
 	return c_msgsFromMaster;
 }
 
 //----------------------------------------------------------------------
 // com_getMsgsToSlave  Getter for msgsFromSlave.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getMsgsFromSlave() {
+unsigned long com_getMsgsFromSlave() {
 	return c_msgsFromSlave;
 }
 
 //----------------------------------------------------------------------
 // com_getAcksFromMaster  Getter for acksFromMaster.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getAcksFromMaster() {
+unsigned long com_getAcksFromMaster() {
 	return c_acksFromMaster;
 }
 
 //----------------------------------------------------------------------
 // com_getAcksFromSlave  Getter for acksFromSlave.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getAcksFromSlave() {
+unsigned long com_getAcksFromSlave() {
 	return c_acksFromSlave;
 }
 
 //----------------------------------------------------------------------
 // com_getEncodedPackets  Getter for encodedPackets.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getEncodedPackets() {
+unsigned long com_getEncodedPackets() {
 	return c_encodedPackets;
 }
 
 //----------------------------------------------------------------------
 // com_getDecodedPackets  Getter for decodedPackets.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getDecodedPackets() {
+unsigned long com_getDecodedPackets() {
 	return c_decodedPackets;
 }
 
 //----------------------------------------------------------------------
 // com_getFailedEncodes  Getter for failedEncodes.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getFailedEncodes() {
+unsigned long com_getFailedEncodes() {
 	return c_failedEncodes;
 }
 
 //----------------------------------------------------------------------
 // com_getQueuedPackets  Getter for queuedPackets.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getQueuedPackets() {
+unsigned long com_getQueuedPackets() {
 	return c_queuedPackets;
 }
 
@@ -882,22 +992,147 @@ int com_getCurrentlyQueuedPackets() {
 	return c_packetQueue.count();
 }
 
+//----------------------------------------------------------------------
+// com_putLong ---- Writes a value big endian.
+// Preconditions:   p holds bytes bytes, bytes <= 4.
+// Postconditions:  Returns p + bytes.
+//----------------------------------------------------------------------
+static uint8_t* com_putLong(uint8_t* p, unsigned long value, uint8_t bytes) {
+	for (uint8_t i = bytes; i > 0; i--) {
+		p[i - 1] = value & 0xFF;
+		value >>= 8;
+	}
+	return p + bytes;
+}
+
+//----------------------------------------------------------------------
+// com_noteQueueDepth Raises the high-water mark of a queue.
+// Preconditions:   queue < COM_QUEUES.
+// Postconditions:  The mark is the largest depth noted since the
+//					statistics were reset.
+//----------------------------------------------------------------------
+void com_noteQueueDepth(uint8_t queue, unsigned int depth) {
+	if (queue < COM_QUEUES && depth > c_queueHighWater[queue])
+		c_queueHighWater[queue] = depth;
+}
+
+//----------------------------------------------------------------------
+// com_getQueueHighWater Getter for the high-water mark of a queue.
+// Preconditions:   queue < COM_QUEUES.
+// Postconditions:  Returns an unsigned int.
+//----------------------------------------------------------------------
+unsigned int com_getQueueHighWater(uint8_t queue) {
+	return queue < COM_QUEUES ? c_queueHighWater[queue] : 0;
+}
+
+//----------------------------------------------------------------------
+// com_setQueueCapacity Sets the capacity reported for a queue.
+// Preconditions:   queue < COM_QUEUES, capacity is 0 for a queue on the
+//					heap.
+// Postconditions:  The capacity is sent with the statistics.
+//----------------------------------------------------------------------
+void com_setQueueCapacity(uint8_t queue, unsigned int capacity) {
+	if (queue < COM_QUEUES)
+		c_queueCapacity[queue] = capacity;
+}
+
+//----------------------------------------------------------------------
+// com_noteQueueDrop Counts a packet a full queue could not take.
+// Preconditions:   queue < COM_QUEUES.
+// Postconditions:  The count saturates at 0xFFFF until the statistics
+//					are reset.
+//----------------------------------------------------------------------
+void com_noteQueueDrop(uint8_t queue) {
+	if (queue < COM_QUEUES && c_queueDrops[queue] < 0xFFFF)
+		c_queueDrops[queue]++;
+}
+
+//----------------------------------------------------------------------
+// com_setClockOffset Sets the offset from millis() to the senders' clock
+//					and starts recording COM_HIST_LATENCY.
+// Preconditions:   offset is sender time - millis().
+// Postconditions:  Packets queued from now on are recorded with the
+//					latency millis() + offset - timestamp.
+//----------------------------------------------------------------------
+void com_setClockOffset(long offset) {
+	#ifdef COM_HISTOGRAMS
+		c_clockOffset = offset;
+		c_clockSynced = true;
+	#else
+		(void)offset;
+	#endif
+}
+
+//----------------------------------------------------------------------
+// com_getHistogram Getter for one bucket of a histogram.
+// Preconditions:   kind < COM_HIST_KINDS, cmd < COM_HIST_COMMANDS and
+//					bucket < COM_HIST_BUCKETS.
+// Postconditions:  Returns the count, 0 without COM_HISTOGRAMS.
+//----------------------------------------------------------------------
+unsigned int com_getHistogram(uint8_t kind, uint8_t cmd, uint8_t bucket) {
+	#ifdef COM_HISTOGRAMS
+		if (kind < COM_HIST_KINDS && cmd < COM_HIST_COMMANDS && bucket < COM_HIST_BUCKETS)
+			return c_histograms[kind][cmd][bucket];
+	#else
+		(void)kind;
+		(void)cmd;
+		(void)bucket;
+	#endif
+	return 0;
+}
+
+//----------------------------------------------------------------------
+// com_sendReport64 Sends a statistics or histogram frame to master with
+//					an optional ack.
+// Preconditions:   xbee object is configured, data holds len bytes and
+//					len is not a multiple of MIN_SIZE.
+// Postconditions:  Int code returned is the ack status code, 
+//					ACK_FAILURE (-1) if checkAck is false.
+//----------------------------------------------------------------------
+static int com_sendReport64(uint8_t* data, uint8_t len, bool checkAck) {
+	int retVal = ACK_FAILURE;
+	
+	#ifdef COM_USE_ROVER_ACKS
+		Tx64Request txReport = Tx64Request(c_addr64Master, 0x01, data, len, 0x0);
+	#endif
+	#ifndef COM_USE_ROVER_ACKS
+		Tx64Request txReport = checkAck ? Tx64Request(c_addr64Master, data, len) :
+				Tx64Request(c_addr64Master, 0x01, data, len, 0x0);
+	#endif
+	xbee.send(txReport);
+	
+	if (checkAck) {
+		#ifdef COM_USE_ROVER_ACKS
+			retVal = com_getRoverAck64();
+		#endif
+		#ifndef COM_USE_ROVER_ACKS
+			retVal = com_getAck();
+		#endif
+		
+		if (retVal == ACK_SUCCESS)
+			c_acksFromMaster++; // Debug
+	}
+	
+	return retVal;
+}
+
 //----------------------------------------------------------------------
 // com_sendStatistics64 Sends the current communnication statistics to 
-// 					master using roverPackets with an optional ack.
+// 					master as one statistics frame (COM_STATS_SIZE) with
+//					an optional ack, followed by the histogram frames
+//					when COM_HISTOGRAMS is defined.
 // Preconditions:   xbee object is configured
-// Postconditions:  payloadMaster is wiped and payloadEndMaster index is 
-//					reset to 0 per com_sendMaster64. Int code returned is 
-//					sum of ack status code(s). See com_getAck for more 
-//					information. ACK_FAILURE (-1) is always returned if 
-//					checkAck is false.
+// Postconditions:  The master payload is not touched. Int code returned
+//					is the ack status code of the statistics frame, or
+//					the first failed histogram frame. See com_getAck for
+//					more information. ACK_FAILURE (-1) is always returned
+//					if checkAck is false.
 //----------------------------------------------------------------------
 int com_sendStatistics64(bool checkAck) {
-	int retVal = 0;
-	int temp;
+	int retVal = ACK_FAILURE;
 	
 	#ifdef COM_DEBUG_STATS
-		Serial.println("Stats BEFORE");
+		Serial.println("Stats");
 		Serial.println("lastRssi: -" + String(c_lastRssi) + "db");
 		Serial.println("c_failedEncodes: " + String(c_failedEncodes) + " c_queuedPackets: " + String(c_queuedPackets));
 		Serial.println("c_msgsToMaster: " + String(c_msgsToMaster) + " c_msgsFromMaster: " + String(c_msgsFromMaster));
@@ -907,38 +1142,63 @@ int com_sendStatistics64(bool checkAck) {
 		delay(100);
 	#endif
 	
-	// Failed Encodes/Packets Queued
-	temp = com_encodeMasterPacket(0xF, c_failedEncodes, c_queuedPackets);
-	if (temp <= 0)
-		retVal += com_sendMaster64(checkAck);
-	
-	// Packets Encoded/Decoded
-	temp = com_encodeMasterPacket(0xB, c_encodedPackets, c_decodedPackets);
-	if (temp <= 0)
-		retVal += com_sendMaster64(checkAck);
-	
-	// Msgs to Master/Acks from Master
-	temp = com_encodeMasterPacket(0xE, c_msgsToMaster, c_acksFromMaster);
-	if (temp <= 0)
-		retVal += com_sendMaster64(checkAck);
+	c_msgsToMaster++; // Debug, counts this frame
 	
-	// Msgs to Slave/Acks from Slave
-	temp = com_encodeMasterPacket(0xD, c_msgsToSlave, c_acksFromSlave);
-	if (temp <= 0)
-		retVal += com_sendMaster64(checkAck);
+	// layout in Rover_Communication.h
+	const unsigned long counters[COM_STATS_COUNTERS] = { c_msgsToMaster, c_msgsFromMaster, 
+			c_acksFromMaster, c_msgsToSlave, c_msgsFromSlave, c_acksFromSlave, 
+			c_encodedPackets, c_decodedPackets, c_queuedPackets, c_failedEncodes };
+	uint8_t* p = c_payloadStats;
+	*p++ = COM_STATS_MARKER;
+	*p++ = COM_STATS_VERSION;
+	for (uint8_t i = 0; i < COM_STATS_COUNTERS; i++)
+		p = com_putLong(p, counters[i], 4);
+	*p++ = c_lastRssi;
+	*p++ = c_worstRssi;
+	for (uint8_t i = 0; i < COM_QUEUES; i++)
+		p = com_putLong(p, c_queueHighWater[i], 2);
+	for (uint8_t i = 0; i < COM_QUEUES; i++)
+		p = com_putLong(p, c_queueCapacity[i], 2);
+	for (uint8_t i = 0; i < COM_QUEUES; i++)
+		p = com_putLong(p, c_queueDrops[i], 2);
+	com_putLong(p, millis(), 4);
+	retVal = com_sendReport64(c_payloadStats, COM_STATS_SIZE, checkAck);
 	
-	// Msgs from Master/Slave
-	temp = com_encodeMasterPacket(0xC, c_msgsFromMaster, c_msgsFromSlave);
-	retVal += com_sendMaster64(checkAck);	
-	
-	#ifdef COM_DEBUG_STATS
-		Serial.println();
-		Serial.println("AFTER lastRssi: -" + String(c_lastRssi) + "db c_queuedPackets: " + String(c_queuedPackets));
-		Serial.println("c_msgsToMaster: " + String(c_msgsToMaster) + " c_msgsFromMaster: " + String(c_msgsFromMaster));
-		Serial.println("c_msgsToSlave: " + String(c_msgsToSlave) + " c_msgsFromSlave: " + String(c_msgsFromSlave));
-		Serial.println("c_acksFromMaster: " + String(c_acksFromMaster) + " c_acksFromSlave: " + String(c_acksFromSlave));
-		Serial.println("c_encodedPackets: " + String(c_encodedPackets) + " c_decodedPackets: " + String(c_decodedPackets));
-		delay(100);
+	#ifdef COM_HISTOGRAMS
+		// histograms with counts, COM_HIST_PER_FRAME to a frame
+		uint8_t entries = 0;
+		c_payloadHist[0] = COM_HIST_MARKER;
+		c_payloadHist[1] = COM_HIST_VERSION;
+		p = c_payloadHist + 2;
+		for (uint8_t kind = 0; kind < COM_HIST_KINDS; kind++) {
+			for (uint8_t cmd = 0; cmd < COM_HIST_COMMANDS; cmd++) {
+				const uint16_t* counts = c_histograms[kind][cmd];
+				uint8_t b = 0;
+				while (b < COM_HIST_BUCKETS && counts[b] == 0)
+					b++;
+				if (b == COM_HIST_BUCKETS)
+					continue;
+				
+				*p++ = (kind << 4) | cmd;
+				for (b = 0; b < COM_HIST_BUCKETS; b++)
+					p = com_putLong(p, counts[b], 2);
+				
+				if (++entries == COM_HIST_PER_FRAME) {
+					c_msgsToMaster++; // Debug
+					int status = com_sendReport64(c_payloadHist, p - c_payloadHist, checkAck);
+					if (retVal == ACK_SUCCESS)
+						retVal = status;
+					entries = 0;
+					p = c_payloadHist + 2;
+				}
+			}
+		}
+		if (entries > 0) {
+			c_msgsToMaster++; // Debug
+			int status = com_sendReport64(c_payloadHist, p - c_payloadHist, checkAck);
+			if (retVal == ACK_SUCCESS)
+				retVal = status;
+		}
 	#endif
 	
 	return retVal;
@@ -949,8 +1209,10 @@ int com_sendStatistics64(bool checkAck) {
 // Preconditions:   None.
 // Postconditions:  msgsToMaster, msgsToSlave, msgsFromMaster, 
 //					msgsFromSlave, acksFromMaster, acksFromSlave, 
-// 					encodedPackets, decodedPackets, queuedPackets, and 
-//					failedEncodes are all reset to 0.
+// 					encodedPackets, decodedPackets, queuedPackets, 
+//					failedEncodes, worstRssi, the queue high-water
+//					marks and the histograms are all reset to 0. The
+//					clock offset is kept.
 //----------------------------------------------------------------------
 void com_resetStatistics() {
 	c_msgsToMaster = 0;			// count of msgs sent to master
@@ -963,6 +1225,14 @@ void com_resetStatistics() {
 	c_decodedPackets = 0;		// count of roverPackets decoded
 	c_queuedPackets = 0;		// count of roverPackets unwrapped and queued
 	c_failedEncodes = 0;		// count of failed attempts to encode a packet because buffer was full
+	c_worstRssi = 0;			// highest rssi magnitude
+	for (uint8_t i = 0; i < COM_QUEUES; i++) {
+		c_queueHighWater[i] = 0;
+		c_queueDrops[i] = 0;
+	}
+	#ifdef COM_HISTOGRAMS
+		memset(c_histograms, 0, sizeof(c_histograms));
+	#endif
 }
 
 //----------------------------------------------------------------------
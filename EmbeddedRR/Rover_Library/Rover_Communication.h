@@ -12,6 +12,7 @@
 #include <XBee.h>
 #include <QueueArray.h>
 #include <Arduino.h>
+#include "Rover_Trace.h"
 
 //---------------------------- Definitions -----------------------------
 // Configuration
@@ -22,9 +23,10 @@
 // #define COM_USE_ROVER_ACKS // Whether to use xbee acks or roverpacket acks
 // Note that no additional data should be packed with a roverpacket ack
 
+// #define COM_HISTOGRAMS // residence and latency histograms per command (726 bytes of RAM)
+
 // #define COM_DEBUG_ENCODE
 // #define COM_DEBUG_UNWRAP
-// #define COM_DEBUG_XBEE
 // #define COM_DEBUG_STATS
 // #define COM_DEBUG_QUEUE
 
@@ -37,6 +39,52 @@
 #define RCV_UNTRUSTED -2
 #define ENCODE_ERROR -1
 
+/* Statistics frame sent by com_sendStatistics64, big endian like the
+ * roverPacket timestamp. COM_STATS_SIZE is not a multiple of MIN_SIZE so
+ * the frame is never taken for roverPackets.
+ *   0  COM_STATS_MARKER, COM_STATS_VERSION
+ *   2  msgsToMaster, msgsFromMaster, acksFromMaster, msgsToSlave,
+ *      msgsFromSlave, acksFromSlave, encodedPackets, decodedPackets,
+ *      queuedPackets, failedEncodes (4 bytes each)
+ *  42  lastRssi, worstRssi (1 byte each)
+ *  44  high-water marks of the COM_QUEUES queues (2 bytes each)
+ *  48  capacities of the COM_QUEUES queues, 0 if unbounded (2 bytes each)
+ *  52  packets dropped by each of the COM_QUEUES queues (2 bytes each)
+ *  56  millis() when sent (4 bytes)
+ * Version 1 ended with millis() at 48.
+ */
+#define COM_STATS_MARKER 0x53 	// 'S'
+#define COM_STATS_VERSION 2
+#define COM_STATS_COUNTERS 10
+#define COM_STATS_SIZE 60
+
+// Queues with a high-water mark, capacity and drops in the statistics
+#define COM_QUEUE_PACKETS 0 	// packetQueue, noted by com_unwrapAndQueue64
+#define COM_QUEUE_NAV 1 		// navigation queue, noted by the sketch
+#define COM_QUEUES 2
+
+/* Histogram frames sent by com_sendStatistics64 after the statistics
+ * frame when COM_HISTOGRAMS is defined, one frame per COM_HIST_PER_FRAME
+ * histograms that have counts. 2 + 21 * n bytes is never a multiple of
+ * MIN_SIZE either.
+ *   0  COM_HIST_MARKER, COM_HIST_VERSION
+ *   2  per histogram: kind << 4 | command (1 byte), then the
+ *      COM_HIST_BUCKETS counts (2 bytes each, saturating)
+ * Bucket 0 counts 0 ms or less, bucket b counts 2^(b-1) to 2^b - 1 ms and
+ * the last bucket everything from 2^(COM_HIST_BUCKETS-2) ms up.
+ */
+#define COM_HIST_MARKER 0x48 	// 'H'
+#define COM_HIST_VERSION 1
+#define COM_HIST_BUCKETS 10 	// last bucket is 256 ms and up
+#define COM_HIST_COMMANDS 16
+#define COM_HIST_PER_FRAME 4 	// 86 bytes
+#define COM_HIST_ENTRY_SIZE (1 + 2 * COM_HIST_BUCKETS)
+
+// Histogram kinds
+#define COM_HIST_RESIDENCE 0 	// enqueue in packetQueue to com_decodeNext
+#define COM_HIST_LATENCY 1 		// sender timestamp to enqueue, needs com_setClockOffset
+#define COM_HIST_KINDS 2
+
 /* ACK error codes:
  *  01: An expected MAC acknowledgement never occured
  *  02: CCA failure
@@ -74,13 +122,15 @@
  *	0110 0x6 Start Search/Follow
  *	0111 0x7 IR Sensor Data/Request
  *	1000 0x8 Mag Sensor Data
- *	1001 0x9 
+ *	1001 0x9 Profile Data
  *	1010 0xA Navigation Data/ACK
- *	1011 0xB Packets Encoded/Decoded
- *	1100 0xC Msgs from Master/Slave
- *	1101 0xD Msgs to Slave/Acks from Slave
- *	1110 0xE Msgs to Master/Acks from Master
- *	1111 0xF Failed Encodes/Packets Queued
+ *	1011 0xB Clock Sync (see Rover_Clock.h)
+ *	1100 0xC unused
+ *	1101 0xD unused
+ *	1110 0xE unused
+ *	1111 0xF unused
+ *	0xB - 0xF carried the statistics before the statistics frame, the
+ *	terminal still decodes them for older firmware
  */
 
 // Rover Packet (7 bytes):
@@ -106,6 +156,8 @@ void com_setupComs(uint32_t msb_master, uint32_t lsb_master, uint32_t msb_slave,
 // com_getAck -----	Waits for a TX_STATUS_RESPONSE packet from xbee and 
 // 					returns an integer reporting the status of the ACK 
 //					message. The TxStatusResponse is stored in txStatus.
+//					Rover packets received ahead of it are queued as by
+//					com_unwrapAndQueue64.
 // Preconditions:   xbee object is configured.
 // Postconditions:  Returns ACK_SUCCESS (0) if the recieved packet 
 //					contains a success ACK response,
@@ -160,7 +212,8 @@ int com_sendMaster64(bool checkAck);
 
 //----------------------------------------------------------------------
 // com_sendSlave64  Sends the currently loaded payload to the slave and
-//					then checks for an ack if checkAck is true.	
+//					then checks for an ack if checkAck is true. The
+//					frame only holds the loaded packets.
 // Preconditions:   xbee object is configured.
 // Postconditions:  payloadSlave is wiped and payloadEndSlave index is 
 //					reset to 0 if we arent checking for an ack or the 
@@ -176,7 +229,8 @@ int com_sendSlave64(bool checkAck);
 // Preconditions:   Data has been receieved already and enough memory
 //					is available.
 // Postconditions:  7 byte rover packets are enqueued. If a high priority
-//					packet is received, true is returned. Worst rssi 
+//					packet is received, or was queued by com_getAck since
+//					the last call, true is returned. Worst rssi 
 // 					value is also updated.
 //----------------------------------------------------------------------
 bool com_unwrapAndQueue64();
@@ -189,6 +243,14 @@ bool com_unwrapAndQueue64();
 //----------------------------------------------------------------------
 bool com_decodeNext(unsigned long* timestamp, unsigned char* cmd, int* lData, int* rData);
 
+//----------------------------------------------------------------------
+// com_getDecodedAge Getter for how long the packet of the last
+//					com_decodeNext waited in packetQueue.
+// Preconditions:   None.
+// Postconditions:  Returns ms since it was received, up to 65535.
+//----------------------------------------------------------------------
+unsigned int com_getDecodedAge();
+
 //----------------------------------------------------------------------
 // com_encodeSlavePacket Encodes data as a roverPacket and loads it in 
 //					to the payload for the slave. An integer indicating 
@@ -235,75 +297,83 @@ void com_emptyPayload(bool slave);
 //----------------------------------------------------------------------
 uint8_t com_getLastRssi();
 
+//----------------------------------------------------------------------
+// com_getWorstRssi  Getter for the highest rssi magnitude since the
+//					statistics were reset.
+// Preconditions:   None.
+// Postconditions:  Returns an uint8_t.
+//----------------------------------------------------------------------
+uint8_t com_getWorstRssi();
+
 //----------------------------------------------------------------------
 // com_getMsgsToMaster  Getter for msgsToMaster.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getMsgsToMaster();
+unsigned long com_getMsgsToMaster();
 
 //----------------------------------------------------------------------
 // com_getMsgsToSlave  Getter for msgsToSlave.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getMsgsToSlave();
+unsigned long com_getMsgsToSlave();
 
 //----------------------------------------------------------------------
 // com_getMsgsToMaster  Getter for msgsFromMaster.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getMsgsFromMaster();
+unsigned long com_getMsgsFromMaster();
 
 //----------------------------------------------------------------------
 // com_getMsgsToSlave  Getter for msgsFromSlave.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getMsgsFromSlave();
+unsigned long com_getMsgsFromSlave();
 
 //----------------------------------------------------------------------
 // com_getAcksFromMaster  Getter for acksFromMaster.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getAcksFromMaster();
+unsigned long com_getAcksFromMaster();
 
 //----------------------------------------------------------------------
 // com_getAcksFromSlave  Getter for acksFromSlave.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getAcksFromSlave();
+unsigned long com_getAcksFromSlave();
 
 //----------------------------------------------------------------------
 // com_getEncodedPackets  Getter for encodedPackets.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getEncodedPackets();
+unsigned long com_getEncodedPackets();
 
 //----------------------------------------------------------------------
 // com_getDecodedPackets  Getter for decodedPackets.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getDecodedPackets();
+unsigned long com_getDecodedPackets();
 
 //----------------------------------------------------------------------
 // com_getFailedEncodes  Getter for failedEncodes.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getFailedEncodes();
+unsigned long com_getFailedEncodes();
 
 //----------------------------------------------------------------------
 // com_getQueuedPackets  Getter for total queuedPackets.
 // Preconditions:   None.
-// Postconditions:  Returns an unsigned int.
+// Postconditions:  Returns an unsigned long.
 //----------------------------------------------------------------------
-unsigned int com_getQueuedPackets();
+unsigned long com_getQueuedPackets();
 
 //----------------------------------------------------------------------
 // com_getQueuedPackets  Getter for currently queuedPackets.
@@ -312,15 +382,65 @@ unsigned int com_getQueuedPackets();
 //----------------------------------------------------------------------
 int com_getCurrentlyQueuedPackets();
 
+//----------------------------------------------------------------------
+// com_noteQueueDepth Raises the high-water mark of a queue.
+// Preconditions:   queue < COM_QUEUES.
+// Postconditions:  The mark is the largest depth noted since the
+//					statistics were reset.
+//----------------------------------------------------------------------
+void com_noteQueueDepth(uint8_t queue, unsigned int depth);
+
+//----------------------------------------------------------------------
+// com_getQueueHighWater Getter for the high-water mark of a queue.
+// Preconditions:   queue < COM_QUEUES.
+// Postconditions:  Returns an unsigned int.
+//----------------------------------------------------------------------
+unsigned int com_getQueueHighWater(uint8_t queue);
+
+//----------------------------------------------------------------------
+// com_setQueueCapacity Sets the capacity reported for a queue.
+// Preconditions:   queue < COM_QUEUES, capacity is 0 for a queue on the
+//					heap.
+// Postconditions:  The capacity is sent with the statistics.
+//----------------------------------------------------------------------
+void com_setQueueCapacity(uint8_t queue, unsigned int capacity);
+
+//----------------------------------------------------------------------
+// com_noteQueueDrop Counts a packet a full queue could not take.
+// Preconditions:   queue < COM_QUEUES.
+// Postconditions:  The count saturates at 0xFFFF until the statistics
+//					are reset.
+//----------------------------------------------------------------------
+void com_noteQueueDrop(uint8_t queue);
+
+//----------------------------------------------------------------------
+// com_setClockOffset Sets the offset from millis() to the senders' clock
+//					and starts recording COM_HIST_LATENCY.
+// Preconditions:   offset is sender time - millis().
+// Postconditions:  Packets queued from now on are recorded with the
+//					latency millis() + offset - timestamp.
+//----------------------------------------------------------------------
+void com_setClockOffset(long offset);
+
+//----------------------------------------------------------------------
+// com_getHistogram Getter for one bucket of a histogram.
+// Preconditions:   kind < COM_HIST_KINDS, cmd < COM_HIST_COMMANDS and
+//					bucket < COM_HIST_BUCKETS.
+// Postconditions:  Returns the count, 0 without COM_HISTOGRAMS.
+//----------------------------------------------------------------------
+unsigned int com_getHistogram(uint8_t kind, uint8_t cmd, uint8_t bucket);
+
 //----------------------------------------------------------------------
 // com_sendStatistics64 Sends the current communnication statistics to 
-// 					master using roverPackets with an optional ack.
+// 					master as one statistics frame (COM_STATS_SIZE) with
+//					an optional ack, followed by the histogram frames
+//					when COM_HISTOGRAMS is defined.
 // Preconditions:   xbee object is configured
-// Postconditions:  payloadMaster is wiped and payloadEndMaster index is 
-//					reset to 0 per com_sendMaster64. Int code returned is 
-//					sum of ack status code(s). See com_getAck for more 
-//					information. ACK_FAILURE (-1) is always returned if 
-//					checkAck is false.
+// Postconditions:  The master payload is not touched. Int code returned
+//					is the ack status code of the statistics frame, or
+//					the first failed histogram frame. See com_getAck for
+//					more information. ACK_FAILURE (-1) is always returned
+//					if checkAck is false.
 //----------------------------------------------------------------------
 int com_sendStatistics64(bool checkAck);
 
@@ -329,8 +449,10 @@ int com_sendStatistics64(bool checkAck);
 // Preconditions:   None.
 // Postconditions:  msgsToMaster, msgsToSlave, msgsFromMaster, 
 //					msgsFromSlave, acksFromMaster, acksFromSlave, 
-// 					encodedPackets, decodedPackets, queuedPackets, and 
-//					failedEncodes are all reset to 0.
+// 					encodedPackets, decodedPackets, queuedPackets, 
+//					failedEncodes, worstRssi, the queue high-water
+//					marks and the histograms are all reset to 0. The
+//					clock offset is kept.
 //----------------------------------------------------------------------
 void com_resetStatistics();
 
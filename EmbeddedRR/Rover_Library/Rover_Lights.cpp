@@ -3,120 +3,337 @@
 // Project Team:  	EmbeddedRR
 // Group Members: 	Robert Griswold and Ryu Muthui
 // Date:          	28 Nov 2016
-// Description:   	Class for LED light controls.
+// Description:   	Class for LED light controls with cached pixels and
+//					non-blocking animation layers.
 //----------------------------------------------------------------------
 #include "Rover_Lights.h"
 
 //---------------------------- Initialization --------------------------
-Adafruit_NeoPixel l_strip = Adafruit_NeoPixel(2, A0, NEO_RGB + NEO_KHZ800);
+Adafruit_NeoPixel l_strip = Adafruit_NeoPixel(LIGHT_PIXELS, A0, NEO_RGB + NEO_KHZ800);
+
+uint32_t l_base[LIGHT_PIXELS] = {0, 0}; 	// colors set by light_light*()
+uint32_t l_pixels[LIGHT_PIXELS] = {0, 0}; 	// base with the layers on top
+uint32_t l_shown[LIGHT_PIXELS] = {0, 0}; 	// colors last pushed to the strip
+bool l_dirty = false; 						// l_pixels differ from l_shown
+unsigned long l_dirtyTime = 0; 				// millis() when l_dirty was set
+unsigned long l_showTime = 0; 				// millis() of the last push
+unsigned int l_interval = LIGHT_INTERVAL_MS;
+bool l_deferOnRx = false;
+
+// Animation types
+#define LIGHT_ANIM_NONE 0
+#define LIGHT_ANIM_SEQUENCE 1
+#define LIGHT_ANIM_BLINK 2
+#define LIGHT_ANIM_PULSE 3
+
+// Animation of an overlay layer
+struct LightAnimation {
+	uint8_t type;
+	uint8_t repeats; 			// LIGHT_FOREVER or plays left from start
+	const LightFrame *frames; 	// sequence
+	uint8_t count;
+	uint32_t colors[2]; 		// blink on and off, pulse color
+	unsigned int period; 		// ms of one play
+	unsigned long start; 		// millis() of the first play
+};
+
+LightAnimation l_layers[LIGHT_LAYERS];
 
 //------------------------------ Class Functions -----------------------
+//----------------------------------------------------------------------
+// light_show() -- Writes the cached colors to the strip now.
+//----------------------------------------------------------------------
+static void light_show() {
+	for (uint8_t i = 0; i < LIGHT_PIXELS; i++) {
+		l_strip.setPixelColor(i, l_pixels[i]);
+		l_shown[i] = l_pixels[i];
+	}
+	l_strip.show();
+	l_showTime = millis();
+	l_dirty = false;
+}
+
+//----------------------------------------------------------------------
+// light_scale() -- Scales a color by level / 255.
+//----------------------------------------------------------------------
+static uint32_t light_scale(uint32_t color, uint8_t level) {
+	uint8_t r = ((color >> 16) & 0xFF) * level / 255;
+	uint8_t g = ((color >> 8) & 0xFF) * level / 255;
+	uint8_t b = (color & 0xFF) * level / 255;
+	return LIGHT_COLOR(r, g, b);
+}
+
+//----------------------------------------------------------------------
+// light_evaluate() -- Colors of an animation at now. Returns false once
+// it has finished.
+//----------------------------------------------------------------------
+static bool light_evaluate(const LightAnimation *anim, unsigned long now, uint32_t *frame) {
+	unsigned long elapsed = now - anim->start;
+	if (anim->repeats != LIGHT_FOREVER && elapsed >= (unsigned long)anim->period * anim->repeats)
+		return false;
+	unsigned int phase = elapsed % anim->period;
+	unsigned int half = anim->period / 2;
+
+	switch (anim->type) {
+		case LIGHT_ANIM_SEQUENCE:
+			for (uint8_t i = 0; i < anim->count; i++) {
+				if (phase < anim->frames[i].ms) {
+					frame[0] = anim->frames[i].bottom;
+					frame[1] = anim->frames[i].top;
+					break;
+				}
+				phase -= anim->frames[i].ms;
+			}
+			break;
+
+		case LIGHT_ANIM_BLINK:
+			frame[0] = frame[1] = anim->colors[phase < half ? 0 : 1];
+			break;
+
+		case LIGHT_ANIM_PULSE: { // triangle, up for half a period and down again
+			unsigned long level = (unsigned long)(phase < half ? phase : anim->period - phase) * 255 / half;
+			frame[0] = frame[1] = light_scale(anim->colors[0], level > 255 ? 255 : level);
+			break;
+		}
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------
+// light_compose() -- Puts the playing layers over the base colors for
+// light_update(). Finished animations are stopped.
+//----------------------------------------------------------------------
+static void light_compose(unsigned long now) {
+	for (uint8_t p = 0; p < LIGHT_PIXELS; p++)
+		l_pixels[p] = l_base[p];
+
+	for (uint8_t i = 0; i < LIGHT_LAYERS; i++) {
+		uint32_t frame[LIGHT_PIXELS];
+		if (l_layers[i].type == LIGHT_ANIM_NONE)
+			continue;
+		if (!light_evaluate(&l_layers[i], now, frame)) {
+			l_layers[i].type = LIGHT_ANIM_NONE;
+			continue;
+		}
+		for (uint8_t p = 0; p < LIGHT_PIXELS; p++) {
+			if (frame[p] != LIGHT_CLEAR)
+				l_pixels[p] = frame[p];
+		}
+	}
+
+	bool changed = l_pixels[0] != l_shown[0] || l_pixels[1] != l_shown[1];
+	if (changed && !l_dirty)
+		l_dirtyTime = now;
+	l_dirty = changed; // back to the shown colors cancels a pending push
+}
+
+//----------------------------------------------------------------------
+// light_set() -- Caches the base colors of both LEDs for light_update().
+//----------------------------------------------------------------------
+static void light_set(uint32_t bottom, uint32_t top) {
+	l_base[0] = bottom;
+	l_base[1] = top;
+	light_compose(millis());
+}
+
+//----------------------------------------------------------------------
+// light_play() -- Starts an animation on a layer.
+//----------------------------------------------------------------------
+static void light_play(uint8_t layer, const LightAnimation *anim) {
+	if (layer >= LIGHT_LAYERS || anim->period == 0)
+		return;
+	l_layers[layer] = *anim;
+	l_layers[layer].start = millis();
+	light_compose(l_layers[layer].start);
+}
+
 //----------------------------------------------------------------------
 // light_setupLights() -- Initializes the lights
 //----------------------------------------------------------------------
 void light_setupLights() {
 	l_strip.begin();
-	light_clearLights();
+	for (uint8_t i = 0; i < LIGHT_LAYERS; i++)
+		l_layers[i].type = LIGHT_ANIM_NONE;
+	for (uint8_t p = 0; p < LIGHT_PIXELS; p++)
+		l_base[p] = l_pixels[p] = LIGHT_OFF;
+	light_show();
+}
+
+//----------------------------------------------------------------------
+// light_setRefresh() -- Sets the minimum time between two pushes to the
+// strip and whether a push waits until Serial has no received bytes
+// (at most LIGHT_MAX_DEFER_MS).
+//----------------------------------------------------------------------
+void light_setRefresh(unsigned int intervalMs, bool deferOnRx) {
+	l_interval = intervalMs;
+	l_deferOnRx = deferOnRx;
+}
+
+//----------------------------------------------------------------------
+// light_update() -- Pushes the cached colors if they changed and the
+// refresh limits allow it. Returns true if the strip was written.
+//----------------------------------------------------------------------
+bool light_update() {
+	unsigned long now = millis();
+	for (uint8_t i = 0; i < LIGHT_LAYERS; i++) {
+		if (l_layers[i].type != LIGHT_ANIM_NONE) {
+			light_compose(now);
+			break;
+		}
+	}
+	if (!l_dirty)
+		return false;
+
+	if (now - l_showTime < l_interval)
+		return false;
+	if (l_deferOnRx && Serial.available() > 0 && now - l_dirtyTime < LIGHT_MAX_DEFER_MS)
+		return false; // a frame is arriving, don't block its bytes
+
+	light_show();
+	return true;
+}
+
+//----------------------------------------------------------------------
+// light_flush() -- Pushes a pending color change now, ignoring the
+// refresh limits.
+//----------------------------------------------------------------------
+void light_flush() {
+	if (l_dirty)
+		light_show();
+}
+
+//----------------------------------------------------------------------
+// light_isPending() -- Returns true if a color change is waiting for
+// light_update().
+//----------------------------------------------------------------------
+bool light_isPending() {
+	return l_dirty;
+}
+
+//----------------------------------------------------------------------
+// light_playSequence() -- Plays count frames on a layer, repeats times
+// (LIGHT_FOREVER until stopped). The frames are not copied and must
+// stay valid while playing.
+//----------------------------------------------------------------------
+void light_playSequence(uint8_t layer, const LightFrame *frames, uint8_t count, uint8_t repeats) {
+	LightAnimation anim = {LIGHT_ANIM_SEQUENCE, repeats, frames, count, {LIGHT_CLEAR, LIGHT_CLEAR}, 0, 0};
+	for (uint8_t i = 0; i < count; i++)
+		anim.period += frames[i].ms;
+	light_play(layer, &anim);
+}
+
+//----------------------------------------------------------------------
+// light_blink() -- Shows on then off on both LEDs of a layer for half a
+// period each, repeats times (LIGHT_FOREVER until stopped).
+//----------------------------------------------------------------------
+void light_blink(uint8_t layer, uint32_t on, uint32_t off, unsigned int periodMs, uint8_t repeats) {
+	LightAnimation anim = {LIGHT_ANIM_BLINK, repeats, NULL, 0, {on, off}, periodMs, 0};
+	light_play(layer, &anim);
+}
+
+//----------------------------------------------------------------------
+// light_pulse() -- Fades both LEDs of a layer from off to color and back
+// once per period, repeats times (LIGHT_FOREVER until stopped).
+//----------------------------------------------------------------------
+void light_pulse(uint8_t layer, uint32_t color, unsigned int periodMs, uint8_t repeats) {
+	LightAnimation anim = {LIGHT_ANIM_PULSE, repeats, NULL, 0, {color, LIGHT_CLEAR}, periodMs < 2 ? 0 : periodMs, 0};
+	light_play(layer, &anim);
+}
+
+//----------------------------------------------------------------------
+// light_stopLayer() -- Stops the animation of a layer, the layers below
+// show again.
+//----------------------------------------------------------------------
+void light_stopLayer(uint8_t layer) {
+	if (layer >= LIGHT_LAYERS || l_layers[layer].type == LIGHT_ANIM_NONE)
+		return;
+	l_layers[layer].type = LIGHT_ANIM_NONE;
+	light_compose(millis());
+}
+
+//----------------------------------------------------------------------
+// light_isPlaying() -- Returns true if a layer has an animation that has
+// not finished.
+//----------------------------------------------------------------------
+bool light_isPlaying(uint8_t layer) {
+	if (layer >= LIGHT_LAYERS || l_layers[layer].type == LIGHT_ANIM_NONE)
+		return false;
+	uint32_t frame[LIGHT_PIXELS];
+	return light_evaluate(&l_layers[layer], millis(), frame);
 }
 
 //----------------------------------------------------------------------
 // light_clearLights() -- Turns all the LEDs off, reseting them.
 //----------------------------------------------------------------------
 void light_clearLights() {
-	l_strip.setPixelColor(0, 0, 0, 0); // bottom
-	l_strip.setPixelColor(1, 0, 0, 0); // top
-	l_strip.show();
+	light_set(LIGHT_OFF, LIGHT_OFF);
 }
 
 //----------------------------------------------------------------------
 // light_lightRed() -- Turns both the LEDs to RED.
 //----------------------------------------------------------------------
 void light_lightRed() {
-	l_strip.setPixelColor(0, MAX_VAL, 0, 0);
-	l_strip.setPixelColor(1, MAX_VAL, 0, 0);
-	l_strip.show();
+	light_set(LIGHT_RED, LIGHT_RED);
 }
 
 //----------------------------------------------------------------------
 // light_lightPurple() -- Turns both the LEDs to PURPLE.
 //----------------------------------------------------------------------
 void light_lightPurple() {
-	l_strip.setPixelColor(0, MAX_VAL, 0, MAX_VAL);
-	l_strip.setPixelColor(1, MAX_VAL, 0, MAX_VAL);
-	l_strip.show();
+	light_set(LIGHT_PURPLE, LIGHT_PURPLE);
 }
 
 //----------------------------------------------------------------------
 // light_lightGreen() -- Turns both the LEDs to GREEN.
 //----------------------------------------------------------------------
 void light_lightGreen() {
-	l_strip.setPixelColor(0, 0, MAX_VAL, 0);
-	l_strip.setPixelColor(1, 0, MAX_VAL, 0);
-	l_strip.show();
+	light_set(LIGHT_GREEN, LIGHT_GREEN);
 }
 
 //----------------------------------------------------------------------
 // light_lightBlue() -- Turns both the LEDs to BLUE.
 //----------------------------------------------------------------------
 void light_lightBlue() {
-	l_strip.setPixelColor(0, 0, 0, MAX_VAL);
-	l_strip.setPixelColor(1, 0, 0, MAX_VAL);
-	l_strip.show();
+	light_set(LIGHT_BLUE, LIGHT_BLUE);
 }
 
 //----------------------------------------------------------------------
 // light_lightYellow() -- Turns both the LEDs to YELLOW.
 //----------------------------------------------------------------------
 void light_lightYellow() {
-	l_strip.setPixelColor(0, MAX_VAL, MAX_VAL, 0);
-	l_strip.setPixelColor(1, MAX_VAL, MAX_VAL, 0);
-	l_strip.show();
+	light_set(LIGHT_YELLOW, LIGHT_YELLOW);
 }
 
 //----------------------------------------------------------------------
 // light_lightWhite() -- Turns both the LEDs to WHITE.
 //----------------------------------------------------------------------
 void light_lightWhite() {
-	l_strip.setPixelColor(0, MAX_VAL, MAX_VAL, MAX_VAL);
-	l_strip.setPixelColor(1, MAX_VAL, MAX_VAL, MAX_VAL);
-	l_strip.show();
+	light_set(LIGHT_WHITE, LIGHT_WHITE);
 }
 
 //----------------------------------------------------------------------
 // light_turnLeft() -- Turns bottom LED to GREEN, top to YELLOW.
 //----------------------------------------------------------------------
 void light_turnLeft() {
-	l_strip.setPixelColor(0, 0, MAX_VAL, 0);
-	l_strip.setPixelColor(1, MAX_VAL, MAX_VAL, 0);
-	l_strip.show();
+	light_set(LIGHT_GREEN, LIGHT_YELLOW);
 }
 
 //----------------------------------------------------------------------
 // light_turnRight() -- Turns bottom LED to YELLOW, top to GREEN.
 //----------------------------------------------------------------------
 void light_turnRight() {
-	l_strip.setPixelColor(0, MAX_VAL, MAX_VAL, 0);
-	l_strip.setPixelColor(1, 0, MAX_VAL, 0);
-	l_strip.show();
+	light_set(LIGHT_YELLOW, LIGHT_GREEN);
 }
 
 //----------------------------------------------------------------------
-// light_PoliceMode() -- Flicker police flash 10 times
+// light_PoliceMode() -- Flicker police flash 10 times on the alert
+// layer (1.5 s), the base colors return afterwards.
 //----------------------------------------------------------------------
 void light_PoliceMode() {
-	for (uint8_t i = 0; i < 10; i++) {
-		l_strip.setPixelColor(0, 0, 0, MAX_VAL);// blue
-		l_strip.setPixelColor(1, MAX_VAL, 0, 0);// red              
-		l_strip.show();
-		delay(50);
-		l_strip.setPixelColor(0, MAX_VAL, MAX_VAL, MAX_VAL);// white
-		l_strip.setPixelColor(1, MAX_VAL, MAX_VAL, MAX_VAL);// white
-		l_strip.show();
-		delay(50);
-		l_strip.setPixelColor(0, MAX_VAL, 0, 0);// red
-		l_strip.setPixelColor(1, 0, 0, MAX_VAL);// blue
-		l_strip.show();
-		delay(50);
-	}
-	light_clearLights();
+	static const LightFrame police[] = {
+		{LIGHT_BLUE, LIGHT_RED, 50},
+		{LIGHT_WHITE, LIGHT_WHITE, 50},
+		{LIGHT_RED, LIGHT_BLUE, 50}
+	};
+	light_playSequence(LIGHT_LAYER_ALERT, police, sizeof(police) / sizeof(police[0]), 10);
 }
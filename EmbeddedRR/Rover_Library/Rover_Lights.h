@@ -3,7 +3,23 @@
 // Project Team:  	EmbeddedRR
 // Group Members: 	Robert Griswold and Ryu Muthui
 // Date:          	28 Nov 2016
-// Description:   	Class for LED light controls.
+// Description:   	Class for LED light controls. The light_light*()
+//					and light_turn*() calls only cache both pixels.
+//					light_update(), called from loop(), pushes them to
+//					the strip when a color changed, at most once per
+//					refresh interval and, optionally, only while no
+//					serial bytes are waiting. show() disables interrupts
+//					for the WS2812 bit timing, so every skipped push is
+//					time the UART is not blocked. Colors set and replaced
+//					within one interval are never shown.
+//					Animations (keyframe sequences, blink, pulse) play on
+//					overlay layers above these base colors and are
+//					advanced by light_update() from millis(), so they
+//					never block loop(). The highest layer with a color
+//					for a pixel wins; LIGHT_CLEAR lets the layer below
+//					show through. Usage:
+//						light_lightGreen(); // base, e.g. the state
+//						light_blink(LIGHT_LAYER_ALERT, LIGHT_PURPLE, LIGHT_CLEAR, 200, 3);
 //------------------------------ Includes ------------------------------
 #ifndef _Rover_Lights_h_
 #define _Rover_Lights_h_
@@ -13,6 +29,34 @@
 
 //---------------------------- Definitions -----------------------------
 #define MAX_VAL 150 // MAX brightness value
+#define LIGHT_PIXELS 2 			// bottom, top
+#define LIGHT_INTERVAL_MS 50 	// default minimum time between pushes
+#define LIGHT_MAX_DEFER_MS 250 	// longest a push waits for an empty serial buffer
+
+// Colors, packed like Adafruit_NeoPixel::Color
+#define LIGHT_COLOR(r, g, b) (((uint32_t)(r) << 16) | ((uint32_t)(g) << 8) | (b))
+#define LIGHT_OFF LIGHT_COLOR(0, 0, 0)
+#define LIGHT_RED LIGHT_COLOR(MAX_VAL, 0, 0)
+#define LIGHT_PURPLE LIGHT_COLOR(MAX_VAL, 0, MAX_VAL)
+#define LIGHT_GREEN LIGHT_COLOR(0, MAX_VAL, 0)
+#define LIGHT_BLUE LIGHT_COLOR(0, 0, MAX_VAL)
+#define LIGHT_YELLOW LIGHT_COLOR(MAX_VAL, MAX_VAL, 0)
+#define LIGHT_WHITE LIGHT_COLOR(MAX_VAL, MAX_VAL, MAX_VAL)
+#define LIGHT_CLEAR 0xFF000000UL 	// no color, the layer below shows
+
+// Overlay layers, higher ones win
+#define LIGHT_LAYER_STATUS 0 	// e.g. communication indicators
+#define LIGHT_LAYER_ALERT 1 	// e.g. emergency stop
+#define LIGHT_LAYERS 2
+
+#define LIGHT_FOREVER 0 		// repeats of an animation that runs until stopped
+
+// One keyframe of a sequence
+struct LightFrame {
+	uint32_t bottom;
+	uint32_t top;
+	unsigned int ms; 	// time the frame is shown
+};
 
 //------------------------------ Class Functions -----------------------
 //----------------------------------------------------------------------
@@ -20,6 +64,62 @@
 //----------------------------------------------------------------------
 void light_setupLights();
 
+//----------------------------------------------------------------------
+// light_setRefresh() -- Sets the minimum time between two pushes to the
+// strip and whether a push waits until Serial has no received bytes
+// (at most LIGHT_MAX_DEFER_MS).
+//----------------------------------------------------------------------
+void light_setRefresh(unsigned int intervalMs, bool deferOnRx);
+
+//----------------------------------------------------------------------
+// light_update() -- Pushes the cached colors if they changed and the
+// refresh limits allow it. Returns true if the strip was written.
+//----------------------------------------------------------------------
+bool light_update();
+
+//----------------------------------------------------------------------
+// light_flush() -- Pushes a pending color change now, ignoring the
+// refresh limits.
+//----------------------------------------------------------------------
+void light_flush();
+
+//----------------------------------------------------------------------
+// light_isPending() -- Returns true if a color change is waiting for
+// light_update().
+//----------------------------------------------------------------------
+bool light_isPending();
+
+//----------------------------------------------------------------------
+// light_playSequence() -- Plays count frames on a layer, repeats times
+// (LIGHT_FOREVER until stopped). The frames are not copied and must
+// stay valid while playing.
+//----------------------------------------------------------------------
+void light_playSequence(uint8_t layer, const LightFrame *frames, uint8_t count, uint8_t repeats);
+
+//----------------------------------------------------------------------
+// light_blink() -- Shows on then off on both LEDs of a layer for half a
+// period each, repeats times (LIGHT_FOREVER until stopped).
+//----------------------------------------------------------------------
+void light_blink(uint8_t layer, uint32_t on, uint32_t off, unsigned int periodMs, uint8_t repeats);
+
+//----------------------------------------------------------------------
+// light_pulse() -- Fades both LEDs of a layer from off to color and back
+// once per period, repeats times (LIGHT_FOREVER until stopped).
+//----------------------------------------------------------------------
+void light_pulse(uint8_t layer, uint32_t color, unsigned int periodMs, uint8_t repeats);
+
+//----------------------------------------------------------------------
+// light_stopLayer() -- Stops the animation of a layer, the layers below
+// show again.
+//----------------------------------------------------------------------
+void light_stopLayer(uint8_t layer);
+
+//----------------------------------------------------------------------
+// light_isPlaying() -- Returns true if a layer has an animation that has
+// not finished.
+//----------------------------------------------------------------------
+bool light_isPlaying(uint8_t layer);
+
 //----------------------------------------------------------------------
 // light_clearLights() -- Turns all the LEDs off, reseting them.
 //----------------------------------------------------------------------
@@ -66,7 +166,8 @@ void light_turnLeft();
 void light_turnRight();
 
 //----------------------------------------------------------------------
-// light_PoliceMode() -- Flicker police flash 10 times
+// light_PoliceMode() -- Flicker police flash 10 times on the alert
+// layer (1.5 s), the base colors return afterwards.
 //----------------------------------------------------------------------
 void light_PoliceMode();
 
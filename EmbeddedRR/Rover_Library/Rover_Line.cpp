@@ -0,0 +1,129 @@
+//----------------------------- Rover_Line -----------------------------
+// Filename:      	Rover_Line.cpp
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Line estimator for the four QRE1113 sensors.
+//------------------------------ Includes ------------------------------
+#include "Rover_Line.h"
+
+//------------------------------ Globals -------------------------------
+// position of each sensor, the outer ones are 3 times further out
+const int l_weights[LINE_SENSORS] = { -LINE_POS_MAX, -LINE_POS_MAX / 3, LINE_POS_MAX / 3, LINE_POS_MAX };
+
+int l_history[LINE_SENSORS][LINE_MEDIAN]; 	// last sets, oldest overwritten
+long l_ema[LINE_SENSORS]; 					// filtered values, LINE_FRAC_BITS fraction
+uint8_t l_sets = 0; 						// sets seen, saturates at LINE_MEDIAN
+uint8_t l_next = 0; 						// history slot of the next set
+int l_position = 0;
+uint8_t l_confidence = 0;
+
+//----------------------------------------------------------------------
+// median3 -------- Median of three values.
+// Preconditions:   None.
+// Postconditions:  Returns the middle value.
+//----------------------------------------------------------------------
+static int median3(int a, int b, int c) {
+	if (a > b) {
+		int t = a;
+		a = b;
+		b = t;
+	}
+	// a <= b
+	if (c <= a)
+		return a;
+	return c < b ? c : b;
+}
+
+//----------------------------------------------------------------------
+// line_reset ----- Forgets all sets.
+// Preconditions:   None.
+// Postconditions:  The next set seeds the filters, the position is 0 and
+//					the confidence is 0.
+//----------------------------------------------------------------------
+void line_reset() {
+	l_sets = 0;
+	l_next = 0;
+	l_position = 0;
+	l_confidence = 0;
+}
+
+//----------------------------------------------------------------------
+// line_update ---- Filters a new set of IR values and updates the
+//					estimate.
+// Preconditions:   vals holds LINE_SENSORS decay times (LL, L, R, RR),
+//					higher means darker.
+// Postconditions:  The filtered values, position and confidence are
+//					updated. Without contrast the position is kept.
+//----------------------------------------------------------------------
+void line_update(const int *vals) {
+	// the first set fills the history and the EMA so there is no ramp up
+	for (uint8_t i = 0; i < LINE_SENSORS; i++) {
+		if (l_sets == 0) {
+			for (uint8_t j = 0; j < LINE_MEDIAN; j++)
+				l_history[i][j] = vals[i];
+			l_ema[i] = (long)vals[i] << LINE_FRAC_BITS;
+		}
+		else {
+			l_history[i][l_next] = vals[i];
+			long median = (long)median3(l_history[i][0], l_history[i][1], l_history[i][2]) << LINE_FRAC_BITS;
+			l_ema[i] += (median - l_ema[i]) >> LINE_EMA_SHIFT; // arithmetic shift, rounds down
+		}
+	}
+	l_next = (l_next + 1) % LINE_MEDIAN;
+	if (l_sets < LINE_MEDIAN)
+		l_sets++;
+
+	// darkness above the lightest sensor, the floor
+	int filtered[LINE_SENSORS];
+	line_getFiltered(filtered);
+	int floor = filtered[0];
+	int ceiling = filtered[0];
+	for (uint8_t i = 1; i < LINE_SENSORS; i++) {
+		floor = min(floor, filtered[i]);
+		ceiling = max(ceiling, filtered[i]);
+	}
+	int contrast = ceiling - floor;
+	l_confidence = contrast >= LINE_CONTRAST ? LINE_CONF_MAX : (long)contrast * LINE_CONF_MAX / LINE_CONTRAST;
+	if (contrast == 0)
+		return;
+
+	// centroid of the darkness
+	long sum = 0;
+	long moment = 0;
+	for (uint8_t i = 0; i < LINE_SENSORS; i++) {
+		long dark = filtered[i] - floor;
+		sum += dark;
+		moment += dark * l_weights[i];
+	}
+	l_position = moment / sum;
+}
+
+//----------------------------------------------------------------------
+// line_getFiltered Copies the filtered IR values.
+// Preconditions:   vals holds LINE_SENSORS ints.
+// Postconditions:  vals is in the order and unit of line_update.
+//----------------------------------------------------------------------
+void line_getFiltered(int *vals) {
+	for (uint8_t i = 0; i < LINE_SENSORS; i++)
+		vals[i] = (l_ema[i] + (1 << (LINE_FRAC_BITS - 1))) >> LINE_FRAC_BITS;
+}
+
+//----------------------------------------------------------------------
+// line_getPosition Getter for the line position.
+// Preconditions:   None.
+// Postconditions:  Returns -LINE_POS_MAX (under LL) to LINE_POS_MAX
+//					(under RR), 0 is centred between L and R.
+//----------------------------------------------------------------------
+int line_getPosition() {
+	return l_position;
+}
+
+//----------------------------------------------------------------------
+// line_getConfidence Getter for how clearly a line is seen.
+// Preconditions:   None.
+// Postconditions:  Returns 0 (uniform floor) to LINE_CONF_MAX.
+//----------------------------------------------------------------------
+uint8_t line_getConfidence() {
+	return l_confidence;
+}
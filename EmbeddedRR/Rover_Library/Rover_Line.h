@@ -0,0 +1,75 @@
+//----------------------------- Rover_Line -----------------------------
+// Filename:      	Rover_Line.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Line estimator for the four QRE1113 sensors. Each
+//					sensor is filtered with a median of the last 3 sets
+//					(drops single sample spikes) followed by an integer
+//					exponential moving average. From the filtered values
+//					a continuous line position and a confidence are
+//					computed, all in integer arithmetic.
+//					Usage:
+//						if (sensor_updateIrSampling()) {
+//							sensor_getIrSample(curSensorVals);
+//							line_update(curSensorVals);
+//						}
+//						int pos = line_getPosition();
+//------------------------------ Includes ------------------------------
+#ifndef _Rover_Line_h_
+#define _Rover_Line_h_
+
+#include <Arduino.h>
+
+//---------------------------- Definitions -----------------------------
+#define LINE_SENSORS 4 		// LL, L, R, RR
+#define LINE_MEDIAN 3 		// sets in the median (median3)
+#define LINE_EMA_SHIFT 2 	// EMA weight of a new set is 1/2^shift
+#define LINE_FRAC_BITS 4 	// fraction bits of the EMA state
+
+#define LINE_POS_MAX 1000 	// position under an outer sensor
+#define LINE_CONTRAST 1000 	// us between darkest and lightest for full confidence
+#define LINE_CONF_MAX 255 	// confidence of a clear line
+
+//------------------------------ Class Functions ------------------------
+//----------------------------------------------------------------------
+// line_reset ----- Forgets all sets.
+// Preconditions:   None.
+// Postconditions:  The next set seeds the filters, the position is 0 and
+//					the confidence is 0.
+//----------------------------------------------------------------------
+void line_reset();
+
+//----------------------------------------------------------------------
+// line_update ---- Filters a new set of IR values and updates the
+//					estimate.
+// Preconditions:   vals holds LINE_SENSORS decay times (LL, L, R, RR),
+//					higher means darker.
+// Postconditions:  The filtered values, position and confidence are
+//					updated. Without contrast the position is kept.
+//----------------------------------------------------------------------
+void line_update(const int *vals);
+
+//----------------------------------------------------------------------
+// line_getFiltered Copies the filtered IR values.
+// Preconditions:   vals holds LINE_SENSORS ints.
+// Postconditions:  vals is in the order and unit of line_update.
+//----------------------------------------------------------------------
+void line_getFiltered(int *vals);
+
+//----------------------------------------------------------------------
+// line_getPosition Getter for the line position.
+// Preconditions:   None.
+// Postconditions:  Returns -LINE_POS_MAX (under LL) to LINE_POS_MAX
+//					(under RR), 0 is centred between L and R.
+//----------------------------------------------------------------------
+int line_getPosition();
+
+//----------------------------------------------------------------------
+// line_getConfidence Getter for how clearly a line is seen.
+// Preconditions:   None.
+// Postconditions:  Returns 0 (uniform floor) to LINE_CONF_MAX.
+//----------------------------------------------------------------------
+uint8_t line_getConfidence();
+
+#endif
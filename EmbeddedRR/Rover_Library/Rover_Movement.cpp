@@ -13,244 +13,431 @@ Adafruit_MotorShield AFMS = Adafruit_MotorShield();
 // Select which 'port' M1, M2, M3 or M4. In this case, M3 and M4
 Adafruit_DCMotor *rightMotor = AFMS.getMotor(3);
 Adafruit_DCMotor *leftMotor = AFMS.getMotor(4);
+// Their PCA9685 channels, written directly in bursts
+const MoveChannels m_rightPins = { 2, 4, 3 };
+const MoveChannels m_leftPins = { 7, 5, 6 };
+
+// Shadow of the motor channels from SHIELD_FIRST: 0 - 4095 duty, 4096 full on
+uint16_t m_shadow[SHIELD_CHANNELS];		// last written, 0xFFFF unknown
+uint16_t m_pending[SHIELD_CHANNELS];	// to write at the next flush
 
 int m_currentRight, m_currentLeft;
 int m_targetRight, m_targetLeft;
-// int m_smoothCounterLeft, m_smoothCounterRight;
+MoveRamp m_rampRight, m_rampLeft;
+unsigned long m_lastUpdate;
+bool m_sCurve;
+
+// Motion queue, m_motion[m_motionHead] runs once m_motionStarted
+MoveSegment m_motion[MOVE_QUEUE_SIZE];
+uint8_t m_motionHead, m_motionCount;
+bool m_motionStarted;
+unsigned long m_motionStart;		// micros() the running segment started
+int m_motionFromLeft, m_motionFromRight; // speeds it started from
+
+// Cubic (i/16)^3 in 256ths for i = 0 to 16, replacing pow in move_smoothTurnRate
+const uint16_t m_cubic[17] = { 0, 0, 1, 2, 4, 8, 14, 21, 32, 46, 63, 83, 108, 137, 172, 211, 256 };
 
 //------------------------------ Class Functions -----------------------
+//----------------------------------------------------------------------
+// move_writeChannel() -- queue a PCA9685 channel value for the next flush
+//----------------------------------------------------------------------
+static void move_writeChannel(uint8_t pin, uint16_t value) {
+	m_pending[pin - SHIELD_FIRST] = value;
+}
+
+//----------------------------------------------------------------------
+// move_flushMotors() -- write the changed channels, one auto-increment
+// burst per run of adjacent changes
+//----------------------------------------------------------------------
+static void move_flushMotors() {
+	uint8_t first = 0;
+	while (first < SHIELD_CHANNELS) {
+		if (m_pending[first] == m_shadow[first]) {
+			first++;
+			continue;
+		}
+		uint8_t last = first;
+		while (last + 1 < SHIELD_CHANNELS && m_pending[last + 1] != m_shadow[last + 1])
+			last++;
+
+		// a lone duty change only needs the OFF registers, ON stays 0
+		bool offOnly = last == first && m_pending[first] < 4096 && m_shadow[first] < 4096;
+		Wire.beginTransmission(SHIELD_ADDR);
+		Wire.write((uint8_t)(SHIELD_LED0_ON_L + 4 * (SHIELD_FIRST + first) + (offOnly ? 2 : 0)));
+		for (uint8_t i = first; i <= last; i++) {
+			uint16_t on = m_pending[i] >= 4096 ? 4096 : 0;
+			uint16_t off = m_pending[i] >= 4096 ? 0 : m_pending[i];
+			if (!offOnly) {
+				Wire.write((uint8_t)on);
+				Wire.write((uint8_t)(on >> 8));
+			}
+			Wire.write((uint8_t)off);
+			Wire.write((uint8_t)(off >> 8));
+			m_shadow[i] = m_pending[i];
+		}
+		Wire.endTransmission();
+		first = last + 1;
+	}
+}
+
 //----------------------------------------------------------------------
 // move_setupMotors() -- Initializes the motors
 //----------------------------------------------------------------------
 void move_setupMotors() {
 	AFMS.begin();
-	rightMotor->setSpeed(SPEED_STOP);
-	leftMotor->setSpeed(SPEED_STOP);
-	rightMotor->run(RELEASE);
-	leftMotor->run(RELEASE);
+	for (uint8_t i = 0; i < SHIELD_CHANNELS; i++) {
+		m_shadow[i] = 0xFFFF;
+		m_pending[i] = 0;
+	}
+	move_flushMotors(); // stopped and released
 	m_currentRight = 0;
 	m_currentLeft = 0;
 	m_targetRight = 0;
 	m_targetLeft = 0;
-	// m_smoothCounterLeft = 0;
-	// m_smoothCounterRight = 0;
+	move_setRamp(RAMP_ACCEL, RAMP_DECEL);
+	m_sCurve = false;
+	m_lastUpdate = micros();
+	move_clearMotion();
+}
+
+//----------------------------------------------------------------------
+// move_setI2CClock() -- set the I2C bus clock, I2C_STANDARD or I2C_FAST.
+// Call after every begin() on the bus, Wire.begin() resets it.
+//----------------------------------------------------------------------
+void move_setI2CClock(uint32_t clock) {
+	Wire.setClock(clock);
+}
+
+//----------------------------------------------------------------------
+// move_setRamp() -- set the accel/decel limits of both motors in speed
+// steps per second
+//----------------------------------------------------------------------
+void move_setRamp(unsigned int accel, unsigned int decel) {
+	move_setRampLeft(accel, decel);
+	move_setRampRight(accel, decel);
+}
+
+//----------------------------------------------------------------------
+// move_setRampLeft() -- set the accel/decel limits of the left motor
+//----------------------------------------------------------------------
+void move_setRampLeft(unsigned int accel, unsigned int decel) {
+	m_rampLeft.accel = accel;
+	m_rampLeft.decel = decel;
+}
+
+//----------------------------------------------------------------------
+// move_setRampRight() -- set the accel/decel limits of the right motor
+//----------------------------------------------------------------------
+void move_setRampRight(unsigned int accel, unsigned int decel) {
+	m_rampRight.accel = accel;
+	m_rampRight.decel = decel;
+}
+
+//----------------------------------------------------------------------
+// move_setSCurve() -- ease into each ramp on the cubic of 
+// move_smoothTurnRate instead of starting at the full rate
+//----------------------------------------------------------------------
+void move_setSCurve(bool enable) {
+	m_sCurve = enable;
 }
 
 //----------------------------------------------------------------------
 // move_smoothTurnRate() -- smooths the turn rate based on a cubic function
+// of the time since the ramp began. Returns 256ths of the full rate.
 //----------------------------------------------------------------------
-/*void move_smoothTurnRate(int *current, int target, int *smoothCounter) { // avg 328 microseconds with pow
-	//unsigned long start = micros(); // timer from device power on
+unsigned int move_smoothTurnRate(unsigned long elapsed) { // was avg 328 microseconds with pow
+	if (elapsed >= RAMP_SCURVE_US)
+		return 256;
 
-	// determine if smoothCounter increments or decrements
-	if ((target - (*current)) < 0)
-		(*smoothCounter)--;
-	else
-		(*smoothCounter)++;
-	//Serial.print("current: " + String(*current) + " target:" + String(target) + " smoothCounter:" + String(*smoothCounter));
+	// interpolate between the table entries, 16 steps apart
+	unsigned int pos = elapsed * 256 / RAMP_SCURVE_US;
+	uint8_t i = pos >> 4;
+	unsigned int rate = m_cubic[i] + (((m_cubic[i + 1] - m_cubic[i]) * (pos & 15)) >> 4);
 
-	double delta = 0.0;
-	if ((*smoothCounter) > 0) {
-		delta = ceil(fastPow((((double)(*smoothCounter))/ALPHA),3));
-		*current = min((*current) + delta, target);
-	}
-	else {
-		delta = floor(fastPow((((double)(*smoothCounter))/ALPHA),3));
-		*current = max((*current) + delta, target);
+	// like the ceil() of the old cubic, never stall at the start
+	return max(rate, (unsigned int)RAMP_SCURVE_MIN);
+}
+
+//----------------------------------------------------------------------
+// move_setSpeed() -- queues a speed and the matching direction of one
+// motor, channels that do not change are not written again
+//----------------------------------------------------------------------
+static void move_setSpeed(const MoveChannels *motor, int *current, int speed) {
+	*current = speed;
+	move_writeChannel(motor->pwm, min(abs(speed), SPEED_MAX) * 16);
+
+	// set dir of motor: IN1 high forward, IN2 high backward, both low release
+	move_writeChannel(motor->in1, speed > 0 ? 4096 : 0);
+	move_writeChannel(motor->in2, speed < 0 ? 4096 : 0);
+}
+
+//----------------------------------------------------------------------
+// move_rampMotor() -- moves one motor towards its target by the steps
+// owed for dt microseconds
+//----------------------------------------------------------------------
+static void move_rampMotor(const MoveChannels *motor, int *current, int target, 
+						   MoveRamp *ramp, unsigned long now, unsigned long dt) {
+	if (*current == target) {
+		ramp->frac = 0;
+		ramp->start = now;
+		return;
 	}
-	//Serial.println(" delta: " + String(delta) + " newCurrent:" + String(*current));
-	//Serial.println(fastPow((((double)(*smoothCounter))/ALPHA),3));
-	//Serial.println("calculation time:" + String(micros() - start));
-}*/
+
+	// away from stop accelerates, towards (or through) stop decelerates
+	bool accel = *current == 0 || (*current > 0) == (target > *current);
+	unsigned long owed = dt * (accel ? ramp->accel : ramp->decel);
+	if (m_sCurve)
+		owed = (owed >> 8) * move_smoothTurnRate(now - ramp->start);
+	
+	ramp->frac += owed;
+	if (ramp->frac < 1000000UL)
+		return;
+	
+	int steps = ramp->frac / 1000000UL;
+	ramp->frac -= steps * 1000000UL;
+
+	if (target > *current)
+		move_setSpeed(motor, current, min(*current + steps, target));
+	else
+		move_setSpeed(motor, current, max(*current - steps, target));
+}
+
+//----------------------------------------------------------------------
+// move_aimLeft() -- set the left target, starting a new ramp if idle
+//----------------------------------------------------------------------
+static void move_aimLeft(int left) {
+	if (m_currentLeft == m_targetLeft) // a new ramp begins
+		m_rampLeft.start = micros();
+	m_targetLeft = left;
+}
+
+//----------------------------------------------------------------------
+// move_aimRight() -- set the right target, starting a new ramp if idle
+//----------------------------------------------------------------------
+static void move_aimRight(int right) {
+	if (m_currentRight == m_targetRight) // a new ramp begins
+		m_rampRight.start = micros();
+	m_targetRight = right;
+}
 
 //----------------------------------------------------------------------
 // move_setTarget() -- set the motor speeds for both at same time
 //----------------------------------------------------------------------
 void move_setTarget(int left, int right) {
-	m_targetRight = right;
-	m_targetLeft = left;
+	move_clearMotion();
+	move_aimLeft(left);
+	move_aimRight(right);
 }
 
 //----------------------------------------------------------------------
 // move_setTargetLeft() -- set the motor speeds for left motor
 //----------------------------------------------------------------------
 void move_setTargetLeft(int left) {
-	m_targetLeft = left;
+	move_clearMotion();
+	move_aimLeft(left);
 }
 
 //----------------------------------------------------------------------
 // move_setTargetRight() -- set the motor speeds for right motor
 //----------------------------------------------------------------------
 void move_setTargetRight(int right) {
-	m_targetRight = right;
+	move_clearMotion();
+	move_aimRight(right);
 }
 
 //----------------------------------------------------------------------
-// move_updateMotors() -- update the motor speeds per iteration
+// move_queueSegment() -- append a segment to the motion queue, false if
+// the queue is full
 //----------------------------------------------------------------------
-void move_updateMotors() {
-	if (m_targetLeft != m_currentLeft) {
-		if (m_targetLeft > m_currentLeft) { // 4 microseconds
-			m_currentLeft++;
-		}
-		else {
-			m_currentLeft--;
-		}
-		//move_smoothTurnRate(&m_currentLeft, m_targetLeft, &m_smoothCounterLeft);
-		leftMotor->setSpeed(abs(m_currentLeft));
+static bool move_queueSegment(uint8_t type, int startLeft, int startRight, int left, 
+							  int right, unsigned long ms, MoveCallback done) {
+	if (m_motionCount >= MOVE_QUEUE_SIZE)
+		return false;
 
-		// set dir of left motor
-		if (m_currentLeft == 1) {
-			leftMotor->run(FORWARD);
-		}
-		else if (m_currentLeft == -1) {
-			leftMotor->run(BACKWARD);
-		}
-		else if (m_currentLeft == 0) {
-			leftMotor->run(RELEASE);
+	MoveSegment *seg = &m_motion[(m_motionHead + m_motionCount) % MOVE_QUEUE_SIZE];
+	seg->type = type;
+	seg->startLeft = startLeft;
+	seg->startRight = startRight;
+	seg->left = left;
+	seg->right = right;
+	seg->ms = ms;
+	seg->done = done;
+	m_motionCount++;
+	return true;
+}
+
+//----------------------------------------------------------------------
+// move_queueRamp() -- queue a ramp to the speeds at the ramp rates.
+// Returns false if the motion queue is full.
+//----------------------------------------------------------------------
+bool move_queueRamp(int left, int right, MoveCallback done) {
+	return move_queueSegment(MOVE_RAMP, MOVE_KEEP, MOVE_KEEP, left, right, 0, done);
+}
+
+//----------------------------------------------------------------------
+// move_queueHold() -- queue a ramp to the speeds that completes after ms.
+// Returns false if the motion queue is full.
+//----------------------------------------------------------------------
+bool move_queueHold(int left, int right, unsigned long ms, MoveCallback done) {
+	return move_queueSegment(MOVE_HOLD, MOVE_KEEP, MOVE_KEEP, left, right, ms, done);
+}
+
+//----------------------------------------------------------------------
+// move_queueSweep() -- queue a linear change of the speeds over ms, 
+// jumping to the start speeds first unless they are MOVE_KEEP. Returns 
+// false if the motion queue is full.
+//----------------------------------------------------------------------
+bool move_queueSweep(int startLeft, int startRight, int left, int right, 
+					 unsigned long ms, MoveCallback done) {
+	return move_queueSegment(MOVE_SWEEP, startLeft, startRight, left, right, ms, done);
+}
+
+//----------------------------------------------------------------------
+// move_clearMotion() -- drop all queued segments without their callbacks
+// and leave the motors ramping to the current targets
+//----------------------------------------------------------------------
+void move_clearMotion() {
+	m_motionHead = 0;
+	m_motionCount = 0;
+	m_motionStarted = false;
+}
+
+//----------------------------------------------------------------------
+// move_getQueuedMotion() -- Getter for the number of segments queued,
+// including the running one.
+//----------------------------------------------------------------------
+uint8_t move_getQueuedMotion() {
+	return m_motionCount;
+}
+
+//----------------------------------------------------------------------
+// move_runSegment() -- advances the segment at the head of the queue,
+// true once it is done
+//----------------------------------------------------------------------
+static bool move_runSegment(MoveSegment *seg, unsigned long now) {
+	if (!m_motionStarted) {
+		m_motionStarted = true;
+		m_motionStart = now;
+		if (seg->startLeft != MOVE_KEEP)
+			move_setSpeed(&m_leftPins, &m_currentLeft, seg->startLeft);
+		if (seg->startRight != MOVE_KEEP)
+			move_setSpeed(&m_rightPins, &m_currentRight, seg->startRight);
+		m_motionFromLeft = m_currentLeft;
+		m_motionFromRight = m_currentRight;
+		
+		if (seg->type != MOVE_SWEEP) {
+			move_aimLeft(seg->left);
+			move_aimRight(seg->right);
 		}
 	}
-	/*else {
-		m_smoothCounterLeft = 0;
-	}*/
 
-	if (m_targetRight != m_currentRight) {
-		if (m_targetRight > m_currentRight) {
-			m_currentRight++;
-		}
-		else {
-			m_currentRight--;
-		}
-		//move_smoothTurnRate(&m_currentRight, m_targetRight, &m_smoothCounterRight);
-		rightMotor->setSpeed(abs(m_currentRight));
+	unsigned long elapsed = (now - m_motionStart) / 1000; // ms
+	switch (seg->type) {
+		case MOVE_RAMP:
+			return m_currentLeft == seg->left && m_currentRight == seg->right;
 
-		// set dir of right motor
-		if (m_currentRight == 1) {
-			rightMotor->run(FORWARD);
-		}
-		else if (m_currentRight == -1) {
-			rightMotor->run(BACKWARD);
-		}
-		else if (m_currentRight == 0) {
-			rightMotor->run(RELEASE);
-		}
+		case MOVE_HOLD:
+			return elapsed >= seg->ms;
+
+		case MOVE_SWEEP:
+			if (elapsed >= seg->ms) {
+				move_setSpeed(&m_leftPins, &m_currentLeft, seg->left);
+				move_setSpeed(&m_rightPins, &m_currentRight, seg->right);
+			}
+			else {
+				move_setSpeed(&m_leftPins, &m_currentLeft, 
+							  m_motionFromLeft + (long)(seg->left - m_motionFromLeft) * (long)elapsed / (long)seg->ms);
+				move_setSpeed(&m_rightPins, &m_currentRight, 
+							  m_motionFromRight + (long)(seg->right - m_motionFromRight) * (long)elapsed / (long)seg->ms);
+			}
+			
+			// hold the speeds reached so the ramps stay idle
+			m_targetLeft = m_currentLeft;
+			m_targetRight = m_currentRight;
+			return elapsed >= seg->ms;
 	}
-	/*else {
-		m_smoothCounterRight = 0;
-	}*/
-	
-	//Serial.println("TargetR: " + String(targetRight) + " CurrentR: " + String(m_currentRight) +
-				// " TargetL: " + String(targetLeft) + " CurrentL: " + String(m_currentLeft));
-	//delay(1000);
+	return true;
 }
 
 //----------------------------------------------------------------------
-// move_moveForward() -- slow start move forward. Manual does not rely 
-// on move_updateMotors.
+// move_updateMotors() -- run the motion queue, then ramp the motor speeds
+// by the time since the last update, so acceleration does not depend on
+// the loop frequency. Changed channels are written once at the end.
 //----------------------------------------------------------------------
-void move_moveForward(bool manual) {
-	rightMotor->run(FORWARD);
-	leftMotor->run(FORWARD);
-	
-	m_targetRight = SPEED_NORMAL;
-	m_targetLeft = SPEED_NORMAL;
-	m_currentRight = 20;
-	m_currentLeft = 20;
-	
-	if (manual) {
-		// accelerate (forward)
-		for (uint8_t i = 20; i < SPEED_NORMAL; i++) { 
-			leftMotor->setSpeed(i); 
-			rightMotor->setSpeed(i);
-			delay(DELAY_VAL);
-		}
-		
-		m_currentRight = SPEED_NORMAL;
-		m_currentLeft = SPEED_NORMAL;
+void move_updateMotors() {
+	unsigned long now = micros();
+	unsigned long dt = now - m_lastUpdate;
+	m_lastUpdate = now;
+
+	// after a blocking call or a pause, restart the ramps instead of jumping
+	if (dt > RAMP_MAX_DT) {
+		dt = RAMP_MAX_DT;
+		m_rampLeft.start = now;
+		m_rampRight.start = now;
+	}
+
+	// completed segments start the next one in the same update
+	while (m_motionCount > 0 && move_runSegment(&m_motion[m_motionHead], now)) {
+		MoveCallback done = m_motion[m_motionHead].done;
+		m_motionHead = (m_motionHead + 1) % MOVE_QUEUE_SIZE;
+		m_motionCount--;
+		m_motionStarted = false;
+		if (done != NULL)
+			done();
 	}
+
+	move_rampMotor(&m_leftPins, &m_currentLeft, m_targetLeft, &m_rampLeft, now, dt);
+	move_rampMotor(&m_rightPins, &m_currentRight, m_targetRight, &m_rampRight, now, dt);
+	move_flushMotors();
 }
 
 //----------------------------------------------------------------------
-// move_moveReverse() - slow start move backwards. Manual does not rely 
-// on move_updateMotors.
+// move_moveForward() -- slow start move forward. Manual sweeps up at 
+// DELAY_VAL ms per step instead of the ramp rate. Queued behind any
+// running segment.
+//----------------------------------------------------------------------
+void move_moveForward(bool manual) {
+	unsigned long ms = manual ? (SPEED_NORMAL - 20) * (unsigned long)DELAY_VAL : 0;
+	move_queueSegment(manual ? MOVE_SWEEP : MOVE_RAMP, 20, 20, SPEED_NORMAL, SPEED_NORMAL, ms, NULL);
+}
+
+//----------------------------------------------------------------------
+// move_moveReverse() - slow start move backwards. Manual sweeps up at 
+// DELAY_VAL ms per step instead of the ramp rate. Queued behind any
+// running segment.
 //----------------------------------------------------------------------
 void move_moveReverse(bool manual) {
-	rightMotor->run(BACKWARD);
-	leftMotor->run(BACKWARD);
-	
-	m_targetRight = - SPEED_NORMAL;
-	m_targetLeft = - SPEED_NORMAL;
-	m_currentRight = -20;
-	m_currentLeft = -20;
-	
-	if (manual) {
-		// accelerate (backwards)
-		for (uint8_t i = 20; i < SPEED_NORMAL; i++) { 
-			leftMotor->setSpeed(i);
-			rightMotor->setSpeed(i);  
-			delay(DELAY_VAL);
-		}
-		
-		m_currentRight = - SPEED_NORMAL;
-		m_currentLeft = - SPEED_NORMAL;
-	}
+	unsigned long ms = manual ? (SPEED_NORMAL - 20) * (unsigned long)DELAY_VAL : 0;
+	move_queueSegment(manual ? MOVE_SWEEP : MOVE_RAMP, -20, -20, - SPEED_NORMAL, - SPEED_NORMAL, ms, NULL);
 }
 
 //----------------------------------------------------------------------
-// move_fullStop() -- sets the motor speed to 0
+// move_fullStop() -- sets the motor speed to 0 and clears the motion queue
 //----------------------------------------------------------------------
 void move_fullStop() {
-	rightMotor->setSpeed(SPEED_STOP);
-	leftMotor->setSpeed(SPEED_STOP);
-	rightMotor->run(RELEASE);
-	leftMotor->run(RELEASE);
+	move_clearMotion();
+	move_setSpeed(&m_rightPins, &m_currentRight, SPEED_STOP);
+	move_setSpeed(&m_leftPins, &m_currentLeft, SPEED_STOP);
+	move_flushMotors(); // now, an E-stop does not wait for the next update
 	
-	m_currentRight = 0;
-	m_currentLeft = 0;
 	m_targetRight = 0;
 	m_targetLeft = 0;
 }
 
 //----------------------------------------------------------------------
-// move_rotateLeft90() -- rotates the rover approx (90 degrees) to left
+// move_rotateLeft90() -- rotates the rover approx (90 degrees) to left.
+// Queues a sweep down from TURN_RATE, move_updateMotors runs it.
 //----------------------------------------------------------------------
 void move_rotateLeft90() {
-	rightMotor->run(FORWARD);
-	leftMotor->run(BACKWARD);
-
-	uint8_t right = TURN_RATE;
-	uint8_t left = TURN_RATE;
-	for (uint8_t i = 1; i <= TURN_RATE; i++) {
-		rightMotor->setSpeed(right--); 
-		leftMotor->setSpeed(left--);
-		delay(DELAY_VAL);
-	}
-	
-	rightMotor->setSpeed(SPEED_STOP);
-	leftMotor->setSpeed(SPEED_STOP); 
-	rightMotor->run(RELEASE);
-	leftMotor->run(RELEASE);
+	move_queueSweep(- TURN_RATE, TURN_RATE, SPEED_STOP, SPEED_STOP, TURN_RATE * (unsigned long)DELAY_VAL, NULL);
 }
 
 //----------------------------------------------------------------------
-// move_rotateRight90() -- rotates the rover approx (90 degrees) to right
+// move_rotateRight90() -- rotates the rover approx (90 degrees) to right.
+// Queues a sweep down from TURN_RATE, move_updateMotors runs it.
 //----------------------------------------------------------------------
 void move_rotateRight90() {
-	rightMotor->run(BACKWARD);
-	leftMotor->run(FORWARD);
-
-	uint8_t right = TURN_RATE;
-	uint8_t left = TURN_RATE;
-	for (uint8_t i = 1; i <= TURN_RATE; i++) {
-		rightMotor->setSpeed(right--);
-		leftMotor->setSpeed(left--); 
-		delay(DELAY_VAL);
-	}
-	
-	rightMotor->setSpeed(SPEED_STOP);
-	leftMotor->setSpeed(SPEED_STOP); 
-	rightMotor->run(RELEASE);
-	leftMotor->run(RELEASE);
+	move_queueSweep(TURN_RATE, - TURN_RATE, SPEED_STOP, SPEED_STOP, TURN_RATE * (unsigned long)DELAY_VAL, NULL);
 }
 
 //----------------------------------------------------------------------
@@ -10,6 +10,7 @@
 
 #include <Adafruit_MotorShield.h>
 #include <Arduino.h>
+#include <Wire.h>
 
 //------------------------------ Definitions ---------------------------
 #define SPEED_MAX 255
@@ -17,7 +18,51 @@
 #define SPEED_NORMAL 50		// target speed for forward/reverse methods
 #define TURN_RATE 35		// turn rate for rotation methods
 #define DELAY_VAL 50
-// #define ALPHA 8 // The smoothing factor for the cubic function
+#define RAMP_ACCEL 200		// default speed steps per second away from stop
+#define RAMP_DECEL 200		// default speed steps per second towards stop
+#define RAMP_MAX_DT 50000	// us, a longer gap between updates restarts the ramps
+#define RAMP_SCURVE_US 80000 // us for the S-curve to reach the full rate
+#define RAMP_SCURVE_MIN 16	// lowest S-curve rate, in 256ths of the full rate
+
+// Motor shield I2C, motors are written through a shadow of their channels
+#define SHIELD_ADDR 0x60	// default address of the shield's PCA9685
+#define SHIELD_LED0_ON_L 0x06	// PCA9685 register of channel 0, 4 per channel
+#define SHIELD_FIRST 2		// lowest PCA9685 channel of both motors
+#define SHIELD_CHANNELS 6	// M3 PWM, IN2, IN1 then M4 IN1, IN2, PWM
+#define I2C_STANDARD 100000
+#define I2C_FAST 400000		// fast mode, the PCA9685 and the LSM303 support it
+
+// PCA9685 channels of one motor
+struct MoveChannels {
+	uint8_t pwm, in1, in2;
+};
+
+// Ramp limits and state of one motor
+struct MoveRamp {
+	unsigned int accel;		// speed steps per second away from stop
+	unsigned int decel;		// speed steps per second towards stop
+	unsigned long frac;		// part of a step owed, in steps * 1000000
+	unsigned long start;	// micros() the ramp began, for the S-curve
+};
+
+// Motion scheduler
+#define MOVE_QUEUE_SIZE 4	// segments waiting or running
+#define MOVE_KEEP 0x7FFF	// start speed of a segment that keeps the current one
+#define MOVE_RAMP 0			// ramp to the speeds at the ramp rates, done once reached
+#define MOVE_HOLD 1			// ramp to the speeds, done after ms
+#define MOVE_SWEEP 2		// linear from the start to the end speeds over ms
+
+// Called when a segment completes, may queue more segments
+typedef void (*MoveCallback)();
+
+// One timed motion segment
+struct MoveSegment {
+	uint8_t type;
+	int startLeft, startRight;	// speeds jumped to when the segment starts, or MOVE_KEEP
+	int left, right;			// speeds at the end
+	unsigned long ms;			// duration of MOVE_HOLD and MOVE_SWEEP
+	MoveCallback done;			// NULL for none
+};
 
 //------------------------------ Class Functions -----------------------
 //----------------------------------------------------------------------
@@ -25,13 +70,43 @@
 //----------------------------------------------------------------------
 void move_setupMotors();
 
+//----------------------------------------------------------------------
+// move_setI2CClock() -- set the I2C bus clock, I2C_STANDARD or I2C_FAST.
+// Call after every begin() on the bus, Wire.begin() resets it.
+//----------------------------------------------------------------------
+void move_setI2CClock(uint32_t clock);
+
+//----------------------------------------------------------------------
+// move_setRamp() -- set the accel/decel limits of both motors in speed
+// steps per second
+//----------------------------------------------------------------------
+void move_setRamp(unsigned int accel, unsigned int decel);
+
+//----------------------------------------------------------------------
+// move_setRampLeft() -- set the accel/decel limits of the left motor
+//----------------------------------------------------------------------
+void move_setRampLeft(unsigned int accel, unsigned int decel);
+
+//----------------------------------------------------------------------
+// move_setRampRight() -- set the accel/decel limits of the right motor
+//----------------------------------------------------------------------
+void move_setRampRight(unsigned int accel, unsigned int decel);
+
+//----------------------------------------------------------------------
+// move_setSCurve() -- ease into each ramp on the cubic of 
+// move_smoothTurnRate instead of starting at the full rate
+//----------------------------------------------------------------------
+void move_setSCurve(bool enable);
+
 //----------------------------------------------------------------------
 // move_smoothTurnRate() -- smooths the turn rate based on a cubic function
+// of the time since the ramp began. Returns 256ths of the full rate.
 //----------------------------------------------------------------------
-//void move_smoothTurnRate(int *current, int target, int *smoothCounter);
+unsigned int move_smoothTurnRate(unsigned long elapsed);
 
 //----------------------------------------------------------------------
-// move_setTarget() -- set the motor speeds for both at same time
+// move_setTarget() -- set the motor speeds for both at same time. Setting
+// a target directly clears the motion queue.
 //----------------------------------------------------------------------
 void move_setTarget(int left, int right);
 
@@ -46,34 +121,72 @@ void move_setTargetLeft(int left);
 void move_setTargetRight(int right);
 
 //----------------------------------------------------------------------
-// move_updateMotors() -- update the motor speeds per iteration
+// move_updateMotors() -- run the motion queue, then ramp the motor speeds
+// by the time since the last update, so acceleration does not depend on
+// the loop frequency. Changed channels are written once at the end.
 //----------------------------------------------------------------------
 void move_updateMotors();
 
 //----------------------------------------------------------------------
-// move_moveForward() -- slow start move forward. Manual does not rely 
-// on move_updateMotors.
+// move_queueRamp() -- queue a ramp to the speeds at the ramp rates.
+// Returns false if the motion queue is full.
+//----------------------------------------------------------------------
+bool move_queueRamp(int left, int right, MoveCallback done);
+
+//----------------------------------------------------------------------
+// move_queueHold() -- queue a ramp to the speeds that completes after ms.
+// Returns false if the motion queue is full.
+//----------------------------------------------------------------------
+bool move_queueHold(int left, int right, unsigned long ms, MoveCallback done);
+
+//----------------------------------------------------------------------
+// move_queueSweep() -- queue a linear change of the speeds over ms, 
+// jumping to the start speeds first unless they are MOVE_KEEP. Returns 
+// false if the motion queue is full.
+//----------------------------------------------------------------------
+bool move_queueSweep(int startLeft, int startRight, int left, int right, 
+					 unsigned long ms, MoveCallback done);
+
+//----------------------------------------------------------------------
+// move_clearMotion() -- drop all queued segments without their callbacks
+// and leave the motors ramping to the current targets
+//----------------------------------------------------------------------
+void move_clearMotion();
+
+//----------------------------------------------------------------------
+// move_getQueuedMotion() -- Getter for the number of segments queued,
+// including the running one.
+//----------------------------------------------------------------------
+uint8_t move_getQueuedMotion();
+
+//----------------------------------------------------------------------
+// move_moveForward() -- slow start move forward. Manual sweeps up at 
+// DELAY_VAL ms per step instead of the ramp rate. Queued behind any
+// running segment.
 //----------------------------------------------------------------------
 void move_moveForward(bool manual);
 
 //----------------------------------------------------------------------
-// move_moveReverse() - slow start move backwards. Manual does not rely 
-// on move_updateMotors.
+// move_moveReverse() - slow start move backwards. Manual sweeps up at 
+// DELAY_VAL ms per step instead of the ramp rate. Queued behind any
+// running segment.
 //----------------------------------------------------------------------
 void move_moveReverse(bool manual);
 
 //----------------------------------------------------------------------
-// move_fullStop() -- sets the motor speed to 0
+// move_fullStop() -- sets the motor speed to 0 and clears the motion queue
 //----------------------------------------------------------------------
 void move_fullStop();
 
 //----------------------------------------------------------------------
-// move_rotateLeft90() -- rotates the rover approx (90 degrees) to left
+// move_rotateLeft90() -- rotates the rover approx (90 degrees) to left.
+// Queues a sweep down from TURN_RATE, move_updateMotors runs it.
 //----------------------------------------------------------------------
 void move_rotateLeft90();
 
 //----------------------------------------------------------------------
-// move_rotateRight90() -- rotates the rover approx (90 degrees) to right
+// move_rotateRight90() -- rotates the rover approx (90 degrees) to right.
+// Queues a sweep down from TURN_RATE, move_updateMotors runs it.
 //----------------------------------------------------------------------
 void move_rotateRight90();
 
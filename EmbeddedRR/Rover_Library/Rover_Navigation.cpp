@@ -0,0 +1,289 @@
+//------------------------ Rover_Navigation ----------------------------
+// Filename:      	Rover_Navigation.cpp
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Navigation replay for the following rover. Motor
+//					targets received from the leading rover are queued
+//					with the leader's timestamp and applied once the
+//					synced clock reaches that timestamp. The clock is
+//					synced at nav_start and then kept to the rate of
+//					the leader's clock with the drift from Rover_Clock.
+//					The targets wait in a fixed replay buffer of packed
+//					records, so buffering a long run before Start Follow
+//					cannot run the heap out.
+//----------------------------------------------------------------------
+#include "Rover_Navigation.h"
+
+//---------------------------- Initialization --------------------------
+uint32_t n_records[NAV_CAPACITY]; 		// replay buffer, packed records
+uint16_t n_head = 0; 					// slot of the oldest record
+uint16_t n_count = 0; 					// records held, fillers included
+uint16_t n_fillers = 0; 				// filler records held
+unsigned long n_headTime = 0; 			// timestamp of the oldest record
+long n_masterOffset = 0; 				// leader time - millis() at nav_start
+unsigned long n_startTime = 0; 			// millis() at nav_start
+unsigned long n_lastTimestamp = 0; 		// newest timestamp enqueued, 0 for none
+int n_lastLeft = 0; 					// powers enqueued with n_lastTimestamp
+int n_lastRight = 0;
+
+//------------------------------ Class Functions -----------------------
+//----------------------------------------------------------------------
+// nav_setupNavigation Initializes the navigation queue and clock offset.
+// Preconditions:   None.
+// Postconditions:  Navigation queue is empty and the offset is 0.
+//----------------------------------------------------------------------
+void nav_setupNavigation() {
+	nav_emptyQueue();
+	n_masterOffset = 0;
+	n_startTime = 0;
+}
+
+//----------------------------------------------------------------------
+// nav_pack ------- Packs a replay record.
+// Preconditions:   delta <= NAV_DELTA_MAX, the powers fit in 10 bits.
+// Postconditions:  Returns the record.
+//----------------------------------------------------------------------
+static uint32_t nav_pack(unsigned int delta, int leftPower, int rightPower) {
+	return ((uint32_t)delta << 20) | ((uint32_t)(leftPower & 0x3FF) << 10) | (rightPower & 0x3FF);
+}
+
+//----------------------------------------------------------------------
+// nav_unpackPower  Sign extends a 10 bit power of a replay record.
+// Preconditions:   None.
+// Postconditions:  Returns -512 to 511.
+//----------------------------------------------------------------------
+static int nav_unpackPower(uint32_t bits) {
+	int power = bits & 0x3FF;
+	if (power & 0x200)
+		power -= 0x400;
+	return power;
+}
+
+//----------------------------------------------------------------------
+// nav_isFiller --- Whether a replay record is a filler.
+// Preconditions:   None.
+// Postconditions:  Returns a bool.
+//----------------------------------------------------------------------
+static bool nav_isFiller(uint32_t record) {
+	return (record >> 20) == NAV_FILLER;
+}
+
+//----------------------------------------------------------------------
+// nav_unpackDelta  Ms from the record before a replay record.
+// Preconditions:   None.
+// Postconditions:  Returns the delta, or the span of a filler.
+//----------------------------------------------------------------------
+static unsigned long nav_unpackDelta(uint32_t record) {
+	return nav_isFiller(record) ? record & NAV_SPAN_MAX : record >> 20;
+}
+
+//----------------------------------------------------------------------
+// nav_unpackHead - Copies the oldest record.
+// Preconditions:   The buffer is not empty, packet points to valid memory.
+// Postconditions:  packet holds its timestamp and powers.
+//----------------------------------------------------------------------
+static void nav_unpackHead(NavigationPacket* packet) {
+	uint32_t record = n_records[n_head];
+	packet->timestamp = n_headTime;
+	packet->leftPower = nav_unpackPower(record >> 10);
+	packet->rightPower = nav_unpackPower(record);
+}
+
+//----------------------------------------------------------------------
+// nav_dequeue ---- Drops the oldest record and the filler records after
+//					it.
+// Preconditions:   The buffer is not empty.
+// Postconditions:  The oldest record left is not a filler and
+//					n_headTime is its timestamp.
+//----------------------------------------------------------------------
+static void nav_dequeue() {
+	n_head = (n_head + 1) & (NAV_CAPACITY - 1);
+	n_count--;
+	while (n_count > 0) {
+		uint32_t record = n_records[n_head];
+		n_headTime += nav_unpackDelta(record);
+		if (!nav_isFiller(record))
+			return;
+		n_head = (n_head + 1) & (NAV_CAPACITY - 1);
+		n_count--;
+		n_fillers--;
+	}
+}
+
+//----------------------------------------------------------------------
+// nav_enqueue ---- Queues motor targets to apply at a leader timestamp.
+// Preconditions:   leftPower and rightPower fit in 10 bits.
+// Postconditions:  A navigationPacket is enqueued, unless it is older
+//					than the last one or repeats its timestamp and
+//					powers (a retransmitted payload that did arrive the
+//					first time). Returns false if it was 
+//					dropped because the replay buffer is full.
+//----------------------------------------------------------------------
+bool nav_enqueue(unsigned long timestamp, int leftPower, int rightPower) {
+	if (n_lastTimestamp != 0 && (long)(timestamp - n_lastTimestamp) < 0)
+		return true; // replayed already or queued, the leader's timestamps only grow
+	if (n_lastTimestamp != 0 && timestamp == n_lastTimestamp && leftPower == n_lastLeft && rightPower == n_lastRight)
+		return true; // the newest packet of a retransmitted payload
+	
+	// fillers for a gap longer than a record can hold
+	unsigned long delta = n_count > 0 ? timestamp - n_lastTimestamp : 0;
+	unsigned long fillers = delta > NAV_DELTA_MAX ? (delta - NAV_DELTA_MAX + NAV_SPAN_MAX - 1) / NAV_SPAN_MAX : 0;
+	if (n_count + fillers + 1 > NAV_CAPACITY) // the fillers and the record itself
+		return false;
+	
+	for (; fillers > 0; fillers--) {
+		unsigned long span = min(delta, NAV_SPAN_MAX);
+		n_records[(n_head + n_count++) & (NAV_CAPACITY - 1)] = ((uint32_t)NAV_FILLER << 20) | span;
+		n_fillers++;
+		delta -= span;
+	}
+	n_records[(n_head + n_count++) & (NAV_CAPACITY - 1)] = nav_pack(delta, leftPower, rightPower);
+	if (n_count == 1)
+		n_headTime = timestamp;
+	n_lastTimestamp = timestamp;
+	n_lastLeft = leftPower;
+	n_lastRight = rightPower;
+	
+	#ifdef NAV_DEBUG_QUEUE
+		Serial.print("navQueue: ");
+		Serial.println(n_count);
+	#endif
+	return true;
+}
+
+//----------------------------------------------------------------------
+// nav_start ------ Dequeues the first navigationPacket and syncs the 
+//					clocks so that it is due now.
+// Preconditions:   packet points to valid memory.
+// Postconditions:  Returns false if the queue was empty. Otherwise the
+//					packet is dequeued into packet, the master offset and
+//					start time are updated and true is returned.
+//----------------------------------------------------------------------
+bool nav_start(NavigationPacket* packet) {
+	if (n_count == 0)
+		return false;
+	
+	nav_unpackHead(packet);
+	nav_dequeue();
+	n_startTime = millis();
+	n_masterOffset = packet->timestamp - n_startTime; // syncs the clocks
+	return true;
+}
+
+//----------------------------------------------------------------------
+// nav_getDue ----- Dequeues the next navigationPacket if it is due.
+// Preconditions:   packet points to valid memory. nav_start was called.
+// Postconditions:  Returns true and sets packet if the head of the queue
+//					is due now (or in the past). Otherwise the queue is 
+//					unchanged and false is returned.
+//----------------------------------------------------------------------
+bool nav_getDue(NavigationPacket* packet) {
+	if (n_count == 0)
+		return false;
+	
+	nav_unpackHead(packet);
+	if (nav_getLateness(packet) < 0) // is the next target still in the future?
+		return false;
+	
+	nav_dequeue(); // remove it from queue
+	return true;
+}
+
+//----------------------------------------------------------------------
+// nav_peek ------- Copies the head of the navigation queue.
+// Preconditions:   packet points to valid memory.
+// Postconditions:  Returns false if the queue is empty.
+//----------------------------------------------------------------------
+bool nav_peek(NavigationPacket* packet) {
+	if (n_count == 0)
+		return false;
+	
+	nav_unpackHead(packet);
+	return true;
+}
+
+//----------------------------------------------------------------------
+// nav_execute ---- Sets the motor targets and determines the direction
+//					based on the motor speeds.
+// Preconditions:   Motors are setup.
+// Postconditions:  Motor targets are set. Returns NAV_STOP, NAV_STRAIGHT,
+//					NAV_LEFT or NAV_RIGHT.
+//----------------------------------------------------------------------
+int nav_execute(int leftPower, int rightPower) {
+	move_setTarget(leftPower, rightPower);
+	
+	if (leftPower == rightPower) {
+		if (leftPower == 0)
+			return NAV_STOP;
+		return NAV_STRAIGHT;
+	}
+	else if (leftPower > rightPower) {
+		return NAV_RIGHT;
+	}
+	
+	return NAV_LEFT;
+}
+
+//----------------------------------------------------------------------
+// nav_getLateness  Getter for how late a navigationPacket is on the 
+//					synced clock.
+// Preconditions:   packet points to valid memory.
+// Postconditions:  Returns millis() + nav_getOffset() - timestamp.
+//					Positive values are late, negative values are not
+//					due yet.
+//----------------------------------------------------------------------
+long nav_getLateness(const NavigationPacket* packet) {
+	return millis() + nav_getOffset() - packet->timestamp;
+}
+
+//----------------------------------------------------------------------
+// nav_emptyQueue - Empties the navigation queue.
+// Preconditions:   None.
+// Postconditions:  Navigation queue is empty and any timestamp is
+//					accepted next.
+//----------------------------------------------------------------------
+void nav_emptyQueue() {
+	n_head = 0;
+	n_count = 0;
+	n_fillers = 0;
+	n_lastTimestamp = 0;
+}
+
+//----------------------------------------------------------------------
+// nav_isEmpty ---- Getter for whether the navigation queue is empty.
+// Preconditions:   None.
+// Postconditions:  Returns a bool.
+//----------------------------------------------------------------------
+bool nav_isEmpty() {
+	return n_count == 0;
+}
+
+//----------------------------------------------------------------------
+// nav_getQueuedPackets Getter for the targets in the replay buffer.
+// Preconditions:   None.
+// Postconditions:  Returns an int, filler records not included.
+//----------------------------------------------------------------------
+int nav_getQueuedPackets() {
+	return n_count - n_fillers;
+}
+
+//----------------------------------------------------------------------
+// nav_getCapacity  Getter for the size of the replay buffer.
+// Preconditions:   None.
+// Postconditions:  Returns NAV_CAPACITY records.
+//----------------------------------------------------------------------
+int nav_getCapacity() {
+	return NAV_CAPACITY;
+}
+
+//----------------------------------------------------------------------
+// nav_getOffset -- Getter for the offset from millis() to leader time.
+// Preconditions:   None.
+// Postconditions:  Returns the offset at nav_start plus how far the
+//					leader's clock drifted from millis() since.
+//----------------------------------------------------------------------
+long nav_getOffset() {
+	// offset jumps between samples cancel, the drift since the start stays
+	return n_masterOffset + clock_getOffset(millis()) - clock_getOffset(n_startTime);
+}
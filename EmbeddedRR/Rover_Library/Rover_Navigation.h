@@ -0,0 +1,156 @@
+//------------------------ Rover_Navigation ----------------------------
+// Filename:      	Rover_Navigation.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Navigation replay for the following rover. Motor
+//					targets received from the leading rover are queued
+//					with the leader's timestamp and applied once the
+//					synced clock reaches that timestamp. The clock is
+//					synced at nav_start and then kept to the rate of
+//					the leader's clock with the drift from Rover_Clock.
+//					The targets wait in a fixed replay buffer of packed
+//					records, so buffering a long run before Start Follow
+//					cannot run the heap out.
+//------------------------------ Includes ------------------------------
+#ifndef _Rover_Navigation_h_
+#define _Rover_Navigation_h_
+
+#include <Arduino.h>
+#include "Rover_Movement.h"
+#include "Rover_Clock.h"
+
+//---------------------------- Definitions -----------------------------
+// Directions returned by nav_execute (same values as the rover states)
+#define NAV_STOP 0
+#define NAV_STRAIGHT 1
+#define NAV_LEFT 2
+#define NAV_RIGHT 3
+
+// #define NAV_DEBUG_QUEUE
+
+// Replay buffer
+#define NAV_CAPACITY 256 			// records, a power of 2 (4 bytes each)
+#define NAV_DELTA_MAX 4094 			// ms from one record to the next (12 bits)
+#define NAV_FILLER 4095 			// delta of a filler record for a longer gap
+#define NAV_SPAN_MAX 0xFFFFFUL 		// ms a filler record bridges (20 bits)
+
+/* Replay record (4 bytes), the timestamp is kept as the ms since the
+ * record before it, the head's timestamp is held separately:
+ *   bits 31-20  delta (0 - NAV_DELTA_MAX)
+ *   bits 19-10  leftPower (10 bit two's complement like a roverPacket)
+ *   bits  9-0   rightPower
+ * A longer gap is bridged by filler records, a delta of NAV_FILLER and
+ * the ms they bridge in bits 19-0. Fillers are skipped and never handed
+ * out.
+ */
+
+// Navigation Packet, a record unpacked:
+struct NavigationPacket {
+	unsigned long timestamp = 0; // leader time the targets apply at
+	int leftPower = 0;
+	int rightPower = 0;
+};
+
+//------------------------------ Class Functions ------------------------
+//----------------------------------------------------------------------
+// nav_setupNavigation Initializes the navigation queue and clock offset.
+// Preconditions:   None.
+// Postconditions:  Navigation queue is empty and the offset is 0.
+//----------------------------------------------------------------------
+void nav_setupNavigation();
+
+//----------------------------------------------------------------------
+// nav_enqueue ---- Queues motor targets to apply at a leader timestamp.
+// Preconditions:   leftPower and rightPower fit in 10 bits.
+// Postconditions:  A navigationPacket is enqueued, unless it is older
+//					than the last one or repeats its timestamp and
+//					powers (a retransmitted payload that did arrive the
+//					first time). Returns false if it was 
+//					dropped because the replay buffer is full.
+//----------------------------------------------------------------------
+bool nav_enqueue(unsigned long timestamp, int leftPower, int rightPower);
+
+//----------------------------------------------------------------------
+// nav_start ------ Dequeues the first navigationPacket and syncs the 
+//					clocks so that it is due now.
+// Preconditions:   packet points to valid memory.
+// Postconditions:  Returns false if the queue was empty. Otherwise the
+//					packet is dequeued into packet, the master offset and
+//					start time are updated and true is returned.
+//----------------------------------------------------------------------
+bool nav_start(NavigationPacket* packet);
+
+//----------------------------------------------------------------------
+// nav_getDue ----- Dequeues the next navigationPacket if it is due.
+// Preconditions:   packet points to valid memory. nav_start was called.
+// Postconditions:  Returns true and sets packet if the head of the queue
+//					is due now (or in the past). Otherwise the queue is 
+//					unchanged and false is returned.
+//----------------------------------------------------------------------
+bool nav_getDue(NavigationPacket* packet);
+
+//----------------------------------------------------------------------
+// nav_peek ------- Copies the head of the navigation queue.
+// Preconditions:   packet points to valid memory.
+// Postconditions:  Returns false if the queue is empty.
+//----------------------------------------------------------------------
+bool nav_peek(NavigationPacket* packet);
+
+//----------------------------------------------------------------------
+// nav_execute ---- Sets the motor targets and determines the direction
+//					based on the motor speeds.
+// Preconditions:   Motors are setup.
+// Postconditions:  Motor targets are set. Returns NAV_STOP, NAV_STRAIGHT,
+//					NAV_LEFT or NAV_RIGHT.
+//----------------------------------------------------------------------
+int nav_execute(int leftPower, int rightPower);
+
+//----------------------------------------------------------------------
+// nav_getLateness  Getter for how late a navigationPacket is on the 
+//					synced clock.
+// Preconditions:   packet points to valid memory.
+// Postconditions:  Returns millis() + nav_getOffset() - timestamp.
+//					Positive values are late, negative values are not
+//					due yet.
+//----------------------------------------------------------------------
+long nav_getLateness(const NavigationPacket* packet);
+
+//----------------------------------------------------------------------
+// nav_emptyQueue - Empties the navigation queue.
+// Preconditions:   None.
+// Postconditions:  Navigation queue is empty and any timestamp is
+//					accepted next.
+//----------------------------------------------------------------------
+void nav_emptyQueue();
+
+//----------------------------------------------------------------------
+// nav_isEmpty ---- Getter for whether the navigation queue is empty.
+// Preconditions:   None.
+// Postconditions:  Returns a bool.
+//----------------------------------------------------------------------
+bool nav_isEmpty();
+
+//----------------------------------------------------------------------
+// nav_getQueuedPackets Getter for the targets in the replay buffer.
+// Preconditions:   None.
+// Postconditions:  Returns an int, filler records not included.
+//----------------------------------------------------------------------
+int nav_getQueuedPackets();
+
+//----------------------------------------------------------------------
+// nav_getCapacity  Getter for the size of the replay buffer.
+// Preconditions:   None.
+// Postconditions:  Returns NAV_CAPACITY records.
+//----------------------------------------------------------------------
+int nav_getCapacity();
+
+//----------------------------------------------------------------------
+// nav_getOffset -- Getter for the offset from millis() to leader time.
+// Preconditions:   None.
+// Postconditions:  Returns the offset at nav_start plus how far the
+//					leader's clock drifted from millis() since.
+//----------------------------------------------------------------------
+long nav_getOffset();
+
+#endif
@@ -0,0 +1,163 @@
+//-------------------------- Rover_Profiler ----------------------------
+// Filename:      	Rover_Profiler.cpp
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Loop time profiler. Empty unless PROF_ENABLE is
+//					defined in Rover_Profiler.h.
+//------------------------------ Includes ------------------------------
+#include "Rover_Profiler.h"
+
+#ifdef PROF_ENABLE
+#include "Rover_Communication.h"
+
+//------------------------------ Globals -------------------------------
+ProfSection p_sections[PROF_SECTIONS];
+
+//----------------------------------------------------------------------
+// bitLength ------ Number of bits needed to hold a value.
+// Preconditions:   None.
+// Postconditions:  Returns 0 for 0, otherwise floor(log2(value)) + 1.
+//----------------------------------------------------------------------
+static uint8_t bitLength(unsigned long value) {
+	uint8_t bits = 0;
+	while (value != 0) {
+		value >>= 1;
+		bits++;
+	}
+	return bits;
+}
+
+//----------------------------------------------------------------------
+// prof_record ---- Adds one duration to a section.
+// Preconditions:   name is a string literal.
+// Postconditions:  The slot of section id is updated, ids outside
+//					0 - PROF_SECTIONS-1 are ignored.
+//----------------------------------------------------------------------
+void prof_record(uint8_t id, const char* name, unsigned long duration) {
+	if (id >= PROF_SECTIONS)
+		return;
+	
+	ProfSection* section = &p_sections[id];
+	section->name = name;
+	if (section->count == 0 || duration < section->min)
+		section->min = duration;
+	if (duration > section->max)
+		section->max = duration;
+	section->count++;
+	section->sum += duration;
+	
+	uint8_t bucket = min(bitLength(duration), (uint8_t)(PROF_BUCKETS - 1));
+	if (section->hist[bucket] != 0xFFFF)
+		section->hist[bucket]++;
+}
+
+//----------------------------------------------------------------------
+// prof_getSection  Getter for the slot of a section.
+// Preconditions:   None.
+// Postconditions:  Returns NULL for an id out of range.
+//----------------------------------------------------------------------
+const ProfSection* prof_getSection(uint8_t id) {
+	return id < PROF_SECTIONS ? &p_sections[id] : NULL;
+}
+
+//----------------------------------------------------------------------
+// prof_printProfile Prints every section that has samples.
+// Preconditions:   out is ready to print.
+// Postconditions:  One line per section with the histogram counts.
+//----------------------------------------------------------------------
+void prof_printProfile(Print &out) {
+	for (uint8_t i = 0; i < PROF_SECTIONS; i++) {
+		const ProfSection* section = &p_sections[i];
+		if (section->count == 0)
+			continue;
+		
+		out.print(section->name);
+		out.print(" n: ");
+		out.print(section->count);
+		out.print(" min: ");
+		out.print(section->min);
+		out.print(" mean: ");
+		out.print(section->sum / section->count);
+		out.print(" max: ");
+		out.print(section->max);
+		out.print(" us hist:");
+		for (uint8_t b = 0; b < PROF_BUCKETS; b++) {
+			out.print(" ");
+			out.print(section->hist[b]);
+		}
+		out.println();
+	}
+}
+
+//----------------------------------------------------------------------
+// prof_sendProfile64 Sends every section that has samples to the master
+//					as Profile Data packets with an optional ack.
+// Preconditions:   xbee object is configured.
+// Postconditions:  The master payload is sent per com_sendMaster64. Int
+//					code returned is the sum of ack status code(s).
+//----------------------------------------------------------------------
+int prof_sendProfile64(bool checkAck) {
+	int retVal = 0;
+	bool pending = false;
+	
+	for (uint8_t i = 0; i < PROF_SECTIONS; i++) {
+		const ProfSection* section = &p_sections[i];
+		if (section->count == 0)
+			continue;
+		
+		// keep the header and values of a section in one frame
+		if (com_getMasterSlotsLeft() < 2) {
+			retVal += com_sendMaster64(checkAck);
+			pending = false;
+		}
+		
+		com_encodeMasterPacket(0x9, -1 - i, min(section->count, 511UL));
+		com_encodeMasterPacket(0x9, prof_pack(section->sum / section->count), prof_pack(section->max));
+		pending = true;
+	}
+	
+	if (pending)
+		retVal += com_sendMaster64(checkAck);
+	return retVal;
+}
+
+//----------------------------------------------------------------------
+// prof_resetProfile Empties every section.
+// Preconditions:   None.
+// Postconditions:  All slots are back to no samples.
+//----------------------------------------------------------------------
+void prof_resetProfile() {
+	for (uint8_t i = 0; i < PROF_SECTIONS; i++)
+		p_sections[i] = ProfSection();
+}
+
+//----------------------------------------------------------------------
+// prof_pack ------ Packs a duration into 9 bits: below 2^PROF_PACK_BITS
+//					exact, above with PROF_PACK_BITS significant bits.
+// Preconditions:   None.
+// Postconditions:  Returns 0 - 511, saturating at about 1 s.
+//----------------------------------------------------------------------
+int prof_pack(unsigned long duration) {
+	uint8_t bits = bitLength(duration);
+	if (bits <= PROF_PACK_BITS)
+		return duration;
+	
+	uint8_t shift = bits - PROF_PACK_BITS;
+	if (shift > 15)
+		return 511;
+	return (shift << PROF_PACK_BITS) | (duration >> shift);
+}
+
+//----------------------------------------------------------------------
+// prof_unpack ---- Reverses prof_pack.
+// Preconditions:   0 <= code <= 511.
+// Postconditions:  Returns the lowest duration packed to code.
+//----------------------------------------------------------------------
+unsigned long prof_unpack(int code) {
+	uint8_t shift = code >> PROF_PACK_BITS;
+	unsigned long mantissa = code & ((1 << PROF_PACK_BITS) - 1);
+	return mantissa << shift;
+}
+
+#endif
@@ -0,0 +1,140 @@
+//-------------------------- Rover_Profiler ----------------------------
+// Filename:      	Rover_Profiler.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Loop time profiler. Sections of code are timed with
+//					micros() into fixed slots holding the count, min,
+//					max, mean and a log2 histogram of the durations. The
+//					slots can be printed to a serial port or sent to the
+//					master as 0x9 Profile Data packets. Everything is
+//					compiled out unless PROF_ENABLE is defined, every
+//					macro then expands to nothing.
+//					Usage:
+//						PROF_BEGIN(PROF_SENSORS);
+//						sensor_getSensorVals(curSensorVals);
+//						PROF_END(PROF_SENSORS, "sensors");
+//					or PROF_SCOPE(PROF_LOOP, "loop"); to time until the
+//					end of the enclosing block. micros() costs about
+//					4 us on an AVR, which is included in every sample.
+//------------------------------ Includes ------------------------------
+#ifndef _Rover_Profiler_h_
+#define _Rover_Profiler_h_
+
+#include <Arduino.h>
+
+//---------------------------- Definitions -----------------------------
+// Configuration
+// #define PROF_ENABLE 	// compile the profiler in
+#define PROF_SECTIONS 8 // slots for timed sections
+#define PROF_BUCKETS 16 // log2 histogram buckets, the last is open ended
+
+// Sections timed by the sketches, 4 - 7 are free
+#define PROF_LOOP 0 	// all of loop()
+#define PROF_SENSORS 1 	// sensor_update
+#define PROF_STATE 2 	// updateState
+#define PROF_MOTORS 3 	// move_updateMotors
+
+/* Profile Data (0x9) packets, one pair per section:
+ *	header: lData = -1 - section, rData = samples (saturates at 511)
+ *	values: lData = mean,         rData = max (prof_pack codes)
+ * A pair never spans two frames.
+ */
+#define PROF_PACK_BITS 5 // mantissa bits of a packed duration
+
+// Durations of one section
+struct ProfSection {
+	const char* name = 0;
+	unsigned long count = 0;
+	unsigned long sum = 0; // microseconds
+	unsigned long min = 0;
+	unsigned long max = 0;
+	unsigned int hist[PROF_BUCKETS] = {}; // [2^(i-1), 2^i) us in slot i, saturating
+};
+
+//------------------------------ Macros --------------------------------
+#ifdef PROF_ENABLE
+	#define PROF_BEGIN(id) unsigned long prof_start_##id = micros()
+	#define PROF_END(id, name) prof_record((id), (name), micros() - prof_start_##id)
+	#define PROF_SCOPE(id, name) ProfScope prof_scope_##id((id), (name))
+	#define PROF_PRINT(out) prof_printProfile(out)
+	#define PROF_SEND(checkAck) prof_sendProfile64(checkAck)
+	#define PROF_RESET() prof_resetProfile()
+#else
+	#define PROF_BEGIN(id)
+	#define PROF_END(id, name)
+	#define PROF_SCOPE(id, name)
+	#define PROF_PRINT(out)
+	#define PROF_SEND(checkAck)
+	#define PROF_RESET()
+#endif
+
+#ifdef PROF_ENABLE
+//------------------------------ Class Functions ------------------------
+//----------------------------------------------------------------------
+// prof_record ---- Adds one duration to a section.
+// Preconditions:   name is a string literal.
+// Postconditions:  The slot of section id is updated, ids outside
+//					0 - PROF_SECTIONS-1 are ignored.
+//----------------------------------------------------------------------
+void prof_record(uint8_t id, const char* name, unsigned long duration);
+
+//----------------------------------------------------------------------
+// prof_getSection  Getter for the slot of a section.
+// Preconditions:   None.
+// Postconditions:  Returns NULL for an id out of range.
+//----------------------------------------------------------------------
+const ProfSection* prof_getSection(uint8_t id);
+
+//----------------------------------------------------------------------
+// prof_printProfile Prints every section that has samples.
+// Preconditions:   out is ready to print.
+// Postconditions:  One line per section with the histogram counts.
+//----------------------------------------------------------------------
+void prof_printProfile(Print &out);
+
+//----------------------------------------------------------------------
+// prof_sendProfile64 Sends every section that has samples to the master
+//					as Profile Data packets with an optional ack.
+// Preconditions:   xbee object is configured.
+// Postconditions:  The master payload is sent per com_sendMaster64. Int
+//					code returned is the sum of ack status code(s).
+//----------------------------------------------------------------------
+int prof_sendProfile64(bool checkAck);
+
+//----------------------------------------------------------------------
+// prof_resetProfile Empties every section.
+// Preconditions:   None.
+// Postconditions:  All slots are back to no samples.
+//----------------------------------------------------------------------
+void prof_resetProfile();
+
+//----------------------------------------------------------------------
+// prof_pack ------ Packs a duration into 9 bits: below 2^PROF_PACK_BITS
+//					exact, above with PROF_PACK_BITS significant bits.
+// Preconditions:   None.
+// Postconditions:  Returns 0 - 511, saturating at about 1 s.
+//----------------------------------------------------------------------
+int prof_pack(unsigned long duration);
+
+//----------------------------------------------------------------------
+// prof_unpack ---- Reverses prof_pack.
+// Preconditions:   0 <= code <= 511.
+// Postconditions:  Returns the lowest duration packed to code.
+//----------------------------------------------------------------------
+unsigned long prof_unpack(int code);
+
+// Times a section until the end of the enclosing block
+class ProfScope {
+public:
+	ProfScope(uint8_t id, const char* name) : _id(id), _name(name), _start(micros()) {}
+	~ProfScope() { prof_record(_id, _name, micros() - _start); }
+
+private:
+	uint8_t _id;
+	const char* _name;
+	unsigned long _start;
+};
+#endif
+
+#endif
@@ -12,11 +12,73 @@
 //----------------------------------------------------------------------
 #include "Rover_Sensors.h"
 
+// IR pins in the order of the sensor values
+const uint8_t s_irPins[IR_COUNT] = { IR_LL, IR_L, IR_R, IR_RR };
+
+// Background IR sampling, written by the PCINT0 handler
+volatile uint8_t s_irPending = 0;				  // pins that have not fallen yet
+volatile unsigned long s_irStart = 0;			  // micros() when they were charged
+volatile unsigned int s_irFall[IR_COUNT];		  // us from the start to each fall
+
+// Background IR sampling, loop only
+uint8_t s_irPort = NOT_A_PORT;	  // port of the pins, NOT_A_PORT to sweep instead
+uint8_t s_irMasks[IR_COUNT];	  // bit of each pin in the port
+uint8_t s_irAll = 0;			  // bits of all pins
+bool s_irRunning = false;		  // between start and stop
+bool s_irIdle = false;			  // a set was published, waiting for the period
+unsigned long s_irPeriod = 0;	  // us from the start of a set to the next
+int s_irSample[IR_COUNT];		  // latest completed set
+unsigned long s_irSeq = 0;		  // sets completed
+
+// Sensor scheduler
+SensorCache s_cache[SENSOR_SOURCES];
+bool s_scheduled[SENSOR_SOURCES] = {};
+unsigned long s_periods[SENSOR_SOURCES] = {}; // ms
+unsigned long s_due[SENSOR_SOURCES] = {};	  // millis() of the next I2C sample
+
+// LSB per gauss of the magnetometer gains (CRB_REG_M bits 7:5), XY and Z
+const unsigned int s_magLsbXY[8] = { 1100, 1100, 855, 670, 450, 400, 330, 230 };
+const unsigned int s_magLsbZ[8] = { 980, 980, 760, 600, 400, 355, 295, 205 };
+
 // I2C Configuration
 /* Assign a unique ID to this sensor at the same time */
 Adafruit_LSM303_Mag_Unified s_mag = Adafruit_LSM303_Mag_Unified(12345);
 Adafruit_LSM303_Accel_Unified s_accel = Adafruit_LSM303_Accel_Unified(54321);
 
+//-----------------------------------------------------------------------
+// sensor_readRegisters() -- burst read of consecutive LSM303 registers,
+// true if all len bytes arrived
+//-----------------------------------------------------------------------
+static bool sensor_readRegisters(uint8_t address, uint8_t reg, uint8_t *buf, uint8_t len) {
+	Wire.beginTransmission(address);
+	Wire.write(reg);
+	if (Wire.endTransmission() != 0)
+		return false;
+	if (Wire.requestFrom(address, len) != len)
+		return false;
+	for (uint8_t i = 0; i < len; i++)
+		buf[i] = Wire.read();
+	return true;
+}
+
+//-----------------------------------------------------------------------
+// sensor_writeRegister() -- write one LSM303 register
+//-----------------------------------------------------------------------
+static bool sensor_writeRegister(uint8_t address, uint8_t reg, uint8_t value) {
+	Wire.beginTransmission(address);
+	Wire.write(reg);
+	Wire.write(value);
+	return Wire.endTransmission() == 0;
+}
+
+//-----------------------------------------------------------------------
+// sensor_accelMg() -- mg of the little endian, left justified 12 bit
+// accelerometer sample at buf (1 mg per LSB at +-2 g)
+//-----------------------------------------------------------------------
+static int sensor_accelMg(const uint8_t *buf) {
+	return (int16_t)(buf[0] | (buf[1] << 8)) >> 4;
+}
+
 //-----------------------------------------------------------------------
 // sensor_setup() -- Initializaion of I2C Sensor
 //-----------------------------------------------------------------------
@@ -26,18 +88,64 @@ void sensor_setup() {
 
 	if(!s_accel.begin()) {
 	/* There was a problem detecting the ADXL345 ... check your connections */
-		#ifdef SENSOR_PRINT
-			Serial.println("Accel: No LSM303 detected on this device");
-		#endif
+		TRACE(TRACE_NO_SENSOR, 0, 0);
 	}
 	if(!s_mag.begin()) {
 	/* There was a problem detecting the ADXL345 ... check your connections */
-		#ifdef SENSOR_PRINT
-			Serial.println("Mag: No LSM303 detected on this device");
-		#endif
+		TRACE(TRACE_NO_SENSOR, 1, 0);
 	}
 }
 
+//-----------------------------------------------------------------------
+// sensor_chargeIr() -- charge the IR pins (all) of a port, then release
+// them to inputs without pull-ups (DDR first, clearing PORT first would
+// discharge them). Returns micros() from before the charge.
+//-----------------------------------------------------------------------
+static unsigned long sensor_chargeIr(uint8_t port, uint8_t all) {
+	unsigned long time = micros();
+	*portOutputRegister(port) |= all;
+	*portModeRegister(port) |= all;
+	delayMicroseconds(IR_CHARGE_US);
+	*portModeRegister(port) &= ~all;
+	*portOutputRegister(port) &= ~all;
+	return time;
+}
+
+//-----------------------------------------------------------------------
+// sensor_startIrSample() -- charge the IR pins and arm the handler
+//-----------------------------------------------------------------------
+static void sensor_startIrSample() {
+	// interrupts stay off until the handler is armed, or a fast fall
+	// right after the release would be missed
+	noInterrupts();
+	s_irStart = sensor_chargeIr(s_irPort, s_irAll);
+	s_irPending = s_irAll;
+	interrupts();
+	s_irIdle = false;
+}
+
+//-----------------------------------------------------------------------
+// ISR(PCINT0_vect) -- timestamp the IR pins that fell since the last
+// change. Charging edges find nothing pending and are ignored.
+//-----------------------------------------------------------------------
+#if defined(SENSOR_IR_PCINT) && defined(PCINT0_vect)
+ISR(PCINT0_vect) {
+	uint8_t pending = s_irPending;
+	if (pending == 0)
+		return;
+	
+	uint8_t fell = pending & ~*portInputRegister(s_irPort);
+	if (fell == 0)
+		return;
+	unsigned int diff = micros() - s_irStart;
+	for (uint8_t i = 0; i < IR_COUNT; i++) {
+		if (fell & s_irMasks[i])
+			s_irFall[i] = diff;
+	}
+	s_irPending = pending & ~fell;
+}
+#endif
+
 //-----------------------------------------------------------------------
 // sensor_readSensorAt(int pin) -- read IR data from the pin
 //-----------------------------------------------------------------------
@@ -45,12 +153,12 @@ int sensor_readSensorAt(int QRE1113_Pin) {
 	long time = micros();
 	pinMode(QRE1113_Pin, OUTPUT);
 	digitalWrite(QRE1113_Pin, HIGH);  
-	delayMicroseconds(10);
+	delayMicroseconds(IR_CHARGE_US);
 	pinMode(QRE1113_Pin, INPUT);
 
 	// time how long the input is HIGH, 
 	// but quit after 3ms as nothing happens after that
-	while ((digitalRead(QRE1113_Pin) == HIGH) && ((micros() - time) < 3000)); 
+	while ((digitalRead(QRE1113_Pin) == HIGH) && ((micros() - time) < IR_TIMEOUT)); 
 	int diff = micros() - time;
 	return diff;
 }
@@ -59,18 +167,13 @@ int sensor_readSensorAt(int QRE1113_Pin) {
 // sensor_readSensors() -- read and display all sensor values
 //-----------------------------------------------------------------------
 void sensor_readSensors() {
-	// Read all four pins
-	int QRE_Value = sensor_readSensorAt(IR_LL);   // left left
-	Serial.print("LL " + (String)QRE_Value + " ");
-
-	QRE_Value = sensor_readSensorAt(IR_L);   // left
-	Serial.print("L: " + (String)QRE_Value + " ");
-
-	QRE_Value = sensor_readSensorAt(IR_R);   // right
-	Serial.print("R: " + (String)QRE_Value + " ");
-
-	QRE_Value = sensor_readSensorAt(IR_RR);  // right right
-	Serial.println("RR " + (String)QRE_Value);
+	// Read all four pins in one sweep
+	int QRE_Values[IR_COUNT];
+	sensor_getSensorVals(QRE_Values);
+	Serial.print("LL "); Serial.print(QRE_Values[0]);	// left left
+	Serial.print(" L: "); Serial.print(QRE_Values[1]);	// left
+	Serial.print(" R: "); Serial.print(QRE_Values[2]);	// right
+	Serial.print(" RR "); Serial.println(QRE_Values[3]);	// right right
   
 	/* Get a new acceleration sensor event */
     sensors_event_t event;
@@ -96,12 +199,146 @@ void sensor_readSensors() {
 
 //-----------------------------------------------------------------------
 // sensor_getSensorVals() -- get all current IR sensor values in an array
+// (LL, L, R, RR). When the pins share a port all four are charged at once
+// and timed in one polling loop, so a sweep takes at most IR_TIMEOUT.
+// Pins that did not fall by then read IR_NO_FALL.
 //-----------------------------------------------------------------------
 void sensor_getSensorVals(int *arrSensorVals) {
-	arrSensorVals[0] = sensor_readSensorAt(IR_LL);
-	arrSensorVals[1] = sensor_readSensorAt(IR_L);
-	arrSensorVals[2] = sensor_readSensorAt(IR_R);
-	arrSensorVals[3] = sensor_readSensorAt(IR_RR);
+	uint8_t port = digitalPinToPort(s_irPins[0]);
+	uint8_t masks[IR_COUNT];
+	uint8_t all = 0;
+	for (uint8_t i = 0; i < IR_COUNT; i++) {
+		if (digitalPinToPort(s_irPins[i]) != port) { // wired across ports, one at a time
+			for (uint8_t j = 0; j < IR_COUNT; j++)
+				arrSensorVals[j] = sensor_readSensorAt(s_irPins[j]);
+			return;
+		}
+		masks[i] = digitalPinToBitMask(s_irPins[i]);
+		all |= masks[i];
+	}
+
+	unsigned long time = sensor_chargeIr(port, all);
+
+	// time when each input falls, quit after IR_TIMEOUT
+	uint8_t pending = all;
+	unsigned long diff = 0;
+	while (pending != 0 && diff < IR_TIMEOUT) {
+		uint8_t fell = pending & ~*portInputRegister(port);
+		diff = micros() - time;
+		if (fell != 0) {
+			for (uint8_t i = 0; i < IR_COUNT; i++) {
+				if (fell & masks[i])
+					arrSensorVals[i] = diff;
+			}
+			pending &= ~fell;
+		}
+	}
+	for (uint8_t i = 0; i < IR_COUNT; i++) {
+		if (pending & masks[i])
+			arrSensorVals[i] = IR_NO_FALL;
+	}
+}
+
+//-----------------------------------------------------------------------
+// sensor_startIrSampling() -- start measuring the IR sensors in the
+// background. Returns false when a blocking sweep is used instead.
+//-----------------------------------------------------------------------
+bool sensor_startIrSampling(unsigned long periodUs) {
+	s_irRunning = true;
+	s_irIdle = false;
+	s_irPeriod = periodUs;
+	s_irPort = NOT_A_PORT;
+	s_irAll = 0;
+#if defined(SENSOR_IR_PCINT) && defined(PCINT0_vect)
+	uint8_t port = digitalPinToPort(s_irPins[0]);
+	for (uint8_t i = 0; i < IR_COUNT; i++) {
+		if (digitalPinToPort(s_irPins[i]) != port || digitalPinToPCICR(s_irPins[i]) == 0 ||
+				digitalPinToPCICRbit(s_irPins[i]) != PCIE0)
+			return false;
+		s_irMasks[i] = digitalPinToBitMask(s_irPins[i]);
+		s_irAll |= s_irMasks[i];
+	}
+	
+	s_irPending = 0;
+	s_irPort = port;
+	for (uint8_t i = 0; i < IR_COUNT; i++)
+		*digitalPinToPCMSK(s_irPins[i]) |= _BV(digitalPinToPCMSKbit(s_irPins[i]));
+	PCICR |= _BV(PCIE0);
+	sensor_startIrSample();
+	return true;
+#else
+	return false;
+#endif
+}
+
+//-----------------------------------------------------------------------
+// sensor_stopIrSampling() -- stop background measuring
+//-----------------------------------------------------------------------
+void sensor_stopIrSampling() {
+	s_irRunning = false;
+	if (s_irPort == NOT_A_PORT)
+		return;
+	
+#if defined(SENSOR_IR_PCINT) && defined(PCINT0_vect)
+	// the rest of PCINT0 may be used by someone else
+	for (uint8_t i = 0; i < IR_COUNT; i++)
+		*digitalPinToPCMSK(s_irPins[i]) &= ~_BV(digitalPinToPCMSKbit(s_irPins[i]));
+#endif
+	s_irPending = 0;
+	s_irPort = NOT_A_PORT;
+}
+
+//-----------------------------------------------------------------------
+// sensor_updateIrSampling() -- publish a finished set, start the next one
+//-----------------------------------------------------------------------
+bool sensor_updateIrSampling() {
+	if (!s_irRunning)
+		return false;
+	if (s_irPort == NOT_A_PORT) {
+		if (s_irSeq > 0 && micros() - s_irStart < s_irPeriod)
+			return false;
+		s_irStart = micros();
+		sensor_getSensorVals(s_irSample);
+		s_irSeq++;
+		return true;
+	}
+	
+	unsigned long diff = micros() - s_irStart;
+	if (s_irIdle) {
+		if (diff >= s_irPeriod)
+			sensor_startIrSample();
+		return false;
+	}
+	noInterrupts();
+	uint8_t pending = s_irPending;
+	if (pending != 0 && diff < IR_TIMEOUT) {
+		interrupts();
+		return false;
+	}
+	s_irPending = 0; // later falls are ignored
+	interrupts();
+	
+	for (uint8_t i = 0; i < IR_COUNT; i++) {
+		if ((pending & s_irMasks[i]) || s_irFall[i] > IR_TIMEOUT)
+			s_irSample[i] = IR_NO_FALL;
+		else
+			s_irSample[i] = s_irFall[i];
+	}
+	s_irSeq++;
+	if (micros() - s_irStart >= s_irPeriod)
+		sensor_startIrSample();
+	else
+		s_irIdle = true;
+	return true;
+}
+
+//-----------------------------------------------------------------------
+// sensor_getIrSample() -- copy the latest completed set
+//-----------------------------------------------------------------------
+unsigned long sensor_getIrSample(int *arrSensorVals) {
+	for (uint8_t i = 0; i < IR_COUNT; i++)
+		arrSensorVals[i] = s_irSample[i];
+	return s_irSeq;
 }
 
 //-----------------------------------------------------------------------
@@ -117,6 +354,77 @@ void sensor_getAccelData(float &x, float &y, float &z) {
 	z = event.acceleration.z;
 }
 
+//-----------------------------------------------------------------------
+// sensor_getAccelInt() -- gets the accelerometer data in mg
+//-----------------------------------------------------------------------
+bool sensor_getAccelInt(int &x, int &y, int &z) {
+	uint8_t buf[6];
+	x = y = z = 0;
+	if (!sensor_readRegisters(LSM303_ADDRESS_ACCEL, LSM303_REGISTER_ACCEL_OUT_X_L_A | LSM303_AUTO_INCREMENT, buf, 6))
+		return false;
+	
+	x = sensor_accelMg(&buf[0]);
+	y = sensor_accelMg(&buf[2]);
+	z = sensor_accelMg(&buf[4]);
+	return true;
+}
+
+//-----------------------------------------------------------------------
+// sensor_getMagInt() -- gets the magnetometer data in whole uT
+//-----------------------------------------------------------------------
+bool sensor_getMagInt(int &x, int &y, int &z) {
+	// CRB, MR, then X, Z, Y big endian, the magnetometer always increments
+	uint8_t buf[8];
+	x = y = z = 0;
+	if (!sensor_readRegisters(LSM303_ADDRESS_MAG, LSM303_REGISTER_MAG_CRB_REG_M, buf, 8))
+		return false;
+	
+	uint8_t gain = buf[0] >> 5;
+	long rawX = (int16_t)((buf[2] << 8) | buf[3]);
+	long rawZ = (int16_t)((buf[4] << 8) | buf[5]);
+	long rawY = (int16_t)((buf[6] << 8) | buf[7]);
+	x = rawX * 100 / s_magLsbXY[gain]; // 100 uT per gauss
+	y = rawY * 100 / s_magLsbXY[gain];
+	z = rawZ * 100 / s_magLsbZ[gain];
+	return true;
+}
+
+//-----------------------------------------------------------------------
+// sensor_setAccelStream() -- turns the accelerometer FIFO on or off
+//-----------------------------------------------------------------------
+bool sensor_setAccelStream(bool enable) {
+	// FIFO_EN, then stream mode (bypass empties it)
+	return sensor_writeRegister(LSM303_ADDRESS_ACCEL, LSM303_REGISTER_ACCEL_CTRL_REG5_A, enable ? 0x40 : 0x00) &&
+			sensor_writeRegister(LSM303_ADDRESS_ACCEL, LSM303_REGISTER_ACCEL_FIFO_CTRL_REG_A, enable ? 0x80 : 0x00);
+}
+
+//-----------------------------------------------------------------------
+// sensor_readAccelFifo() -- reads buffered accelerometer samples
+//-----------------------------------------------------------------------
+uint8_t sensor_readAccelFifo(int (*samples)[3], uint8_t max) {
+	uint8_t src;
+	if (!sensor_readRegisters(LSM303_ADDRESS_ACCEL, LSM303_REGISTER_ACCEL_FIFO_SRC_REG_A, &src, 1))
+		return 0;
+	uint8_t count = (src & 0x40) ? LSM303_FIFO_SAMPLES : (src & 0x1F); // OVRN means full
+	if (count > max)
+		count = max;
+	
+	// with the FIFO on the outputs roll over from Z back to X
+	uint8_t buf[LSM303_BURST_SAMPLES * 6];
+	uint8_t read = 0;
+	while (read < count) {
+		uint8_t burst = min((uint8_t)(count - read), (uint8_t)LSM303_BURST_SAMPLES);
+		if (!sensor_readRegisters(LSM303_ADDRESS_ACCEL, LSM303_REGISTER_ACCEL_OUT_X_L_A | LSM303_AUTO_INCREMENT, buf, burst * 6))
+			break;
+		for (uint8_t i = 0; i < burst; i++, read++) {
+			samples[read][0] = sensor_accelMg(&buf[i * 6]);
+			samples[read][1] = sensor_accelMg(&buf[i * 6 + 2]);
+			samples[read][2] = sensor_accelMg(&buf[i * 6 + 4]);
+		}
+	}
+	return read;
+}
+
 //-----------------------------------------------------------------------
 // sensor_getMagData() -- gets the raw magnetometer data in an array
 //-----------------------------------------------------------------------
@@ -129,3 +437,78 @@ void sensor_getMagData(float &x, float &y, float &z) {
 	y = event.magnetic.y;
 	z = event.magnetic.z;
 }
+
+//-----------------------------------------------------------------------
+// sensor_schedule() -- sample a source every periodMs
+//-----------------------------------------------------------------------
+void sensor_schedule(uint8_t source, unsigned long periodMs) {
+	if (source >= SENSOR_SOURCES || (s_scheduled[source] && s_periods[source] == periodMs))
+		return;
+	
+	s_scheduled[source] = true;
+	s_periods[source] = periodMs;
+	s_due[source] = millis();
+	if (source == SENSOR_IR) {
+		sensor_stopIrSampling();
+		sensor_startIrSampling(periodMs * 1000);
+	}
+}
+
+//-----------------------------------------------------------------------
+// sensor_unschedule() -- stop sampling a source
+//-----------------------------------------------------------------------
+void sensor_unschedule(uint8_t source) {
+	if (source >= SENSOR_SOURCES || !s_scheduled[source])
+		return;
+	
+	s_scheduled[source] = false;
+	if (source == SENSOR_IR)
+		sensor_stopIrSampling();
+}
+
+//-----------------------------------------------------------------------
+// sensor_update() -- refresh the caches of the sources that are due
+//-----------------------------------------------------------------------
+uint8_t sensor_update() {
+	uint8_t updated = 0;
+	if (s_scheduled[SENSOR_IR] && sensor_updateIrSampling()) {
+		sensor_getIrSample(s_cache[SENSOR_IR].vals);
+		s_cache[SENSOR_IR].time = millis();
+		s_cache[SENSOR_IR].seq++;
+		updated |= _BV(SENSOR_IR);
+	}
+	
+	unsigned long now = millis();
+	for (uint8_t source = SENSOR_MAG; source < SENSOR_SOURCES; source++) {
+		if (!s_scheduled[source] || (long)(now - s_due[source]) < 0)
+			continue;
+		
+		int x, y, z;
+		bool read;
+		if (source == SENSOR_MAG)
+			read = sensor_getMagInt(x, y, z);
+		else
+			read = sensor_getAccelInt(x, y, z);
+		s_due[source] = now + s_periods[source]; // missed samples are skipped
+		if (read) { // a failed read keeps the last values
+			SensorCache* cache = &s_cache[source];
+			cache->vals[0] = x;
+			cache->vals[1] = y;
+			cache->vals[2] = z;
+			cache->time = now;
+			cache->seq++;
+			updated |= _BV(source);
+		}
+		break; // one I2C read per update
+	}
+	return updated;
+}
+
+//-----------------------------------------------------------------------
+// sensor_getCached() -- the latest sample of a source
+//-----------------------------------------------------------------------
+const SensorCache* sensor_getCached(uint8_t source) {
+	if (source >= SENSOR_SOURCES)
+		return NULL;
+	return &s_cache[source];
+}
@@ -16,16 +16,42 @@
 #include <Arduino.h>
 #include <Adafruit_Sensor.h>
 #include <Adafruit_LSM303_U.h>
+#include <Wire.h>
+#include "Rover_Trace.h"
 
 //----------------------------- Configuration ---------------------------
+// The PCINT0 handler clashes with libraries that define the same vector
+// (SoftwareSerial), so it is only compiled in on request
+// #define SENSOR_IR_PCINT 	// time the IR pins with pin change interrupts
+
 // IR Sensors
 #define IR_RR 50  // right-most IR
 #define IR_R 51   // middle-right IR
 #define IR_L 52   // middle-left IR
 #define IR_LL 53  // left-most IR
+#define IR_COUNT 4
+#define IR_CHARGE_US 10	  // time the sensor capacitors are charged
+#define IR_TIMEOUT 3000	  // us, nothing happens after that
+#define IR_NO_FALL (IR_TIMEOUT + 1) // sampled value of a pin that never fell
+
+// LSM303 raw reads
+#define LSM303_AUTO_INCREMENT 0x80	  // register address bit for accelerometer bursts
+#define LSM303_FIFO_SAMPLES 32		  // accelerometer FIFO depth
+#define LSM303_BURST_SAMPLES (BUFFER_LENGTH / 6) // samples per Wire request
+
+// Scheduled sources
+#define SENSOR_IR 0		  // LL, L, R, RR decay times
+#define SENSOR_MAG 1	  // x, y, z in uT
+#define SENSOR_ACCEL 2	  // x, y, z in mg
+#define SENSOR_SOURCES 3
+#define SENSOR_VALUES 4	  // values per source
 
-// Debug
-#define SENSOR_PRINT
+// Latest sample of a scheduled source
+struct SensorCache {
+	int vals[SENSOR_VALUES] = {};
+	unsigned long time = 0; // millis() when it was taken
+	unsigned long seq = 0;	// samples taken, 0 before the first
+};
 
 //-----------------------------------------------------------------------
 // sensor_setup() -- Initializaion of I2C Sensor
@@ -44,9 +70,43 @@ void sensor_readSensors();
 
 //-----------------------------------------------------------------------
 // sensor_getSensorVals() -- get all current IR sensor values in an array
+// (LL, L, R, RR). When the pins share a port all four are charged at once
+// and timed in one polling loop, so a sweep takes at most IR_TIMEOUT.
+// Pins that did not fall by then read IR_NO_FALL.
 //-----------------------------------------------------------------------
 void sensor_getSensorVals(int *arrSensorVals);
 
+//-----------------------------------------------------------------------
+// sensor_startIrSampling() -- start measuring the IR sensors in the
+// background, a new set at most every periodUs (0 back to back). With
+// SENSOR_IR_PCINT defined pin change interrupts timestamp each falling
+// edge, the loop only charges the pins and collects the results.
+// Returns false when SENSOR_IR_PCINT is not defined or the pins are not
+// all on the PCINT0 port (pins 50 - 53 are), then
+// sensor_updateIrSampling() falls back to a blocking sweep.
+//-----------------------------------------------------------------------
+bool sensor_startIrSampling(unsigned long periodUs = 0);
+
+//-----------------------------------------------------------------------
+// sensor_stopIrSampling() -- stop background measuring and disable the
+// pin change interrupts of the IR pins.
+//-----------------------------------------------------------------------
+void sensor_stopIrSampling();
+
+//-----------------------------------------------------------------------
+// sensor_updateIrSampling() -- call every loop. Once every pin fell or
+// IR_TIMEOUT passed the set is published and the next one is started
+// when the period is up. Pins that did not fall read IR_NO_FALL.
+// Returns true for a new set.
+//-----------------------------------------------------------------------
+bool sensor_updateIrSampling();
+
+//-----------------------------------------------------------------------
+// sensor_getIrSample() -- copy the latest completed set (LL, L, R, RR)
+// without waiting. Returns its sequence number, 0 before the first set.
+//-----------------------------------------------------------------------
+unsigned long sensor_getIrSample(int *arrSensorVals);
+
 //-----------------------------------------------------------------------
 // sensor_getAccelData() -- gets the accelerometer data in an array
 //-----------------------------------------------------------------------
@@ -57,4 +117,58 @@ void sensor_getAccelData(float &x, float &y, float &z);
 //-----------------------------------------------------------------------
 void sensor_getMagData(float &x, float &y, float &z);
 
+//-----------------------------------------------------------------------
+// sensor_getAccelInt() -- gets the accelerometer data in mg (+-2 g)
+// with one 6 byte burst read and integer math only. Returns false and
+// zeros if the sensor did not answer.
+//-----------------------------------------------------------------------
+bool sensor_getAccelInt(int &x, int &y, int &z);
+
+//-----------------------------------------------------------------------
+// sensor_getMagInt() -- gets the magnetometer data in whole uT, the
+// same values as (int) of sensor_getMagData(), with one 8 byte burst
+// read (the gain register and the outputs) and integer math only.
+// Returns false and zeros if the sensor did not answer.
+//-----------------------------------------------------------------------
+bool sensor_getMagInt(int &x, int &y, int &z);
+
+//-----------------------------------------------------------------------
+// sensor_setAccelStream() -- turns the accelerometer FIFO in stream
+// mode on or off. While on it keeps the last LSM303_FIFO_SAMPLES
+// samples, read them with sensor_readAccelFifo().
+//-----------------------------------------------------------------------
+bool sensor_setAccelStream(bool enable);
+
+//-----------------------------------------------------------------------
+// sensor_readAccelFifo() -- reads up to max buffered accelerometer
+// samples (x, y, z in mg, oldest first), LSM303_BURST_SAMPLES per
+// request. Returns the number read.
+//-----------------------------------------------------------------------
+uint8_t sensor_readAccelFifo(int (*samples)[3], uint8_t max);
+
+//-----------------------------------------------------------------------
+// sensor_schedule() -- sample a source (SENSOR_IR, SENSOR_MAG or
+// SENSOR_ACCEL) every periodMs from the next sensor_update() on, IR with
+// 0 back to back. Scheduling again with the same period changes nothing.
+//-----------------------------------------------------------------------
+void sensor_schedule(uint8_t source, unsigned long periodMs);
+
+//-----------------------------------------------------------------------
+// sensor_unschedule() -- stop sampling a source, its cache is kept
+//-----------------------------------------------------------------------
+void sensor_unschedule(uint8_t source);
+
+//-----------------------------------------------------------------------
+// sensor_update() -- call every loop. Collects a finished IR set and
+// reads at most one due I2C source, so bus time is spread over loops.
+// Returns a bit (_BV(source)) for every cache that was refreshed.
+//-----------------------------------------------------------------------
+uint8_t sensor_update();
+
+//-----------------------------------------------------------------------
+// sensor_getCached() -- the latest sample of a source, NULL if the
+// source does not exist
+//-----------------------------------------------------------------------
+const SensorCache* sensor_getCached(uint8_t source);
+
 #endif
@@ -0,0 +1,86 @@
+//---------------------------- Rover_Trace -----------------------------
+// Filename:      	Rover_Trace.cpp
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Binary event trace. Empty unless TRACE_ENABLE is
+//					defined in Rover_Trace.h.
+//------------------------------ Includes ------------------------------
+#include "Rover_Trace.h"
+
+#ifdef TRACE_ENABLE
+//------------------------------ Globals -------------------------------
+TraceEvent t_events[TRACE_SIZE];
+unsigned long t_count = 0; // events recorded, the next one goes to t_count % TRACE_SIZE
+
+//----------------------------------------------------------------------
+// writeLong ------ Writes the low bytes of a value, least significant
+//					first.
+// Preconditions:   bytes <= 4.
+// Postconditions:  bytes bytes are written to out.
+//----------------------------------------------------------------------
+static void writeLong(Print &out, unsigned long value, uint8_t bytes) {
+	for (uint8_t i = 0; i < bytes; i++) {
+		out.write((uint8_t)value);
+		value >>= 8;
+	}
+}
+
+//----------------------------------------------------------------------
+// trace_record --- Adds an event to the ring buffer.
+// Preconditions:   Not called from an interrupt handler.
+// Postconditions:  The event is stored, replacing the oldest one when
+//					the buffer is full.
+//----------------------------------------------------------------------
+void trace_record(uint8_t id, int16_t a, int16_t b) {
+	TraceEvent* event = &t_events[t_count & (TRACE_SIZE - 1)];
+	event->id = id;
+	event->time = micros();
+	event->a = a;
+	event->b = b;
+	t_count++;
+}
+
+//----------------------------------------------------------------------
+// trace_dump ----- Writes the buffered events as a binary block.
+// Preconditions:   out is ready to write.
+// Postconditions:  TRACE_HEADER_SIZE + TRACE_EVENT_SIZE bytes per event
+//					are written. The buffer is unchanged.
+//----------------------------------------------------------------------
+void trace_dump(Print &out) {
+	unsigned long count = t_count;
+	uint16_t events = count < TRACE_SIZE ? count : TRACE_SIZE;
+
+	out.write((const uint8_t*)"RTRC", 4);
+	out.write((uint8_t)TRACE_VERSION);
+	writeLong(out, events, 2);
+	writeLong(out, count - events, 4);
+	writeLong(out, micros(), 4);
+
+	for (unsigned long i = count - events; i != count; i++) {
+		const TraceEvent* event = &t_events[i & (TRACE_SIZE - 1)];
+		out.write(event->id);
+		writeLong(out, event->time, 4);
+		writeLong(out, (uint16_t)event->a, 2);
+		writeLong(out, (uint16_t)event->b, 2);
+	}
+}
+
+//----------------------------------------------------------------------
+// trace_reset ---- Empties the buffer.
+// Preconditions:   None.
+// Postconditions:  No events are buffered or lost.
+//----------------------------------------------------------------------
+void trace_reset() {
+	t_count = 0;
+}
+
+//----------------------------------------------------------------------
+// trace_getCount - Getter for the events recorded since the last reset.
+// Preconditions:   None.
+// Postconditions:  Includes the events that were overwritten.
+//----------------------------------------------------------------------
+unsigned long trace_getCount() {
+	return t_count;
+}
+#endif
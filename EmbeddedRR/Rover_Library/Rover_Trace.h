@@ -0,0 +1,123 @@
+//---------------------------- Rover_Trace -----------------------------
+// Filename:      	Rover_Trace.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Binary event trace. Each event is a fixed record of
+//					an id, micros() and two 16 bit arguments written to
+//					a RAM ring buffer; the oldest events are overwritten.
+//					Nothing is formatted on the rover and no heap is
+//					used. trace_dump writes the buffer as one binary
+//					block that Host/trace/tracedump turns into text.
+//					Everything is compiled out unless TRACE_ENABLE is
+//					defined, every macro then does nothing. TRACE_DUMP
+//					also needs TRACE_PORT, a port the XBee is not on;
+//					the dump on the XBee's UART would be parsed as API
+//					frames.
+//					Usage:
+//						TRACE(TRACE_CMD, TRACE_PACK_CMD(cmd, lData), rData);
+//						TRACE_DUMP(); // e.g. when stopped
+//					An event costs a micros() call (about 4 us on an AVR)
+//					and a few stores. Not for interrupt handlers.
+//------------------------------ Includes ------------------------------
+#ifndef _Rover_Trace_h_
+#define _Rover_Trace_h_
+
+#include <Arduino.h>
+
+//---------------------------- Definitions -----------------------------
+// Configuration
+// #define TRACE_ENABLE 	// compile the trace in
+#define TRACE_SIZE 64 		// events kept, a power of 2
+// #define TRACE_PORT Serial1 	// where TRACE_DUMP writes, never the XBee's port
+
+// Event ids and their arguments (a, b)
+#define TRACE_NONE 0
+#define TRACE_CMD 1 		// TRACE_PACK_CMD(cmd, lData), rData of a decoded packet
+#define TRACE_STATE 2 		// new state, old state
+#define TRACE_TARGETS 3 	// left, right motor targets
+#define TRACE_IR_DIFF 4 	// leftDiff, rightDiff (outer - inner)
+#define TRACE_LINE 5 		// line position, confidence
+#define TRACE_NAV 6 		// lateness of the next navigation packet (ms), packets queued
+#define TRACE_XBEE_ERROR 7 	// XBee error code, TRACE_AT_*
+#define TRACE_XBEE_API 8 	// unexpected API id, 0
+#define TRACE_UNTRUSTED 9 	// low and high 16 bits of the sender's address LSB
+#define TRACE_NO_SENSOR 10 	// 0 accelerometer, 1 magnetometer
+#define TRACE_USER 11 		// first id free for sketches
+
+// Names for the host decoder, by id
+#define TRACE_NAMES { "none", "cmd", "state", "targets", "ir_diff", "line", "nav", \
+		"xbee_error", "xbee_api", "untrusted", "no_sensor" }
+
+// Where an XBee error was seen
+#define TRACE_AT_ACK 0 		// com_getAck
+#define TRACE_AT_RECEIVE 1 	// com_receiveData
+
+// Command, 10 bit lData into one argument
+#define TRACE_PACK_CMD(cmd, lData) ((int16_t)(((cmd) << 10) | ((lData) & 0x3FF)))
+
+/* Dump (little endian):
+ *	"RTRC", version (1), events (2), events lost (4), micros() (4)
+ *	then the events, oldest first: id (1), micros() (4), a (2), b (2)
+ */
+#define TRACE_VERSION 1
+#define TRACE_HEADER_SIZE 15
+#define TRACE_EVENT_SIZE 9
+
+// One event
+struct TraceEvent {
+	uint8_t id;
+	unsigned long time;
+	int16_t a;
+	int16_t b;
+};
+
+//------------------------------ Macros --------------------------------
+#ifdef TRACE_ENABLE
+	#define TRACE(id, a, b) trace_record((id), (a), (b))
+	#define TRACE_RESET() trace_reset()
+#else // statements that do nothing, so an if around one has a body
+	#define TRACE(id, a, b) ((void)0)
+	#define TRACE_RESET() ((void)0)
+#endif
+
+#if defined(TRACE_ENABLE) && defined(TRACE_PORT)
+	#define TRACE_DUMP() trace_dump(TRACE_PORT)
+#else
+	#define TRACE_DUMP() ((void)0)
+#endif
+
+#ifdef TRACE_ENABLE
+//------------------------------ Class Functions ------------------------
+//----------------------------------------------------------------------
+// trace_record --- Adds an event to the ring buffer.
+// Preconditions:   Not called from an interrupt handler.
+// Postconditions:  The event is stored, replacing the oldest one when
+//					the buffer is full.
+//----------------------------------------------------------------------
+void trace_record(uint8_t id, int16_t a, int16_t b);
+
+//----------------------------------------------------------------------
+// trace_dump ----- Writes the buffered events as a binary block.
+// Preconditions:   out is ready to write.
+// Postconditions:  TRACE_HEADER_SIZE + TRACE_EVENT_SIZE bytes per event
+//					are written. The buffer is unchanged.
+//----------------------------------------------------------------------
+void trace_dump(Print &out);
+
+//----------------------------------------------------------------------
+// trace_reset ---- Empties the buffer.
+// Preconditions:   None.
+// Postconditions:  No events are buffered or lost.
+//----------------------------------------------------------------------
+void trace_reset();
+
+//----------------------------------------------------------------------
+// trace_getCount - Getter for the events recorded since the last reset.
+// Preconditions:   None.
+// Postconditions:  Includes the events that were overwritten.
+//----------------------------------------------------------------------
+unsigned long trace_getCount();
+#endif
+
+#endif
@@ -10,12 +10,23 @@
 #include <Rover_Lights.h>
 #include <Rover_Movement.h>
 #include <Rover_Sensors.h>
+#include <Rover_Line.h>
+#include <Rover_Profiler.h>
+#include <Rover_Trace.h>
+#include <Rover_Clock.h>
 
 //-------------------------- Configuration  ---------------------------
+// sensors
+#define IR_IDLE_MS 250          // IR period while stopped or manual (line following is back to back)
+#define MAG_PERIOD_MS 250       // magnetometer period while stopped or manual, read on demand otherwise
+
 // traversal
 #define TURN_POWER -30          // Turning power of motor
 #define STRAIGHT_POWER 30       // How fast to move
-#define THRESHOLD 100           // The threshold difference between sensors
+#define THRESHOLD 100           // The contrast between sensors (us) that is a line
+#define LOST_CONFIDENCE (THRESHOLD * LINE_CONF_MAX / LINE_CONTRAST) // line confidence below this is lost
+#define STEER_POSITION 500      // line position (of LINE_POS_MAX) to turn toward it
+#define CENTRE_POSITION 250     // line position to go straight again, under STEER_POSITION so it doesn't chatter
 #define GIVE_UP_LIMIT 2000      // Time in miliseconds before we give up
 #define STRAIGHT_TIME_MAX 5000  // Time in miliseconds to transmit a continous straight
 
@@ -27,9 +38,12 @@
 // #define MSTR_ADDR 0x4321        // CEDC 16 bit addr
 // #define R2_ADDR 0x1243          // DA0F 16 bit addr
 
-// debug
-// #define RVR_DEBUG_SENSORS
-// #define RVR_DEBUG_CMDS
+// i2c
+// #define RVR_I2C_FAST            // 400 kHz bus for the motor shield and sensors
+
+// debug, events recorded with Rover_Trace (TRACE_ENABLE)
+// #define RVR_DEBUG_SENSORS       // IR differences and line estimate of every set
+// #define RVR_DEBUG_CMDS          // decoded commands
 
 //----------------------------- Globals  ------------------------------
 #define STATE_STOP 0
@@ -45,7 +59,6 @@ bool lastDirectionRight = true; // used for lost state direction
 unsigned long giveUpStart = 0;
 unsigned long straightTimeStart = 0;
 int curSensorVals[4] = {0, 0, 0, 0};
-int outlierThreshold = 0;
 int halfSlavePayload;
 int lastAck = ACK_SUCCESS;
 bool retransmitToggle = false; // retransmit every other loop
@@ -59,11 +72,17 @@ void setup() {
   
   move_setupMotors();
   light_setupLights();
+  light_setRefresh(LIGHT_INTERVAL_MS, true); // hold pushes while XBee bytes wait
   com_setupComs(MSTR_ADDR_SH, MSTR_ADDR_SL, R2_ADDR_SH, R2_ADDR_SL);
   sensor_setup();
+  scheduleSensors(false);
   
   light_lightRed();
   
+  #ifdef RVR_I2C_FAST
+    move_setI2CClock(I2C_FAST); // after every Wire.begin()
+  #endif
+  
   // delay(3000);
   // enterSearchState();
 }
@@ -72,9 +91,35 @@ void setup() {
 //------------------------------ Main Loop -----------------------------
 //----------------------------------------------------------------------
 void loop() {
-  sensor_getSensorVals(curSensorVals);
+  PROF_SCOPE(PROF_LOOP, "loop");
+  
+  PROF_BEGIN(PROF_SENSORS);
+  if (sensor_update() & _BV(SENSOR_IR)) { // keeps the last set until a new one is done
+    memcpy(curSensorVals, sensor_getCached(SENSOR_IR)->vals, sizeof(curSensorVals));
+    line_update(curSensorVals);
+    #ifdef RVR_DEBUG_SENSORS
+      int filtered[4];
+      line_getFiltered(filtered);
+      TRACE(TRACE_IR_DIFF, filtered[0] - filtered[1], filtered[3] - filtered[2]);
+      TRACE(TRACE_LINE, line_getPosition(), line_getConfidence());
+    #endif
+  }
+  PROF_END(PROF_SENSORS, "sensors");
+  
+  PROF_BEGIN(PROF_STATE);
+  int lastState = currentState;
   updateState();
+  if (currentState != lastState) {
+    TRACE(TRACE_STATE, currentState, lastState);
+    TRACE(TRACE_TARGETS, move_getTargetLeft(), move_getTargetRight());
+  }
+  PROF_END(PROF_STATE, "state");
+  
+  PROF_BEGIN(PROF_MOTORS);
   move_updateMotors();
+  PROF_END(PROF_MOTORS, "motors");
+  
+  light_update(); // push a color held back by the refresh limits
 }
 
 //----------------------------------------------------------------------
@@ -86,20 +131,12 @@ void loop() {
 //                  and xbee communication.
 //----------------------------------------------------------------------
 void updateState( ) {
-  // sensor data (outer - inner)
-  int leftDiff = curSensorVals[0] - curSensorVals[1];
-  int rightDiff = curSensorVals[3] - curSensorVals[2];
+  // line estimate from the filtered sensors, single noisy samples don't change state
+  int position = line_getPosition();
+  bool onLine = line_getConfidence() >= LOST_CONFIDENCE;
 
   int rcv = 0;
   
-  #ifdef RVR_DEBUG_SENSORS
-    Serial.print(String(curSensorVals[0]) + ", " + String(curSensorVals[1]) + ", " +
-        String(curSensorVals[2]) + ", " + String(curSensorVals[3]));
-    Serial.print(" -> LDiff: " + String(leftDiff) + " RDiff: " + String(rightDiff));
-    Serial.println( " (THRESHOLD: " + String(THRESHOLD) + " outlierThreshold: " + String(outlierThreshold) + " )");
-    delay(500);
-  #endif
-
   if (curSensorVals[0] > 3000 && curSensorVals[1] > 3000 && curSensorVals[2] > 3000 &&
       curSensorVals[3] > 3000 && currentState != STATE_STOP) { // picked up
     emergencyStop(true); // sends stats
@@ -118,20 +155,13 @@ void updateState( ) {
     // SEARCH
     //------------------------------------------------------------------
     case STATE_SEARCH: // from slow start, find the line
-      if (leftDiff > THRESHOLD) { // if left diff is greater, steer left
-        outlierThreshold = abs(leftDiff) + THRESHOLD;
-        enterLeftState();
-      }
-      else if (rightDiff > THRESHOLD) { // if right diff is greater, steer right
-        outlierThreshold = abs(rightDiff) + THRESHOLD;
-        enterRightState();
-      }
-      else if (abs(leftDiff) > THRESHOLD || abs(rightDiff) > THRESHOLD) { // continue straight
-        if (abs(leftDiff) > abs(rightDiff))
-          outlierThreshold = abs(leftDiff) + THRESHOLD;
-        else
-          outlierThreshold = abs(rightDiff) + THRESHOLD;
-        enterStraightState();
+      if (onLine) { // found the line, steer toward it
+        if (position < -STEER_POSITION) // line is to the left, steer left
+          enterLeftState();
+        else if (position > STEER_POSITION) // line is to the right, steer right
+          enterRightState();
+        else // continue straight
+          enterStraightState();
       }
 
       // receive any new xbee data
@@ -153,15 +183,7 @@ void updateState( ) {
         while (com_decodeNext(&timestamp, &cmd, &lData, &rData) == true) { // keep decoding
 
           #ifdef RVR_DEBUG_CMDS
-            Serial.println();
-            Serial.print("cmd:"); // debug
-            Serial.print(cmd, HEX);
-            Serial.print(" lData:");
-            Serial.print(lData, HEX);
-            Serial.print(" rData:");
-            Serial.print(rData, HEX);
-            Serial.print(" time:");
-            Serial.println(timestamp, HEX);
+            TRACE(TRACE_CMD, TRACE_PACK_CMD(cmd, lData), rData);
           #endif
           
           switch (cmd) {
@@ -169,16 +191,16 @@ void updateState( ) {
               emergencyStop(true); // sends stats
               break;*/
               
+            case CLOCK_CMD: // Clock sync request from rover 2
+              answerClock(lData, rData);
+              break;
+
             case 0x1: // Slow Stop
               enterStopState(true); // sends stats
               break;
 
             case 0x7: // Sensor request
-              com_encodeMasterPacket(0x7, leftDiff, rightDiff);
-              float x, y, z;
-              sensor_getMagData(x, y, z);
-              com_encodeMasterPacket(0x8, (int)x, int(z));
-              com_sendMaster64(true); // send payload to master and request ack - no retry
+              answerSensors();
               light_lightYellow();
               break;
           }
@@ -204,15 +226,15 @@ void updateState( ) {
     // STRAIGHT
     //------------------------------------------------------------------
     case STATE_STRAIGHT: // moving forward
-      if (leftDiff > THRESHOLD && leftDiff < outlierThreshold) { // if left diff is greater, steer left
+      if (!onLine) { // if line is lost, consider giving up
+        enterLostState();
+      }
+      else if (position < -STEER_POSITION) { // line is to the left, steer left
         enterLeftState();
       }
-      else if (rightDiff > THRESHOLD && rightDiff < outlierThreshold) { // if right diff is greater, steer right
+      else if (position > STEER_POSITION) { // line is to the right, steer right
         enterRightState();
       }
-      else if (abs(leftDiff) < THRESHOLD && abs(rightDiff) < THRESHOLD) { // if line is lost, consider giving up
-        enterLostState();
-      }
 
       // receive any new xbee data
       rcv = com_receiveData();
@@ -233,15 +255,7 @@ void updateState( ) {
         while (com_decodeNext(&timestamp, &cmd, &lData, &rData) == true) { // keep decoding
 
           #ifdef RVR_DEBUG_CMDS
-            Serial.println();
-            Serial.print("cmd:"); // debug
-            Serial.print(cmd, HEX);
-            Serial.print(" lData:");
-            Serial.print(lData, HEX);
-            Serial.print(" rData:");
-            Serial.print(rData, HEX);
-            Serial.print(" time:");
-            Serial.println(timestamp, HEX);
+            TRACE(TRACE_CMD, TRACE_PACK_CMD(cmd, lData), rData);
           #endif
           
           switch (cmd) {
@@ -249,16 +263,16 @@ void updateState( ) {
               emergencyStop(true); // sends stats
               break;*/
               
+            case CLOCK_CMD: // Clock sync request from rover 2
+              answerClock(lData, rData);
+              break;
+
             case 0x1: // Slow Stop
               enterStopState(true); // sends stats
               break;
 
             case 0x7: // Sensor request
-              com_encodeMasterPacket(0x7, leftDiff, rightDiff);
-              float x, y, z;
-              sensor_getMagData(x, y, z);
-              com_encodeMasterPacket(0x8, (int)x, int(z));
-              com_sendMaster64(true); // send payload to master and request ack - no retry
+              answerSensors();
               light_lightGreen();
               break;
           }
@@ -284,16 +298,12 @@ void updateState( ) {
     // LEFT
     //------------------------------------------------------------------
     case STATE_LEFT: // turning left
-      if (leftDiff < THRESHOLD) { // if left diff is less, continue forward
-         enterStraightState();
-      }
-      /*else if (rightDiff > THRESHOLD && rightDiff < outlierThreshold) { // if right diff is greater, steer right
-         enterRightState();
-         // note that this could overload slaveSlots
-      }*/
-      else if (abs(leftDiff) < THRESHOLD && abs(rightDiff) < THRESHOLD) { // if line is lost, consider giving up
+      if (!onLine) { // if line is lost, consider giving up
         enterLostState();
       }
+      else if (position > -CENTRE_POSITION) { // line is back in the middle, continue forward
+        enterStraightState();
+      }
 
       // receive any new xbee data
       rcv = com_receiveData();
@@ -314,15 +324,7 @@ void updateState( ) {
         while (com_decodeNext(&timestamp, &cmd, &lData, &rData) == true) { // keep decoding
 
           #ifdef RVR_DEBUG_CMDS
-            Serial.println();
-            Serial.print("cmd:"); // debug
-            Serial.print(cmd, HEX);
-            Serial.print(" lData:");
-            Serial.print(lData, HEX);
-            Serial.print(" rData:");
-            Serial.print(rData, HEX);
-            Serial.print(" time:");
-            Serial.println(timestamp, HEX);
+            TRACE(TRACE_CMD, TRACE_PACK_CMD(cmd, lData), rData);
           #endif
           
           switch (cmd) {
@@ -330,16 +332,16 @@ void updateState( ) {
               emergencyStop(true); // sends stats
               break;*/
               
+            case CLOCK_CMD: // Clock sync request from rover 2
+              answerClock(lData, rData);
+              break;
+
             case 0x1: // Slow Stop
               enterStopState(true); // sends stats
               break;
 
             case 0x7: // Sensor request
-              com_encodeMasterPacket(0x7, leftDiff, rightDiff);
-              float x, y, z;
-              sensor_getMagData(x, y, z);
-              com_encodeMasterPacket(0x8, (int)x, int(z));
-              com_sendMaster64(true); // send payload to master and request ack - no retry
+              answerSensors();
               light_turnLeft();
               break;
           }
@@ -357,16 +359,12 @@ void updateState( ) {
     // RIGHT
     //------------------------------------------------------------------
     case STATE_RIGHT: // turning right
-      if (rightDiff < THRESHOLD) { // if right diff is less, continue forward
-        enterStraightState();
-      }
-      /*else if (leftDiff > THRESHOLD && leftDiff < outlierThreshold) { // if left diff is greater, steer left
-        enterLeftState();
-        // note that this could overload slaveSlots
-      }*/
-      else if (abs(leftDiff) < THRESHOLD && abs(rightDiff) < THRESHOLD) { // if line is lost, consider giving up
+      if (!onLine) { // if line is lost, consider giving up
         enterLostState();
       }
+      else if (position < CENTRE_POSITION) { // line is back in the middle, continue forward
+        enterStraightState();
+      }
 
       // receive any new xbee data
       rcv = com_receiveData();
@@ -387,15 +385,7 @@ void updateState( ) {
         while (com_decodeNext(&timestamp, &cmd, &lData, &rData) == true) { // keep decoding
 
           #ifdef RVR_DEBUG_CMDS
-            Serial.println();
-            Serial.print("cmd:"); // debug
-            Serial.print(cmd, HEX);
-            Serial.print(" lData:");
-            Serial.print(lData, HEX);
-            Serial.print(" rData:");
-            Serial.print(rData, HEX);
-            Serial.print(" time:");
-            Serial.println(timestamp, HEX);
+            TRACE(TRACE_CMD, TRACE_PACK_CMD(cmd, lData), rData);
           #endif
           
           switch (cmd) {
@@ -403,16 +393,16 @@ void updateState( ) {
               emergencyStop(true); // sends stats
               break;*/
               
+            case CLOCK_CMD: // Clock sync request from rover 2
+              answerClock(lData, rData);
+              break;
+
             case 0x1: // Slow Stop
               enterStopState(true); // sends stats
               break;
 
             case 0x7: // Sensor request
-              com_encodeMasterPacket(0x7, leftDiff, rightDiff);
-              float x, y, z;
-              sensor_getMagData(x, y, z);
-              com_encodeMasterPacket(0x8, (int)x, int(z));
-              com_sendMaster64(true); // send payload to master and request ack - no retry
+              answerSensors();
               light_turnRight();
               break;
           }
@@ -430,17 +420,17 @@ void updateState( ) {
     // LOST
     //------------------------------------------------------------------
     case STATE_LOST: // Lost the line
-      if (leftDiff > THRESHOLD && leftDiff < outlierThreshold) { // if left diff is greater, steer left
-        enterLeftState();
-      }
-      else if (rightDiff > THRESHOLD && rightDiff < outlierThreshold) { // if right diff is greater, steer right
-        enterRightState();
-      }
-      else if (abs(leftDiff) < THRESHOLD && abs(rightDiff) < THRESHOLD) { // if line is still lost, consider giving up
+      if (!onLine) { // if line is still lost, consider giving up
         if (millis() - giveUpStart > GIVE_UP_LIMIT) {
           enterStopState(true); // sends stats
         }
       }
+      else if (position < -STEER_POSITION) { // line is to the left, steer left
+        enterLeftState();
+      }
+      else if (position > STEER_POSITION) { // line is to the right, steer right
+        enterRightState();
+      }
       else { // On the line
         enterStraightState();
       }
@@ -464,15 +454,7 @@ void updateState( ) {
         while (com_decodeNext(&timestamp, &cmd, &lData, &rData) == true) { // keep decoding
 
           #ifdef RVR_DEBUG_CMDS
-            Serial.println();
-            Serial.print("cmd:"); // debug
-            Serial.print(cmd, HEX);
-            Serial.print(" lData:");
-            Serial.print(lData, HEX);
-            Serial.print(" rData:");
-            Serial.print(rData, HEX);
-            Serial.print(" time:");
-            Serial.println(timestamp, HEX);
+            TRACE(TRACE_CMD, TRACE_PACK_CMD(cmd, lData), rData);
           #endif
           
           switch (cmd) {
@@ -480,16 +462,16 @@ void updateState( ) {
               emergencyStop(true); // sends stats
               break;*/
               
+            case CLOCK_CMD: // Clock sync request from rover 2
+              answerClock(lData, rData);
+              break;
+
             case 0x1: // Slow Stop
               enterStopState(true); // sends stats
               break;
 
             case 0x7: // Sensor request
-              com_encodeMasterPacket(0x7, leftDiff, rightDiff);
-              float x, y, z;
-              sensor_getMagData(x, y, z);
-              com_encodeMasterPacket(0x8, (int)x, int(z));
-              com_sendMaster64(true); // send payload to master and request ack - no retry
+              answerSensors();
               light_lightYellow();
               break;
           }
@@ -526,15 +508,7 @@ void updateState( ) {
         while (com_decodeNext(&timestamp, &cmd, &lData, &rData) == true) { // keep decoding
 
           #ifdef RVR_DEBUG_CMDS
-            Serial.println();
-            Serial.print("cmd:"); // debug
-            Serial.print(cmd, HEX);
-            Serial.print(" lData:");
-            Serial.print(lData, HEX);
-            Serial.print(" rData:");
-            Serial.print(rData, HEX);
-            Serial.print(" time:");
-            Serial.println(timestamp, HEX);
+            TRACE(TRACE_CMD, TRACE_PACK_CMD(cmd, lData), rData);
           #endif
           
           switch (cmd) {
@@ -542,6 +516,10 @@ void updateState( ) {
               emergencyStop(false); // no stats
               break;*/
               
+            case CLOCK_CMD: // Clock sync request from rover 2
+              answerClock(lData, rData);
+              break;
+
             case 0x2: // Forward
               enterManualState();
               move_moveForward(false); // target adjustment of speed (non-blocking)
@@ -567,11 +545,7 @@ void updateState( ) {
               break;
 
             case 0x7: // Sensor request
-              com_encodeMasterPacket(0x7, leftDiff, rightDiff);
-              float x, y, z;
-              sensor_getMagData(x, y, z);
-              com_encodeMasterPacket(0x8, (int)x, int(z));
-              com_sendMaster64(true); // send payload to master and request ack - no retry
+              answerSensors();
               light_lightRed();
               break;
           }
@@ -608,15 +582,7 @@ void updateState( ) {
         while (com_decodeNext(&timestamp, &cmd, &lData, &rData) == true) { // keep decoding
 
           #ifdef RVR_DEBUG_CMDS
-            Serial.println();
-            Serial.print("cmd:"); // debug
-            Serial.print(cmd, HEX);
-            Serial.print(" lData:");
-            Serial.print(lData, HEX);
-            Serial.print(" rData:");
-            Serial.print(rData, HEX);
-            Serial.print(" time:");
-            Serial.println(timestamp, HEX);
+            TRACE(TRACE_CMD, TRACE_PACK_CMD(cmd, lData), rData);
           #endif
           
           switch (cmd) {
@@ -624,6 +590,10 @@ void updateState( ) {
               emergencyStop(false); // no stats
               break;*/
   
+            case CLOCK_CMD: // Clock sync request from rover 2
+              answerClock(lData, rData);
+              break;
+
             case 0x1: // Slow Stop
               enterStopState(false); // no stats
               break;
@@ -649,11 +619,7 @@ void updateState( ) {
               break;
 
             case 0x7: // Sensor request
-              com_encodeMasterPacket(0x7, leftDiff, rightDiff);
-              float x, y, z;
-              sensor_getMagData(x, y, z);
-              com_encodeMasterPacket(0x8, (int)x, int(z));
-              com_sendMaster64(true); // send payload to master and request ack - no retry
+              answerSensors();
               break;
           }
           
@@ -671,12 +637,48 @@ void updateState( ) {
   }
 }
 
+//----------------------------------------------------------------------
+// scheduleSensors() -- Samples IR back to back while following the line,
+// otherwise only for sensor requests. The magnetometer is only sampled
+// while not following, so it takes no I2C time from steering.
+//----------------------------------------------------------------------
+void scheduleSensors(bool following) {
+  sensor_schedule(SENSOR_IR, following ? 0 : IR_IDLE_MS);
+  if (following)
+    sensor_unschedule(SENSOR_MAG);
+  else
+    sensor_schedule(SENSOR_MAG, MAG_PERIOD_MS);
+}
+
+//----------------------------------------------------------------------
+// answerSensors() -- Answers a sensor request from master with the
+// filtered IR differences (outer - inner) and the magnetometer x and z.
+// While following the magnetometer is read on demand.
+//----------------------------------------------------------------------
+void answerSensors() {
+  int filtered[4];
+  line_getFiltered(filtered);
+
+  int x, y, z;
+  bool following = currentState != STATE_STOP && currentState != STATE_MANUAL;
+  if (!following || !sensor_getMagInt(x, y, z)) { // cached, or the last values if the read failed
+    const SensorCache* mag = sensor_getCached(SENSOR_MAG);
+    x = mag->vals[0];
+    z = mag->vals[2];
+  }
+
+  com_encodeMasterPacket(0x7, filtered[0] - filtered[1], filtered[3] - filtered[2]);
+  com_encodeMasterPacket(0x8, x, z);
+  com_sendMaster64(true); // send payload to master and request ack - no retry
+}
+
 //----------------------------------------------------------------------
 // enterManualState() -- Enters STATE_MANUAL
 //----------------------------------------------------------------------
 void enterManualState() {
   currentState = STATE_MANUAL;
   light_lightWhite();
+  scheduleSensors(false);
 }
 
 //----------------------------------------------------------------------
@@ -685,6 +687,8 @@ void enterManualState() {
 void enterSearchState() {
   currentState = STATE_SEARCH;
   light_lightYellow();
+  scheduleSensors(true);
+  line_reset(); // no estimate from before a stop or manual drive
   move_setTarget(STRAIGHT_POWER, STRAIGHT_POWER);
   giveUpStart = 0;
   straightTimeStart = millis();
@@ -700,6 +704,7 @@ void enterSearchState() {
 void enterStraightState() {
   currentState = STATE_STRAIGHT;
   light_lightGreen();
+  scheduleSensors(true);
   move_setTarget(STRAIGHT_POWER, STRAIGHT_POWER);
   giveUpStart = 0;
   straightTimeStart = millis();
@@ -718,6 +723,7 @@ void enterStraightState() {
 void enterLostState() {
   currentState = STATE_LOST;
   light_lightYellow();
+  scheduleSensors(true);
   giveUpStart = millis(); // timestamp
 
   if (lastDirectionRight) // try the last direction
@@ -739,6 +745,7 @@ void enterLostState() {
 void enterLeftState() {
   currentState = STATE_LEFT;
   light_turnLeft();
+  scheduleSensors(true);
   move_setTarget(TURN_POWER, STRAIGHT_POWER);
   giveUpStart = 0;
   lastDirectionRight = false;
@@ -753,6 +760,7 @@ void enterLeftState() {
 void enterRightState() {
   currentState = STATE_RIGHT;
   light_turnRight();
+  scheduleSensors(true);
   move_setTarget(STRAIGHT_POWER, TURN_POWER);
   giveUpStart = 0;
   lastDirectionRight = true;
@@ -783,6 +791,7 @@ void enterStopState(bool stats) {
   }
 
   currentState = STATE_STOP;
+  scheduleSensors(false);
 
   // clear payloads
   com_emptyPayload(true); // slave payload
@@ -792,9 +801,30 @@ void enterStopState(bool stats) {
   // empty the packetQueue
   com_emptyQueue();
 
-  // send stats to master
-  if (stats)
+  // send stats and loop times to master
+  if (stats) {
     com_sendStatistics64(true); // stats with ack(s) to master - no retry
+    PROF_SEND(true); // loop times with ack(s) to master - no retry
+    TRACE_DUMP(); // binary, for Host/trace/tracedump, only with a TRACE_PORT
+  }
+}
+
+//----------------------------------------------------------------------
+// answerClock() -- Answers a clock sync request from rover 2 right away,
+// the time it was held goes back with the answer.
+//----------------------------------------------------------------------
+void answerClock(int seq, int request) {
+  if (request != CLOCK_REQUEST)
+    return;
+  unsigned long received = millis() - com_getDecodedAge();
+
+  if (com_getSlaveSlotsLeft() < com_getMaxSlaveSlots()) // the answer goes alone, as short as the request
+    lastAck = com_sendSlave64(true); // send payload to slave and request ack
+  int hold = clock_answer(millis() - received);
+  if (hold == CLOCK_NONE) // too old to be of use
+    return;
+  com_encodeSlavePacket(CLOCK_CMD, seq, hold);
+  lastAck = com_sendSlave64(true); // send payload to slave and request ack
 }
 
 //----------------------------------------------------------------------
@@ -805,7 +835,9 @@ void enterStopState(bool stats) {
 void emergencyStop(bool stats) {
   // stop
   move_fullStop();
-  light_lightPurple();
+  light_lightRed();
+  light_blink(LIGHT_LAYER_ALERT, LIGHT_PURPLE, LIGHT_CLEAR, 200, 3); // over the red
+  light_flush(); // purple right away, the rest plays from loop()
 
   // clear payloads 
   com_emptyPayload(true); // slave payload
@@ -823,12 +855,14 @@ void emergencyStop(bool stats) {
 
   // finalize state change and send statistics to master
   currentState = STATE_STOP;
+  scheduleSensors(false);
   giveUpStart = 0;
   lastDirectionRight = true;
   if (stats) {
     com_sendStatistics64(true); // stats with ack(s) to master - no retry
     com_resetStatistics();
+    PROF_SEND(true); // loop times with ack(s) to master - no retry
+    PROF_RESET();
+    TRACE_DUMP(); // binary, for Host/trace/tracedump, only with a TRACE_PORT
   }
-  delay(100);
-  light_lightRed();
 }
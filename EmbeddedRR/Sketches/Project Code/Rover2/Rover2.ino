@@ -9,7 +9,11 @@
 #include <Rover_Communication.h>
 #include <Rover_Lights.h>
 #include <Rover_Movement.h>
+#include <Rover_Navigation.h>
 #include <Rover_Sensors.h>
+#include <Rover_Profiler.h>
+#include <Rover_Trace.h>
+#include <Rover_Clock.h>
 
 //-------------------------- Configuration  ---------------------------
 // communication
@@ -20,8 +24,11 @@
 // #define MSTR_ADDR 0x4321        // CEDC 16 bit addr
 // #define R1_ADDR 0x1234          // CEDE 16 bit addr
 
-// debug
-// #define RVR_DEBUG
+// i2c
+// #define RVR_I2C_FAST            // 400 kHz bus for the motor shield and sensors
+
+// debug, events recorded with Rover_Trace (TRACE_ENABLE)
+// #define RVR_DEBUG               // decoded commands, navigation lateness and motor targets
 
 //------------------------------ Globals  -----------------------------
 #define STATE_STOP 0
@@ -33,38 +40,47 @@
 #define STATE_MANUAL 6
 
 int currentState = STATE_STOP;
-long masterOffset = 0;
-
-// Navigation Packet (8 bytes):
-struct NavigationPacket {
-  unsigned long timestamp = 0;
-  int leftPower = 0; // wastes 6 bits
-  int rightPower = 0; // wastes 6 bits
-};
-
-QueueArray<NavigationPacket> navigationQueue;
 
 //------------------------------ Setup  -------------------------------
 void setup() {
   // Set up Serial library at 9600 bps
   Serial.begin(9600);
   
-  #ifdef RVR_DEBUG
-    navigationQueue.setPrinter(Serial);
-  #endif
-  
   move_setupMotors();
   light_setupLights();
+  light_setRefresh(LIGHT_INTERVAL_MS, true); // hold pushes while XBee bytes wait
   com_setupComs(MSTR_ADDR_SH, MSTR_ADDR_SL, R1_ADDR_SH, R1_ADDR_SL);
+  nav_setupNavigation();
+  com_setQueueCapacity(COM_QUEUE_NAV, nav_getCapacity()); // reported with the stats frame
+  clock_reset();
   light_lightRed();
+  
+  #ifdef RVR_I2C_FAST
+    move_setI2CClock(I2C_FAST); // after every Wire.begin()
+  #endif
 }
 
 //----------------------------------------------------------------------
 //------------------------------ Main Loop -----------------------------
 //----------------------------------------------------------------------
 void loop() {
+  PROF_SCOPE(PROF_LOOP, "loop");
+  
+  PROF_BEGIN(PROF_STATE);
+  int lastState = currentState;
   updateState();
+  if (currentState != lastState)
+    TRACE(TRACE_STATE, currentState, lastState);
+  com_noteQueueDepth(COM_QUEUE_NAV, nav_getQueuedPackets()); // high-water for the stats frame
+  if (currentState != STATE_STOP && currentState != STATE_MANUAL)
+    requestClock(); // rover 1's clock for the navigation replay
+  PROF_END(PROF_STATE, "state");
+  
+  PROF_BEGIN(PROF_MOTORS);
   move_updateMotors();
+  PROF_END(PROF_MOTORS, "motors");
+  
+  light_update(); // push a color held back by the refresh limits
 }
 
 //----------------------------------------------------------------------
@@ -83,14 +99,8 @@ void updateState() {
   NavigationPacket thePacket;
 
   #ifdef RVR_DEBUG
-    if (!navigationQueue.isEmpty()) {
-      thePacket = navigationQueue.peek();
-      unsigned long now = millis();
-      Serial.print("Packet time: " + String(thePacket.timestamp) + " millis: " +
-          String(now) + " offset: " + String(masterOffset));
-      now = now + masterOffset - thePacket.timestamp;
-      Serial.println(" millis() + masterOffset - thePacket.timestamp = " + String((long)now));
-    }
+    if (nav_peek(&thePacket))
+      TRACE(TRACE_NAV, constrain(nav_getLateness(&thePacket), -32768L, 32767L), nav_getQueuedPackets());
   #endif
 
   switch(currentState) {
@@ -113,17 +123,7 @@ void updateState() {
         while (com_decodeNext(&timestamp, &cmd, &lData, &rData) == true) { // keep decoding
 
           #ifdef RVR_DEBUG
-            Serial.println();
-            Serial.print("cmd:"); // debug
-            Serial.print(cmd, HEX);
-            Serial.print(" lData:");
-            Serial.print(lData, HEX);
-            Serial.print(" rData:");
-            Serial.print(rData, HEX);
-            Serial.print(" time:");
-            Serial.print(timestamp, HEX);
-            Serial.print(" navQueue:");
-            Serial.println(navigationQueue.count());
+            TRACE(TRACE_CMD, TRACE_PACK_CMD(cmd, lData), rData);
           #endif
           
           switch (cmd) {
@@ -132,17 +132,17 @@ void updateState() {
               break;*/
   
             case 0xA: // Navigation Data
-              thePacket.timestamp = timestamp;
-              thePacket.leftPower = lData;
-              thePacket.rightPower = rData;
-              navigationQueue.enqueue(thePacket);
+              queueNav(timestamp, lData, rData);
               light_lightYellow();
               break;
+
+            case CLOCK_CMD: // Clock sync answer from rover 1
+              syncClock(timestamp, lData, rData);
+              break;
               
             case 0x6: // Start Follow
-              thePacket = navigationQueue.dequeue();
-              masterOffset = thePacket.timestamp - millis(); // syncs the clocks
-              executeNav(thePacket.leftPower, thePacket.rightPower);
+              if (nav_start(&thePacket)) // replays from here
+                executeNav(thePacket.leftPower, thePacket.rightPower);
               break;
           }
 
@@ -160,13 +160,9 @@ void updateState() {
     //------------------------------------------------------------------
     case STATE_STRAIGHT: // moving forward
       // check the navigation queue
-      if (!navigationQueue.isEmpty()) {
-        thePacket = navigationQueue.peek();
-        long comparison = millis() + masterOffset - thePacket.timestamp;
-        if (comparison >= 0) { // is the next target now (or in the past)?
-          navigationQueue.dequeue(); // remove it from queue
+      if (!nav_isEmpty()) {
+        if (nav_getDue(&thePacket)) // is the next target now (or in the past)?
           executeNav(thePacket.leftPower, thePacket.rightPower);
-        }
       }
       else { // no navigation data to work with
         emergencyStop(true); // sends stats
@@ -188,17 +184,7 @@ void updateState() {
       if (com_decodeNext(&timestamp, &cmd, &lData, &rData) == true) {
 
         #ifdef RVR_DEBUG
-          Serial.println();
-          Serial.print("cmd:"); // debug
-          Serial.print(cmd, HEX);
-          Serial.print(" lData:");
-          Serial.print(lData, HEX);
-          Serial.print(" rData:");
-          Serial.print(rData, HEX);
-          Serial.print(" time:");
-          Serial.print(timestamp, HEX);
-          Serial.print(" navQueue:");
-          Serial.println(navigationQueue.count());
+          TRACE(TRACE_CMD, TRACE_PACK_CMD(cmd, lData), rData);
         #endif
         
         switch (cmd) {
@@ -207,12 +193,13 @@ void updateState() {
             break;*/
             
           case 0xA: // Navigation Data
-            thePacket.timestamp = timestamp;
-            thePacket.leftPower = lData;
-            thePacket.rightPower = rData;
-            navigationQueue.enqueue(thePacket);
+            queueNav(timestamp, lData, rData);
             light_lightGreen();
             break;
+
+          case CLOCK_CMD: // Clock sync answer from rover 1
+            syncClock(timestamp, lData, rData);
+            break;
         }
       }
       break;
@@ -222,13 +209,9 @@ void updateState() {
     //------------------------------------------------------------------
     case STATE_LEFT: // turning left
       // check the navigation queue
-      if (!navigationQueue.isEmpty()) {
-        thePacket = navigationQueue.peek();
-        long comparison = millis() + masterOffset - thePacket.timestamp;
-        if (comparison >= 0) { // is the next target now (or in the past)?
-          navigationQueue.dequeue(); // remove it from queue
+      if (!nav_isEmpty()) {
+        if (nav_getDue(&thePacket)) // is the next target now (or in the past)?
           executeNav(thePacket.leftPower, thePacket.rightPower);
-        }
       }
       else { // no navigation data to work with
         emergencyStop(true); // sends stats
@@ -250,17 +233,7 @@ void updateState() {
       if (com_decodeNext(&timestamp, &cmd, &lData, &rData) == true) {
 
         #ifdef RVR_DEBUG
-          Serial.println();
-          Serial.print("cmd:"); // debug
-          Serial.print(cmd, HEX);
-          Serial.print(" lData:");
-          Serial.print(lData, HEX);
-          Serial.print(" rData:");
-          Serial.print(rData, HEX);
-          Serial.print(" time:");
-          Serial.print(timestamp, HEX);
-          Serial.print(" navQueue:");
-          Serial.println(navigationQueue.count());
+          TRACE(TRACE_CMD, TRACE_PACK_CMD(cmd, lData), rData);
         #endif
         
         switch (cmd) {
@@ -269,12 +242,13 @@ void updateState() {
             break;*/
 
           case 0xA: // Navigation Data
-            thePacket.timestamp = timestamp;
-            thePacket.leftPower = lData;
-            thePacket.rightPower = rData;
-            navigationQueue.enqueue(thePacket);
+            queueNav(timestamp, lData, rData);
             light_turnLeft();
             break;
+
+          case CLOCK_CMD: // Clock sync answer from rover 1
+            syncClock(timestamp, lData, rData);
+            break;
         }
       }
       break;
@@ -284,13 +258,9 @@ void updateState() {
     //------------------------------------------------------------------
     case STATE_RIGHT: // turning right
       // check the navigation queue
-      if (!navigationQueue.isEmpty()) {
-        thePacket = navigationQueue.peek();
-        long comparison = millis() + masterOffset - thePacket.timestamp;
-        if (comparison >= 0) { // is the next target now (or in the past)?
-          navigationQueue.dequeue(); // remove it from queue
+      if (!nav_isEmpty()) {
+        if (nav_getDue(&thePacket)) // is the next target now (or in the past)?
           executeNav(thePacket.leftPower, thePacket.rightPower);
-        }
       }
       else { // no navigation data to work with
         emergencyStop(true); // sends stats
@@ -312,17 +282,7 @@ void updateState() {
       if (com_decodeNext(&timestamp, &cmd, &lData, &rData) == true) {
 
         #ifdef RVR_DEBUG
-          Serial.println();
-          Serial.print("cmd:"); // debug
-          Serial.print(cmd, HEX);
-          Serial.print(" lData:");
-          Serial.print(lData, HEX);
-          Serial.print(" rData:");
-          Serial.print(rData, HEX);
-          Serial.print(" time:");
-          Serial.print(timestamp, HEX);
-          Serial.print(" navQueue:");
-          Serial.println(navigationQueue.count());
+          TRACE(TRACE_CMD, TRACE_PACK_CMD(cmd, lData), rData);
         #endif
         
         switch (cmd) {
@@ -331,12 +291,13 @@ void updateState() {
             break;*/
 
           case 0xA: // Navigation Data
-            thePacket.timestamp = timestamp;
-            thePacket.leftPower = lData;
-            thePacket.rightPower = rData;
-            navigationQueue.enqueue(thePacket);
+            queueNav(timestamp, lData, rData);
             light_turnRight();
             break;
+
+          case CLOCK_CMD: // Clock sync answer from rover 1
+            syncClock(timestamp, lData, rData);
+            break;
         }
       }
       break;
@@ -360,17 +321,7 @@ void updateState() {
         while (com_decodeNext(&timestamp, &cmd, &lData, &rData) == true) { // keep decoding
 
           #ifdef RVR_DEBUG
-            Serial.println();
-            Serial.print("cmd:"); // debug
-            Serial.print(cmd, HEX);
-            Serial.print(" lData:");
-            Serial.print(lData, HEX);
-            Serial.print(" rData:");
-            Serial.print(rData, HEX);
-            Serial.print(" time:");
-            Serial.print(timestamp, HEX);
-            Serial.print(" navQueue:");
-            Serial.println(navigationQueue.count());
+            TRACE(TRACE_CMD, TRACE_PACK_CMD(cmd, lData), rData);
           #endif
           
           switch (cmd) {
@@ -380,10 +331,7 @@ void updateState() {
   
             case 0xA: // Navigation Data
               enterReadyState();
-              thePacket.timestamp = timestamp;
-              thePacket.leftPower = lData;
-              thePacket.rightPower = rData;
-              navigationQueue.enqueue(thePacket);
+              queueNav(timestamp, lData, rData);
               break;
               
             case 0x2: // Forward
@@ -435,17 +383,7 @@ void updateState() {
         while (com_decodeNext(&timestamp, &cmd, &lData, &rData) == true) { // keep decoding
 
           #ifdef RVR_DEBUG
-            Serial.println();
-            Serial.print("cmd:"); // debug
-            Serial.print(cmd, HEX);
-            Serial.print(" lData:");
-            Serial.print(lData, HEX);
-            Serial.print(" rData:");
-            Serial.print(rData, HEX);
-            Serial.print(" time:");
-            Serial.print(timestamp, HEX);
-            Serial.print(" navQueue:");
-            Serial.println(navigationQueue.count());
+            TRACE(TRACE_CMD, TRACE_PACK_CMD(cmd, lData), rData);
           #endif
           
           switch (cmd) {
@@ -475,10 +413,7 @@ void updateState() {
   
             case 0xA: // Navigation Data
               enterReadyState();
-              thePacket.timestamp = timestamp;
-              thePacket.leftPower = lData;
-              thePacket.rightPower = rData;
-              navigationQueue.enqueue(thePacket);
+              queueNav(timestamp, lData, rData);
               break;
           }
           
@@ -501,24 +436,26 @@ void updateState() {
 // the motor speeds, and enters the appropriate state.
 //----------------------------------------------------------------------
 void executeNav(int leftPower, int rightPower) {
-  move_setTarget(leftPower, rightPower);
-  if (leftPower == rightPower) {
-    if (leftPower == 0)
+  switch (nav_execute(leftPower, rightPower)) {
+    case NAV_STOP:
       enterStopState(true); // sends stats
-    else
+      break;
+
+    case NAV_STRAIGHT:
       enterStraightState();
-  }
-  else if (leftPower > rightPower) {
-    enterRightState();
-  }
-  else {
-    enterLeftState();
+      break;
+
+    case NAV_RIGHT:
+      enterRightState();
+      break;
+
+    case NAV_LEFT:
+      enterLeftState();
+      break;
   }
 
   #ifdef RVR_DEBUG
-    Serial.println("State after execNav: " + String(currentState));
-    Serial.println("lPower: " + String(move_getTargetLeft()) + " rPower: " +
-        String(move_getTargetRight()));
+    TRACE(TRACE_TARGETS, move_getTargetLeft(), move_getTargetRight());
   #endif
 }
 
@@ -580,12 +517,44 @@ void enterStopState(bool stats) {
   com_emptyQueue();
 
   // empty navigation queue
-  while (!navigationQueue.isEmpty())
-    navigationQueue.dequeue();
+  nav_emptyQueue();
 
-  // send stats to master
-  if (stats)
+  // send stats and loop times to master
+  if (stats) {
     com_sendStatistics64(true); // stats with ack(s) to master - no retry
+    PROF_SEND(true); // loop times with ack(s) to master - no retry
+    TRACE_DUMP(); // binary, for Host/trace/tracedump, only with a TRACE_PORT
+  }
+}
+
+//----------------------------------------------------------------------
+// queueNav() -- Adds a target to the replay buffer, a drop is counted
+// for the stats frame.
+//----------------------------------------------------------------------
+void queueNav(unsigned long timestamp, int leftPower, int rightPower) {
+  if (!nav_enqueue(timestamp, leftPower, rightPower))
+    com_noteQueueDrop(COM_QUEUE_NAV);
+}
+
+//----------------------------------------------------------------------
+// requestClock() -- Sends a clock sync request to rover 1 when one is
+// due.
+//----------------------------------------------------------------------
+void requestClock() {
+  int seq = clock_request();
+  if (seq == CLOCK_NONE)
+    return;
+
+  com_encodeSlavePacket(CLOCK_CMD, seq, CLOCK_REQUEST);
+  com_sendSlave64(false); // no ack, a lost request is just not answered
+}
+
+//----------------------------------------------------------------------
+// syncClock() -- Takes the sample of a clock sync answer from rover 1.
+//----------------------------------------------------------------------
+void syncClock(unsigned long timestamp, int seq, int hold) {
+  if (clock_update(timestamp, seq, hold, millis() - com_getDecodedAge()))
+    com_setClockOffset(clock_getOffset(millis())); // for the latency histograms
 }
 
 //----------------------------------------------------------------------
@@ -596,15 +565,16 @@ void enterStopState(bool stats) {
 void emergencyStop(bool stats) {
   // stop
   move_fullStop();
-  light_lightPurple();
+  light_lightRed();
+  light_blink(LIGHT_LAYER_ALERT, LIGHT_PURPLE, LIGHT_CLEAR, 200, 3); // over the red
+  light_flush(); // purple right away, the rest plays from loop()
 
   // clear payloads 
   com_emptyPayload(true); // slave payload
   com_emptyPayload(false); // master payload
 
   // empty navigation queue
-  while (!navigationQueue.isEmpty())
-    navigationQueue.dequeue();
+  nav_emptyQueue();
   
   // estop other rover if we are not already stopped
   if (currentState != STATE_STOP) {
@@ -620,7 +590,8 @@ void emergencyStop(bool stats) {
   if (stats) {
     com_sendStatistics64(true); // stats with ack(s) to master - no rety
     com_resetStatistics();
+    PROF_SEND(true); // loop times with ack(s) to master - no retry
+    PROF_RESET();
+    TRACE_DUMP(); // binary, for Host/trace/tracedump, only with a TRACE_PORT
   }
-  delay(100);
-  light_lightRed();
 }
@@ -0,0 +1,97 @@
+//----------------------------- latency.c -----------------------------
+// Filename:      	latency.c
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Log-linear (HDR style) latency histograms. See
+//					latency.h.
+//------------------------------ Includes  ----------------------------
+#include "latency.h"
+
+#include <time.h>
+
+//----------------------------------------------------------------------
+// bucketOf ------- Index of the bucket counting a value.
+// Preconditions:   v < 2^LAT_MAX_BITS.
+// Postconditions:  Returns an index below LAT_BUCKETS.
+//----------------------------------------------------------------------
+static int bucketOf(uint32_t v) {
+	if (v < 2 * LAT_SUB_BUCKETS)
+		return v;
+
+	// shift so the top LAT_SUB_BITS + 1 bits remain
+	int shift = (31 - __builtin_clz(v)) - LAT_SUB_BITS;
+	return shift * LAT_SUB_BUCKETS + (v >> shift);
+}
+
+//----------------------------------------------------------------------
+// highestOf ------ Highest value counted by a bucket.
+// Preconditions:   index < LAT_BUCKETS.
+// Postconditions:  Returns the upper bound of the bucket.
+//----------------------------------------------------------------------
+static uint32_t highestOf(int index) {
+	if (index < 2 * LAT_SUB_BUCKETS)
+		return index;
+
+	int shift = index / LAT_SUB_BUCKETS - 1;
+	uint32_t sub = index - shift * LAT_SUB_BUCKETS;
+	return ((sub + 1) << shift) - 1;
+}
+
+//----------------------------------------------------------------------
+// lat_now -------- Monotonic time in nanoseconds.
+// Preconditions:   None.
+// Postconditions:  Returns the current CLOCK_MONOTONIC time.
+//----------------------------------------------------------------------
+uint64_t lat_now(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+//----------------------------------------------------------------------
+// lat_record ----- Counts one value.
+// Preconditions:   h was zeroed before first use.
+// Postconditions:  The matching bucket and the summary are updated.
+//----------------------------------------------------------------------
+void lat_record(struct LatHist *h, uint64_t micros) {
+	uint32_t v = micros < (1ULL << LAT_MAX_BITS) ? micros : (1UL << LAT_MAX_BITS) - 1;
+
+	h->counts[bucketOf(v)]++;
+	if (h->total == 0 || v < h->min)
+		h->min = v;
+	if (v > h->max)
+		h->max = v;
+	h->total++;
+	h->sum += v;
+}
+
+//----------------------------------------------------------------------
+// lat_percentile - Value at or below which q of the recorded values
+//					fall (0 <= q <= 1).
+// Preconditions:   None.
+// Postconditions:  Returns the highest value equivalent to the bucket
+//					holding the percentile (never above max), 0 if
+//					nothing was recorded.
+//----------------------------------------------------------------------
+uint32_t lat_percentile(const struct LatHist *h, double q) {
+	if (h->total == 0)
+		return 0;
+
+	// rank of the value wanted, 1 based
+	uint64_t rank = (uint64_t)(q * h->total);
+	if (rank < q * h->total)
+		rank++;
+	if (rank < 1)
+		rank = 1;
+
+	uint64_t seen = 0;
+	for (int i = 0; i < LAT_BUCKETS; i++) {
+		seen += h->counts[i];
+		if (seen >= rank) {
+			uint32_t v = highestOf(i);
+			return v < h->max ? v : h->max;
+		}
+	}
+	return h->max;
+}
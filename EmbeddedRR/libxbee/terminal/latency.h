@@ -0,0 +1,58 @@
+//----------------------------- latency.h -----------------------------
+// Filename:      	latency.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Log-linear (HDR style) latency histograms in
+//					microseconds. Values below 2 * LAT_SUB_BUCKETS are
+//					counted exactly; above that every power of two is
+//					split into LAT_SUB_BUCKETS buckets, so any recorded
+//					value is reported within 1 / LAT_SUB_BUCKETS (~3%)
+//					from 1 us up to 2^31 us with a fixed 3.5 KB of
+//					counts and no allocation when recording.
+//------------------------------ Includes  ----------------------------
+#ifndef _latency_h_
+#define _latency_h_
+
+#include <stdint.h>
+
+// Configuration
+#define LAT_SUB_BITS 5
+#define LAT_SUB_BUCKETS (1 << LAT_SUB_BITS)
+#define LAT_MAX_BITS 31		// values are clamped to 2^31 - 1 us (~36 min)
+#define LAT_BUCKETS ((LAT_MAX_BITS - LAT_SUB_BITS + 1) * LAT_SUB_BUCKETS)
+
+struct LatHist {
+	uint32_t counts[LAT_BUCKETS];
+	uint64_t total;			// values recorded
+	uint64_t sum;			// for the mean
+	uint32_t min;
+	uint32_t max;
+	uint32_t timeouts;		// attempts that never completed
+};
+
+//----------------------------------------------------------------------
+// lat_now -------- Monotonic time in nanoseconds.
+// Preconditions:   None.
+// Postconditions:  Returns the current CLOCK_MONOTONIC time.
+//----------------------------------------------------------------------
+uint64_t lat_now(void);
+
+//----------------------------------------------------------------------
+// lat_record ----- Counts one value.
+// Preconditions:   h was zeroed before first use.
+// Postconditions:  The matching bucket and the summary are updated.
+//----------------------------------------------------------------------
+void lat_record(struct LatHist *h, uint64_t micros);
+
+//----------------------------------------------------------------------
+// lat_percentile - Value at or below which q of the recorded values
+//					fall (0 <= q <= 1).
+// Preconditions:   None.
+// Postconditions:  Returns the highest value equivalent to the bucket
+//					holding the percentile (never above max), 0 if
+//					nothing was recorded.
+//----------------------------------------------------------------------
+uint32_t lat_percentile(const struct LatHist *h, double q);
+
+#endif
@@ -0,0 +1,178 @@
+//----------------------------- logscan.c -----------------------------
+// Filename:      	logscan.c
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Offline scanner for telemetry logs recorded by the
+//					terminal. The log is mmapped and walked in place.
+//					Usage: logscan [-d] [-c cmd] log
+//					  -d      dump every roverPacket
+//					  -c cmd  only dump packets with command cmd (hex)
+//					Without -d a per-rover summary is displayed.
+//------------------------------ Includes  ----------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "telemetry.h"
+
+#define MAX_SOURCES 16
+
+// Per source address counters
+struct SourceStats {
+	uint8_t addr64[8];
+	unsigned long frames;
+	unsigned long packets;
+	unsigned long cmds[16];		// packets per command
+	unsigned long rssiSum;
+	uint8_t rssiMin;
+	uint8_t rssiMax;
+};
+
+//----------------------------------------------------------------------
+// findSource ----- Finds or adds the stats slot for an address.
+// Preconditions:   sources has room for MAX_SOURCES entries.
+// Postconditions:  Returns the slot or NULL if all slots are used.
+//----------------------------------------------------------------------
+struct SourceStats *findSource(struct SourceStats *sources, int *count, const uint8_t addr64[8]) {
+	for (int i = 0; i < *count; i++) {
+		if (memcmp(sources[i].addr64, addr64, 8) == 0)
+			return &sources[i];
+	}
+	
+	if (*count == MAX_SOURCES)
+		return NULL;
+	
+	struct SourceStats *s = &sources[(*count)++];
+	memset(s, 0, sizeof(*s));
+	memcpy(s->addr64, addr64, 8);
+	s->rssiMin = 0xFF;
+	return s;
+}
+
+//----------------------------------------------------------------------
+// main ----------- Maps the log and displays a dump or summary.
+// Preconditions:   None.
+// Postconditions:  Returns 0 on success.
+//----------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+	int dump = 0;
+	int filter = -1;
+	int opt;
+	
+	while ((opt = getopt(argc, argv, "dc:")) != -1) {
+		switch (opt) {
+			case 'd':
+				dump = 1;
+				break;
+			case 'c':
+				filter = strtol(optarg, NULL, 16) & 0x0F;
+				dump = 1;
+				break;
+			default:
+				fprintf(stderr, "Usage: %s [-d] [-c cmd] log\n", argv[0]);
+				return 1;
+		}
+	}
+	if (optind >= argc) {
+		fprintf(stderr, "Usage: %s [-d] [-c cmd] log\n", argv[0]);
+		return 1;
+	}
+	
+	// map the whole log
+	const char *path = argv[optind];
+	int fd = open(path, O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) != 0) {
+		perror(path);
+		return 1;
+	}
+	if ((size_t)st.st_size < sizeof(struct TelemetryHeader)) {
+		fprintf(stderr, "%s: too short for a telemetry log\n", path);
+		return 1;
+	}
+	
+	const uint8_t *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED) {
+		perror("mmap");
+		return 1;
+	}
+	madvise((void *)map, st.st_size, MADV_SEQUENTIAL);
+	close(fd);
+	
+	const struct TelemetryHeader *header = (const struct TelemetryHeader *)map;
+	if (memcmp(header->magic, TLM_MAGIC, sizeof(TLM_MAGIC)) != 0 || header->version != TLM_VERSION ||
+			header->recordSize != sizeof(struct TelemetryRecord)) {
+		fprintf(stderr, "%s: not a telemetry log of this version\n", path);
+		return 1;
+	}
+	
+	const struct TelemetryRecord *records = (const struct TelemetryRecord *)(map + sizeof(*header));
+	size_t count = (st.st_size - sizeof(*header)) / sizeof(struct TelemetryRecord);
+	if ((st.st_size - sizeof(*header)) % sizeof(struct TelemetryRecord) != 0)
+		fprintf(stderr, "%s: ignoring a partial record at the end\n", path);
+	
+	struct SourceStats sources[MAX_SOURCES];
+	int sourceCount = 0;
+	
+	for (size_t i = 0; i < count; i++) {
+		const struct TelemetryRecord *rec = &records[i];
+		struct SourceStats *s = findSource(sources, &sourceCount, rec->addr64);
+		double t = (rec->hostTime - records[0].hostTime) / 1e9;
+		
+		if (s != NULL) {
+			s->frames++;
+			s->rssiSum += rec->rssi;
+			if (rec->rssi < s->rssiMin)
+				s->rssiMin = rec->rssi;
+			if (rec->rssi > s->rssiMax)
+				s->rssiMax = rec->rssi;
+		}
+		
+		// decode rover packet one at a time
+		for (int j = 0; j + 7 <= rec->dataLen; j += 7) {
+			unsigned long timestamp;
+			unsigned char cmd;
+			short lData, rData;
+			
+			tlm_decodePacket(&rec->data[j], &timestamp, &cmd, &lData, &rData);
+			if (timestamp == 0)
+				break;
+			
+			if (s != NULL) {
+				s->packets++;
+				s->cmds[cmd]++;
+			}
+			
+			if (dump && (filter < 0 || filter == cmd)) {
+				printf("%10.3f %02X%02X%02X%02X%02X%02X%02X%02X rssi -%2u %08lX cmd 0x%X l %5i r %5i\n",
+						t, rec->addr64[0], rec->addr64[1], rec->addr64[2], rec->addr64[3],
+						rec->addr64[4], rec->addr64[5], rec->addr64[6], rec->addr64[7],
+						rec->rssi, timestamp, cmd, lData, rData);
+			}
+		}
+	}
+	
+	if (!dump) {
+		double span = count > 1 ? (records[count - 1].hostTime - records[0].hostTime) / 1e9 : 0.0;
+		printf("%zu frames over %.3f s\n", count, span);
+		for (int i = 0; i < sourceCount; i++) {
+			struct SourceStats *s = &sources[i];
+			printf("%02X%02X%02X%02X %02X%02X%02X%02X: %lu frames, %lu packets, rssi -%u/-%.1f/-%u dBm (min/avg/max)\n",
+					s->addr64[0], s->addr64[1], s->addr64[2], s->addr64[3],
+					s->addr64[4], s->addr64[5], s->addr64[6], s->addr64[7],
+					s->frames, s->packets, s->rssiMin, (double)s->rssiSum / s->frames, s->rssiMax);
+			for (int c = 0; c < 16; c++) {
+				if (s->cmds[c] > 0)
+					printf("\tcmd 0x%X: %lu\n", c, s->cmds[c]);
+			}
+		}
+	}
+	
+	munmap((void *)map, st.st_size);
+	return 0;
+}
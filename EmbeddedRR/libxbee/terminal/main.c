@@ -23,8 +23,23 @@
 // Project Team:  	EmbeddedRR
 // Group Members: 	Robert Griswold and Ryu Muthui
 // Date:          	2 Dec 2016
-// Description:   	Console terminal for two xbee arduino rovers. See 
+// Description:   	Console terminal for xbee arduino rovers. See 
 //					help section for more information.
+//					Usage: main [-d device] [-r roster] [-l telemetry.log] [script | -]
+//					The local xbee is opened on -d (/dev/ttyUSB0 by 
+//					default), e.g. a pty of Host/emulator/xbeeemu.
+//					The rovers and their keys are read from the roster
+//					file given with -r (see roster.h), Rover1 and Rover2
+//					are used otherwise. Each rover has its own connection
+//					and callback thread; received frames are displayed
+//					and logged by a single output thread. The time from
+//					sending each frame to its ack is kept per rover and
+//					command; '=' displays the percentiles, as does exit.
+//					With an argument the terminal runs the command
+//					script (or stdin for '-') instead of reading keys.
+//					See runScript for the script format. With -l every
+//					received frame is appended to a telemetry log that
+//					can be scanned offline with logscan.
 //------------------------------ Includes  ----------------------------
 
 // Includes
@@ -32,27 +47,17 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
 #include <xbee.h>
 
-// Configuration
-#define R1_ADDR_0 0x00
-#define R1_ADDR_1 0x13
-#define R1_ADDR_2 0xA2
-#define R1_ADDR_3 0x00
-#define R1_ADDR_4 0x40
-#define R1_ADDR_5 0xF9
-#define R1_ADDR_6 0xCE
-#define R1_ADDR_7 0xDE
-
-#define R2_ADDR_0 0x00
-#define R2_ADDR_1 0x13
-#define R2_ADDR_2 0xA2
-#define R2_ADDR_3 0x00
-#define R2_ADDR_4 0x41
-#define R2_ADDR_5 0x03
-#define R2_ADDR_6 0xDA
-#define R2_ADDR_7 0x0F
+#include "telemetry.h"
+#include "roster.h"
+#include "outqueue.h"
 
+// Configuration
 // #define COM_USE_ROVER_ACKS // Whether to use xbee acks or roverpacket acks
 // Note that no additional data should be packed with a roverpacket ack
 
@@ -61,6 +66,20 @@
 // #define DEBUG_ENCODE
 
 #define MAG_STR 45
+#define XBEE_DEVICE "/dev/ttyUSB0" // default serial port of the local xbee
+
+#define MAX_SIZE 84 	// Number of bytes max in a payload (matches the rover library)
+#define MIN_SIZE 7 		// Number of bytes min for a roverPacket
+#define ACK_TIMEOUT 500 // ms to wait for a roverpacket ack in script mode
+#define SCRIPT_LINE 256 // max characters in a script line
+
+// Telemetry log written by the output thread (disabled when fd is -1)
+struct TelemetryLog tlmLog = { .fd = -1 };
+
+// Rovers with their connections, and the frames handed from the connection
+// callbacks to the output thread
+struct Roster roster;
+struct OutQueue outQueue;
 
 /* ACK error codes:
  *  01: An expected MAC acknowledgement never occured
@@ -99,7 +118,7 @@
  *	0110 0x6 Start Search/Follow
  *	0111 0x7 IR Sensor Data/Request
  *	1000 0x8 Mag Sensor Data
- *	1001 0x9 
+ *	1001 0x9 Profile Data
  *	1010 0xA Navigation Data/ACK
  *	1011 0xB Packets Encoded/Decoded
  *	1100 0xC Msgs from Master/Slave
@@ -120,7 +139,20 @@ struct RoverPacket {
 	unsigned char byte6; // data(r) 48-51 || command 52-55
 };
 
-int pendingAck = 0; // bool to indicate whether a command is still pending an ack
+// Names of the rover commands that can be sent from the keyboard
+const char *cmdNames[] = { "Emergency Stop", "Slow Stop", "Forward", "Backward",
+		"Turn Left 90", "Turn Right 90", "Start Search", "Sensor Request" };
+
+// Names of the sections timed by Rover_Profiler (PROF_LOOP - PROF_MOTORS)
+const char *profNames[] = { "loop", "sensors", "state", "motors" };
+
+// Script mode counters
+struct ScriptStats {
+	int commands;	// roverPackets encoded
+	int frames;		// xbee frames delivered
+	int retries;	// frames sent a second time
+	int failures;	// frames dropped after the retry
+};
 
 //----------------------------------------------------------------------
 // help ----------- Displays a brief explanation of the rover controller
@@ -136,19 +168,18 @@ void help(void) {
 	printf("that this feature prevents the ability to        \n");
 	printf("emergency stop until the buffer is cleared.      \n");
 	printf("------------------- Controls --------------------\n");
-	printf("\t\t< Rover 1 >\n");
-	printf("\t[Q]\t[W]\t[E]\t[R]\n");
-	printf("\tStop\tForward\tE-Stop\tSensors\n\n");
-	printf("\t[A]\t[S]\t[D]\t[F]\n");
-	printf("\tLeft\tBack\tRight\tSearch\n\n");
-	printf("\t\t< Rover 2 >\n");
-	printf("\t[U]\t[I]\t[O]\n");
-	printf("\tStop\tForward\tE-Stop\n\n");
-	printf("[H]\t[J]\t[K]\t[L]\n");
-	printf("Follow\tLeft\tBack\tRight\n\n");
+	for (int r = 0; r < roster.count; r++) {
+		const struct Rover *rover = &roster.rovers[r];
+		printf("\t\t< %s >\n", rover->name);
+		for (int cmd = 0; cmd < ROSTER_KEYS; cmd++) {
+			if (rover->keys[cmd] != '-')
+				printf("\t[%c] %s\n", toupper((unsigned char)rover->keys[cmd]), cmdNames[cmd]);
+		}
+		printf("\n");
+	}
 	printf("\t\t< General >\n");
-	printf("\t[_]\t[X]\t[?]\n");
-	printf("\tSleep\tExit\tHelp\n");
+	printf("\t[_]\t[=]\t[X]\t[?]\n");
+	printf("\tSleep\tLatency\tExit\tHelp\n");
 	printf("-------------------------------------------------\n");
 }
 
@@ -180,21 +211,25 @@ void determineDirection(short x, short z) {
 }
 
 //----------------------------------------------------------------------
-// encodePacket --- Encodes data as a roverPacket and sends it over the
-//					provided xbee connection.
-// Preconditions:   Connection is configured. lData and rData are only 
-//					10 bits each, and cmd is only 4 bits. Additional
+// profUnpack ----- Reverses the packing of a Profile Data duration: the
+//					low 5 bits are the mantissa, the high 4 the shift.
+// Preconditions:   0 <= code <= 511.
+// Postconditions:  Returns the duration in microseconds.
+//----------------------------------------------------------------------
+unsigned long profUnpack(short code) {
+	return (unsigned long)(code & 31) << (code >> 5);
+}
+
+//----------------------------------------------------------------------
+// packPacket ----- Encodes data as a roverPacket into the 7 bytes at buf.
+// Preconditions:   buf has room for MIN_SIZE bytes. lData and rData are 
+//					only 10 bits each, and cmd is only 4 bits. Additional
 //					bits will be ignored.
-// Postconditions:  Message is transmitted over the xbee connection and 
-//					pendingAck is updated if using regular xbee acks.
+// Postconditions:  buf holds the packet with a 0xFFFFFFFF timestamp.
 //----------------------------------------------------------------------
-void encodePacket(unsigned char cmd, short lData, short rData, struct xbee_con *con) {
+void packPacket(unsigned char cmd, short lData, short rData, unsigned char *buf) {
 	// initialize the packet
 	struct RoverPacket thePacket;
-	// thePacket.byte0 = 0;
-	// thePacket.byte1 = 0;
-	// thePacket.byte2 = 0;
-	// thePacket.byte3 = 0;
 	thePacket.byte4 = 0;
 	thePacket.byte5 = 0;
 	thePacket.byte6 = 0;
@@ -229,105 +264,333 @@ void encodePacket(unsigned char cmd, short lData, short rData, struct xbee_con *
 				thePacket.byte4, thePacket.byte5, thePacket.byte6);
 	#endif
 	
-	// send the packet
+	buf[0] = thePacket.byte0;
+	buf[1] = thePacket.byte1;
+	buf[2] = thePacket.byte2;
+	buf[3] = thePacket.byte3;
+	buf[4] = thePacket.byte4;
+	buf[5] = thePacket.byte5;
+	buf[6] = thePacket.byte6;
+}
+
+//----------------------------------------------------------------------
+// rttHist -------- The round trip histogram of a rover's command.
+// Preconditions:   cmd < ROSTER_COMMANDS.
+// Postconditions:  Returns the histogram, allocated on first use, or
+//					NULL if out of memory.
+//----------------------------------------------------------------------
+struct LatHist *rttHist(struct Rover *rover, unsigned char cmd) {
+	if (rover->rtt[cmd] == NULL)
+		rover->rtt[cmd] = calloc(1, sizeof(struct LatHist));
+	return rover->rtt[cmd];
+}
+
+//----------------------------------------------------------------------
+// recordRtt ------ Records the time from issuing the rover's frame to 
+//					its ack.
+// Preconditions:   sendFrame set txTime and txCmd. Main thread only.
+// Postconditions:  The sample is counted under txCmd.
+//----------------------------------------------------------------------
+void recordRtt(struct Rover *rover, uint64_t ackTime) {
+	struct LatHist *h = rttHist(rover, rover->txCmd);
+	if (h != NULL && ackTime >= rover->txTime)
+		lat_record(h, (ackTime - rover->txTime) / 1000);
+}
+
+//----------------------------------------------------------------------
+// recordTimeout -- Counts an attempt that was never acked.
+// Preconditions:   Main thread only.
+// Postconditions:  The timeout is counted under cmd.
+//----------------------------------------------------------------------
+void recordTimeout(struct Rover *rover, unsigned char cmd) {
+	struct LatHist *h = rttHist(rover, cmd & 0x0F);
+	if (h != NULL)
+		h->timeouts++;
+}
+
+//----------------------------------------------------------------------
+// collectAck ----- Records the round trip of a rover packet ack stamped
+//					by the callback.
+// Preconditions:   Main thread only.
+// Postconditions:  ackTime is consumed.
+//----------------------------------------------------------------------
+void collectAck(struct Rover *rover) {
+	if (!rover->pendingAck && rover->ackTime != 0) { // pendingAck is read first
+		recordRtt(rover, rover->ackTime);
+		rover->ackTime = 0;
+	}
+}
+
+//----------------------------------------------------------------------
+// printLatency --- Displays the round trip percentiles of every rover
+//					and command that was sent.
+// Preconditions:   Main thread only.
+// Postconditions:  Message displayed to user using printf.
+//----------------------------------------------------------------------
+void printLatency(void) {
+	#ifdef COM_USE_ROVER_ACKS
+		const char *mode = "rover packet acks";
+	#else
+		const char *mode = "xbee acks";
+	#endif
+	
+	printf("---------- Round Trip Times (%s, ms) ----------\n", mode);
+	printf("%-15s %-15s %6s %8s %8s %8s %8s %8s %5s\n", "Rover", "Command", "n",
+			"mean", "p50", "p99", "p999", "max", "lost");
+	for (int r = 0; r < roster.count; r++) {
+		for (int cmd = 0; cmd < ROSTER_COMMANDS; cmd++) {
+			const struct LatHist *h = roster.rovers[r].rtt[cmd];
+			if (h == NULL)
+				continue;
+			
+			printf("%-15s %-15s %6llu %8.2f %8.2f %8.2f %8.2f %8.2f %5u\n", roster.rovers[r].name,
+					cmd < ROSTER_KEYS ? cmdNames[cmd] : "Other", (unsigned long long)h->total,
+					h->total ? (double)h->sum / h->total / 1000.0 : 0.0,
+					lat_percentile(h, 0.50) / 1000.0, lat_percentile(h, 0.99) / 1000.0,
+					lat_percentile(h, 0.999) / 1000.0, h->max / 1000.0, h->timeouts);
+		}
+	}
+	printf("-------------------------------------------------\n");
+}
+
+//----------------------------------------------------------------------
+// sendFrame ------ Sends len bytes of packed roverPackets as a single 
+//					xbee frame over the rover's connection.
+// Preconditions:   Connection is configured. len is a multiple of 
+//					MIN_SIZE and no larger than MAX_SIZE.
+// Postconditions:  Returns 1 if the frame was transmitted (and acked 
+//					when using regular xbee acks), 0 otherwise. The rover's
+//					pendingAck is cleared and the round trip recorded on a
+//					regular ack.
+//----------------------------------------------------------------------
+int sendFrame(const unsigned char *buf, int len, struct Rover *rover) {
 	xbee_err ret;
 	unsigned char retVal;
-	if ((ret = xbee_conTx(con, &retVal, "%c%c%c%c%c%c%c", thePacket.byte0,
-				thePacket.byte1, thePacket.byte2, thePacket.byte3,
-				thePacket.byte4, thePacket.byte5, thePacket.byte6)) != XBEE_ENONE) {
+	
+	rover->txCmd = buf[6] & 0x0F;
+	rover->ackTime = 0;
+	rover->txTime = lat_now();
+	if ((ret = xbee_connTx(rover->con, &retVal, buf, len)) != XBEE_ENONE) {
         if (ret == XBEE_ETX) {
-			fprintf(stderr, "A transmission error occured. (0x%02X)\n", retVal);
+			fprintf(stderr, "%s: A transmission error occured. (0x%02X)\n", rover->name, retVal);
         } else {
-			fprintf(stderr, "An error occured. %s\n", xbee_errorToStr(ret));
+			fprintf(stderr, "%s: An error occured. %s\n", rover->name, xbee_errorToStr(ret));
         }
-	} else {
-		#ifndef COM_USE_ROVER_ACKS
-			// Regular ack received
-			pendingAck = 0;
-		#endif
+		return 0;
 	}
+	
+	#ifndef COM_USE_ROVER_ACKS
+		// Regular ack received (xbee_connTx waits for the TX status)
+		recordRtt(rover, lat_now());
+		rover->pendingAck = 0;
+	#endif
+	return 1;
+}
+
+//----------------------------------------------------------------------
+// encodePacket --- Encodes data as a roverPacket and sends it to the 
+//					rover.
+// Preconditions:   Connection is configured. lData and rData are only 
+//					10 bits each, and cmd is only 4 bits. Additional
+//					bits will be ignored.
+// Postconditions:  Message is transmitted over the rover's connection 
+//					and its pendingAck is updated if using regular xbee
+//					acks.
+//----------------------------------------------------------------------
+void encodePacket(unsigned char cmd, short lData, short rData, struct Rover *rover) {
+	unsigned char buf[MIN_SIZE];
+	packPacket(cmd, lData, rData, buf);
+	sendFrame(buf, MIN_SIZE, rover);
 }
 
 //----------------------------------------------------------------------
-// roverCallback -- Receives xbee messages and decodes the messages as 
-//					rover packets. Also sends back roverpacket acks if
-//					enabled.
+// sendRoverAck --- Returns a rover packet ack on a connection.
 // Preconditions:   Connection is configured.
-// Postconditions:  Message is received, data decoded as a rover packet
-//					and displayed to user, pendingAck is updated if 
-//					using rover packet acks, and a rocker packet ack
-//					is returned to sender if enabled.
+// Postconditions:  The ack is transmitted, errors are displayed.
+//----------------------------------------------------------------------
+void sendRoverAck(struct xbee_con *con) {
+	#ifdef DEBUG_ENCODE
+		printf("Encoded cmd: 0x%X lData: %i rData: %i", 0xA, 0, 0);
+		printf(" -> [%02X%02X%02X%02X%02X%02X%02X]\n",
+				0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x0A);
+	#endif
+	
+	xbee_err ret;
+	unsigned char retVal;
+	if ((ret = xbee_conTx(con, &retVal, "%c%c%c%c%c%c%c",
+				0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x0A)) != XBEE_ENONE) {
+		if (ret == XBEE_ETX) {
+				fprintf(stderr, "ACK: A transmission error occured. (0x%02X)\n", retVal);
+		} else {
+				fprintf(stderr, "ACK: An error occured. %s\n", xbee_errorToStr(ret));
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+// roverCallback -- Receives xbee messages on a rover's connection thread.
+//					Only the work that cannot wait is done here: the
+//					frame is stamped, a rover packet ack clears the 
+//					rover's pendingAck (and one is returned if enabled),
+//					then the frame is queued for the output thread.
+// Preconditions:   Connection is configured with its Rover as data.
+// Postconditions:  Frame is queued, or dropped and counted if the output
+//					queue is full.
 //----------------------------------------------------------------------
-// TODO: use void data not xbee_pkt
 void roverCallback(struct xbee *xbee, struct xbee_con *con, struct xbee_pkt **pkt, void **data) {
-	#ifdef DEBUG_ADDR
-		if ((*pkt)->address.addr64_enabled) {
-			printf("64-bit address: 0x%02X%02X%02X%02X 0x%02X%02X%02X%02X\n",
-						  (*pkt)->address.addr64[0], (*pkt)->address.addr64[1],
-						  (*pkt)->address.addr64[2], (*pkt)->address.addr64[3],
-						  (*pkt)->address.addr64[4], (*pkt)->address.addr64[5],
-						  (*pkt)->address.addr64[6], (*pkt)->address.addr64[7]);
+	struct Rover *rover = *data;
+	struct OutMsg msg;
+	
+	// stamp the raw frame before anything else
+	msg.type = OQ_FRAME;
+	msg.rover = rover - roster.rovers;
+	tlm_fillRecord(&msg.rec, (*pkt)->address.addr64, (*pkt)->rssi, (*pkt)->data, (*pkt)->dataLen);
+	
+	if ((*pkt)->dataLen > 0 && (*pkt)->dataLen % 7 == 0) { // require a non-empty payload divisible by 7 bytes
+		unsigned long timestamp;
+		unsigned char cmd = 0;
+		short lData, rData;
+		
+		for (int i = 0; i < (*pkt)->dataLen; i = i + 7) {
+			tlm_decodePacket(&(*pkt)->data[i], &timestamp, &cmd, &lData, &rData);
+			if (timestamp == 0) // end of the payload
+				break;
+			if (cmd == 0xA && timestamp == 0xFFFFFFFF) { // Rover ACK
+				rover->ackTime = lat_now();
+				rover->pendingAck = 0;
+			}
 		}
+		
+		#ifdef COM_USE_ROVER_ACKS
+			if (cmd != 0xA)
+				sendRoverAck(con);
+		#endif
+	}
+	else if ((*pkt)->dataLen > 0) { // statistics or histogram frame, decoded for display
+		#ifdef COM_USE_ROVER_ACKS
+			sendRoverAck(con);
+		#endif
+	}
+	
+	oq_push(&outQueue, &msg);
+}
+
+//----------------------------------------------------------------------
+// printStats ----- Displays a decoded statistics frame.
+// Preconditions:   Called from the output thread only. rover may be NULL.
+// Postconditions:  Message displayed to user using printf.
+//----------------------------------------------------------------------
+void printStats(const struct Rover *rover, const struct RoverStats *stats) {
+	printf("-------------------- %s statistics at %.3f s --------------------\n",
+			rover != NULL ? rover->name : "?", stats->millis / 1000.0);
+	printf("msgsToMaster: %u \tacksFromMaster: %u \tmsgsFromMaster: %u\n",
+			stats->msgsToMaster, stats->acksFromMaster, stats->msgsFromMaster);
+	printf("msgsToSlave: %u \tacksFromSlave: %u \tmsgsFromSlave: %u\n",
+			stats->msgsToSlave, stats->acksFromSlave, stats->msgsFromSlave);
+	printf("encodedPackets: %u \tdecodedPackets: %u \tfailedEncodes: %u\n",
+			stats->encodedPackets, stats->decodedPackets, stats->failedEncodes);
+	printf("queuedPackets: %u \tqueue max: %u \tnav queue max: %u",
+			stats->queuedPackets, stats->queueHighWater[0], stats->queueHighWater[1]);
+	if (stats->queueCapacity[1] != 0)
+		printf(" of %u", stats->queueCapacity[1]);
+	printf(" \tnav drops: %u\n", stats->queueDrops[1]);
+	printf("rssi: -%u dBm \tworst: -%u dBm\n", stats->lastRssi, stats->worstRssi);
+	printf("-------------------------------------------------\n");
+	fflush(stdout);
+}
+
+//----------------------------------------------------------------------
+// printHist ------ Displays the histograms of a histogram frame, one
+//					line each with the count per bucket.
+// Preconditions:   Called from the output thread only. rover may be NULL.
+// Postconditions:  Message displayed to user using printf.
+//----------------------------------------------------------------------
+void printHist(const struct Rover *rover, const struct RoverHist *hists, int count) {
+	for (int i = 0; i < count; i++) {
+		printf("%s %-9s cmd 0x%X ms:", rover != NULL ? rover->name : "?",
+				hists[i].kind == COM_HIST_RESIDENCE ? "residence" : "latency", hists[i].cmd);
+		for (int b = 0; b < COM_HIST_BUCKETS; b++) {
+			if (b == 0)
+				printf(" <=0:%u", hists[i].counts[b]);
+			else if (b == COM_HIST_BUCKETS - 1)
+				printf(" %u+:%u", 1u << (b - 1), hists[i].counts[b]);
+			else
+				printf(" %u:%u", 1u << (b - 1), hists[i].counts[b]);
+		}
+		printf("\n");
+	}
+	fflush(stdout);
+}
+
+//----------------------------------------------------------------------
+// displayFrame --- Logs a received frame and decodes it as rover packets
+//					for the user.
+// Preconditions:   Called from the output thread only.
+// Postconditions:  Frame is appended to the telemetry log if enabled,
+//					the rover's receive state is updated and the decoded
+//					packets are displayed.
+//----------------------------------------------------------------------
+void displayFrame(const struct OutMsg *msg) {
+	const struct TelemetryRecord *rec = &msg->rec;
+	struct Rover *rover = msg->rover >= 0 ? &roster.rovers[msg->rover] : NULL;
+	
+	if (tlmLog.fd >= 0)
+		tlm_appendRecord(&tlmLog, rec);
+	
+	if (rover != NULL) {
+		rover->framesRx++;
+		rover->lastRssi = rec->rssi;
+	}
+	
+	#ifdef DEBUG_ADDR
+		printf("64-bit address: 0x%02X%02X%02X%02X 0x%02X%02X%02X%02X\n",
+					  rec->addr64[0], rec->addr64[1], rec->addr64[2], rec->addr64[3],
+					  rec->addr64[4], rec->addr64[5], rec->addr64[6], rec->addr64[7]);
 	#endif
 	
 	#ifdef DEBUG_DATA
 		printf("rx: [");
-		for (int i = 0; i < (*pkt)->dataLen; i++) {
+		for (int i = 0; i < rec->dataLen; i++) {
 			if(i % 7 == 0 && i != 0)
 				printf("\n");
-			printf(" %02X ", (*pkt)->data[i]);
+			printf(" %02X ", rec->data[i]);
 		}
 		printf("]\n\n");
 	#endif
 		
-	if ((*pkt)->dataLen > 0 && (*pkt)->dataLen % 7 == 0) { // require a non-empty payload divisible by 7 bytes
+	struct RoverStats stats;
+	if (tlm_decodeStats(rec->data, rec->dataLen, &stats)) {
+		printStats(rover, &stats);
+		return;
+	}
+	
+	struct RoverHist hists[COM_HIST_PER_FRAME];
+	int histCount = tlm_decodeHist(rec->data, rec->dataLen, hists);
+	if (histCount > 0) {
+		printHist(rover, hists, histCount);
+		return;
+	}
+	
+	if (rec->dataLen > 0 && rec->dataLen % 7 == 0) { // require a non-empty payload divisible by 7 bytes
 		unsigned long timestamp;
-		unsigned char cmd;
+		unsigned char cmd = 0;
 		short lData, rData;
+		int profSection = -1; // section of the last Profile Data header
 		
 		// decode rover packet one at a time
-		for (int i = 0; i < (*pkt)->dataLen; i = i + 7) {
+		for (int i = 0; i < rec->dataLen; i = i + 7) {
+			tlm_decodePacket(&rec->data[i], &timestamp, &cmd, &lData, &rData);
+			
 			// Check if timestamp is 0 and ignore if so
-			if ((*pkt)->data[i + 3] == 0 && (*pkt)->data[i + 2] == 0 &&
-					(*pkt)->data[i + 1] == 0 && (*pkt)->data[i] == 0) {
+			if (timestamp == 0)
 				break;
-			}
-			
-			// timestamp 0-7, 8-15, 16-23, 24-31
-			timestamp = (*pkt)->data[i];
-			timestamp <<= 8;
-			timestamp += (*pkt)->data[i + 1];
-			timestamp <<= 8;
-			timestamp += (*pkt)->data[i + 2];
-			timestamp <<= 8;
-			timestamp += (*pkt)->data[i + 3];
-			
-			// data left 32-39, 40-41
-			lData = (*pkt)->data[i + 4];
-			lData <<= 8; // set the sign bit
-			lData >>= 6; // repeat the sign bit
-			lData += (*pkt)->data[i + 5] >> 6; // grab last 2 bits
-			
-			// data right 42-47, 48-51
-			rData = (*pkt)->data[i + 5];
-			rData <<= 10; // set the sign bit and discard first two bits
-			rData >>= 6; // repeat the sign bit
-			rData += (*pkt)->data[i + 6] >> 4; // grab last 4 bits
-			
-			// command 52-55
-			cmd = (*pkt)->data[i + 6] & 0x0F;
 			
 			// Display the sender if this isnt an ack
 			if (i == 0 && cmd != 0xA) {
-				printf("--------------------");
-				if ((*pkt)->address.addr64[6] == R1_ADDR_6 && (*pkt)->address.addr64[7] == R1_ADDR_7) {
-					printf(" Rover 1 ");
-				} else if ((*pkt)->address.addr64[6] == R2_ADDR_6 && (*pkt)->address.addr64[7] == R2_ADDR_7) {
-					printf(" Rover 2 ");
-				} else {
-					printf("---------");
-				}
-				printf("--------------------\n");
+				if (rover != NULL)
+					printf("-------------------- %s --------------------\n", rover->name);
+				else
+					printf("-------------------------------------------------\n");
 			}
 			
 			switch (cmd) {
@@ -340,13 +603,23 @@ void roverCallback(struct xbee *xbee, struct xbee_con *con, struct xbee_pkt **pk
 					determineDirection(lData, rData);
 					break;
 					
-				case 0xA: // Rover ACK
-					if (timestamp == 0xFFFFFFFF) {
-						// printf("Rover ACK received.\n");
-						pendingAck = 0;
+				case 0x9: // Profile Data, a header then the values
+					if (lData < 0) {
+						profSection = -1 - lData;
+						if (profSection < 4)
+							printf("%-8s n: %-6i", profNames[profSection], rData);
+						else
+							printf("section%i n: %-6i", profSection, rData);
+					}
+					else if (profSection >= 0) {
+						printf("mean: %lu us\tmax: %lu us\n", profUnpack(lData), profUnpack(rData));
+						profSection = -1;
 					}
 					break;
 					
+				case 0xA: // Rover ACK (handled by the callback)
+					break;
+					
 				case 0xB: // Packets Encoded/Decoded
 					printf("encodedPackets: %i\tdecodedPackets: %i\n", lData, rData);
 					break;
@@ -370,159 +643,101 @@ void roverCallback(struct xbee *xbee, struct xbee_con *con, struct xbee_pkt **pk
 			}
 		}
 		
-		#ifdef COM_USE_ROVER_ACKS
-			// send rover ack
-			if (cmd != 0xA) {
-				#ifdef DEBUG_ENCODE
-					printf("Encoded cmd: 0x%X lData: %i rData: %i", 0xA, 0, 0);
-					printf(" -> [%02X%02X%02X%02X%02X%02X%02X]\n",
-							0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x0A);
-				#endif
-				
-				xbee_err ret;
-				unsigned char retVal;
-				if ((ret = xbee_conTx(con, &retVal, "%c%c%c%c%c%c%c",
-							0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x0A)) != XBEE_ENONE) {
-					if (ret == XBEE_ETX) {
-							fprintf(stderr, "ACK: A transmission error occured. (0x%02X)\n", retVal);
-					} else {
-							fprintf(stderr, "ACK: An error occured. %s\n", xbee_errorToStr(ret));
-					}
-				}
-			}
-		#endif
-		
 		if (cmd != 0xA) {
 			printf("-------------------------------------------------\n");
 		}
 	}
+	
+	fflush(stdout);
+}
+
+//----------------------------------------------------------------------
+// outputThread --- The only thread that displays received frames or
+//					writes the telemetry log. Runs until an OQ_QUIT 
+//					message is popped. When no frame arrives it still
+//					flushes the log every TLM_FLUSH_INTERVAL seconds.
+// Preconditions:   outQueue was initialized.
+// Postconditions:  Returns NULL.
+//----------------------------------------------------------------------
+void *outputThread(void *arg) {
+	struct OutMsg msg;
+	struct timespec flushAt;
+	
+	clock_gettime(CLOCK_REALTIME, &flushAt);
+	flushAt.tv_sec += TLM_FLUSH_INTERVAL;
+	for (;;) {
+		if (oq_popUntil(&outQueue, &msg, &flushAt) != 0) {
+			// idle, write out the records of the last frames
+			if (tlmLog.fd >= 0)
+				tlm_flush(&tlmLog);
+			clock_gettime(CLOCK_REALTIME, &flushAt);
+			flushAt.tv_sec += TLM_FLUSH_INTERVAL;
+			continue;
+		}
+		if (msg.type == OQ_QUIT)
+			break;
+		displayFrame(&msg);
+	}
+	
+	return NULL;
+}
+
+//----------------------------------------------------------------------
+// sendCommand ---- Sends a command on its own to every rover in rovers
+//					and marks each as pending an ack.
+// Preconditions:   Connections are configured.
+// Postconditions:  The rovers' pendingAck and lastCmd are set and a 
+//					packet is sent to each using encodePacket.
+//----------------------------------------------------------------------
+void sendCommand(unsigned char cmd, uint32_t rovers) {
+	for (int r = 0; r < roster.count; r++) {
+		struct Rover *rover = &roster.rovers[r];
+		if (!(rovers & (1u << r)))
+			continue;
+		
+		printf("Sending %s (0x%X) command to %s...\n", cmdNames[cmd], cmd, rover->name);
+		rover->pendingAck = 1;
+		rover->lastCmd = cmd;
+		encodePacket(cmd, 0x0, 0x0, rover);
+	}
 }
 
 //----------------------------------------------------------------------
 // parseCommand --- Parses a character input to determine the desired
 //					rover packet to send.
 // Preconditions:   Connections are configured.
-// Postconditions:  An appropriate packet is sent using encodePacket on 
-//					the desired connection, and pendingAck is set true.
+// Postconditions:  An appropriate packet is sent with sendCommand to 
+//					each rover the key is bound on.
 //----------------------------------------------------------------------
 // returns whether or not a character was sucessfully parsed
-int parseCommand(char input, struct xbee_con *r1Connection, struct xbee_con *r2Connection) {
+int parseCommand(char input) {
 	int retVal = 1;
-	pendingAck = 1;
+	unsigned char cmd;
+	uint32_t rovers;
+	
+	if (roster_keyToCommand(&roster, input, &cmd, &rovers)) {
+		sendCommand(cmd, rovers);
+		return retVal;
+	}
 	
 	switch(input) {
-		case 'e': // Emergency Stop - Rover 1
-		case 'E':
-			printf("Sending Emergency Stop (0x%X) command to Rover 1...\n", 0x0);
-			encodePacket(0x0, 0x0, 0x0, r1Connection);
-			break;
-
-		case 'q': // Slow Stop - Rover 1
-		case 'Q':
-			printf("Sending Slow Stop (0x%X) command to Rover 1...\n", 0x1);
-			encodePacket(0x1, 0x0, 0x0, r1Connection);
-			break;
-		  
-		case 'w': // Forward - Rover 1
-		case 'W':
-			printf("Sending Forward (0x%X) command to Rover 1...\n", 0x2);
-			encodePacket(0x2, 0x0, 0x0, r1Connection);
-			break;
-
-		case 's': // Backward - Rover 1
-		case 'S':
-			printf("Sending Backward (0x%X) command to Rover 1...\n", 0x3);
-			encodePacket(0x3, 0x0, 0x0, r1Connection);
-			break;
-
-		case 'a': // Turn Left 90 - Rover 1
-		case 'A':
-			printf("Sending Turn Left 90 (0x%X) command to Rover 1...\n", 0x4);
-			encodePacket(0x4, 0x0, 0x0, r1Connection);
-			break;
-
-		case 'd': // Turn Right 90 - Rover 1
-		case 'D':
-			printf("Sending Turn Right 90 (0x%X) command to Rover 1...\n", 0x5);
-			encodePacket(0x5, 0x0, 0x0, r1Connection);
-			break;
-
-		case 'f': // Start Search - Rover 1
-		case 'F':
-			printf("Sending Start Search (0x%X) command to Rover 1...\n", 0x6);
-			encodePacket(0x6, 0x0, 0x0, r1Connection);
-			break;
-
-		case 'r': // Sensor Request - Rover 1
-		case 'R':
-			printf("Sending Sensor Request (0x%X) command to Rover 1...\n", 0x7);
-			encodePacket(0x7, 0x0, 0x0, r1Connection);
-			break;
-			
-		case 'o': // Emergency Stop - Rover 2
-		case 'O':
-			printf("Sending Emergency Stop (0x%X) command to Rover 2...\n", 0x0);
-			encodePacket(0x0, 0x0, 0x0, r2Connection);
-			break;
-
-		case 'u': // Slow Stop - Rover 2
-		case 'U':
-			printf("Sending Slow Stop (0x%X) command to Rover 2...\n", 0x1);
-			encodePacket(0x1, 0x0, 0x0, r2Connection);
-			break;
-		  
-		case 'i': // Forward - Rover 2
-		case 'I':
-			printf("Sending Forward (0x%X) command to Rover 2...\n", 0x2);
-			encodePacket(0x2, 0x0, 0x0, r2Connection);
-			break;
-
-		case 'k': // Backward - Rover 2
-		case 'K':
-			printf("Sending Backward (0x%X) command to Rover 2...\n", 0x3);
-			encodePacket(0x3, 0x0, 0x0, r2Connection);
-			break;
-
-		case 'j': // Turn Left 90 - Rover 2
-		case 'J':
-			printf("Sending Turn Left 90 (0x%X) command to Rover 2...\n", 0x4);
-			encodePacket(0x4, 0x0, 0x0, r2Connection);
-			break;
-
-		case 'l': // Turn Right 90 - Rover 2
-		case 'L':
-			printf("Sending Turn Right 90 (0x%X) command to Rover 2...\n", 0x5);
-			encodePacket(0x5, 0x0, 0x0, r2Connection);
-			break;
-
-		case 'h': // Start Follow - Rover 2
-		case 'H':
-			printf("Sending Start Search (0x%X) command to Rover 2...\n", 0x6);
-			encodePacket(0x6, 0x0, 0x0, r2Connection);
-			break;
-
-		/*case 'p': // Sensor Request - Rover 2
-		case 'P':
-			printf("Sending Sensor Request (0x%X) command to Rover 2...\n", input);
-			encodePacket(0x7, 0x0, 0x0, r2Connection);
-			break;*/
-			
 		case '?': // Help
 		case '/':
 			help();
-			pendingAck = 0;
 			break;
 			
 		case ' ': // NOP
 		case '_':
 			printf("Sleep...\n");
-			pendingAck = 0;
+			break;
+			
+		case '=': // Round trip times
+			printLatency();
 			break;
 			
 		case 'x': // Exit
 		case 'X':
 			printf("Exiting...\n");
-			pendingAck = 0;
 			retVal = -1;
 			break;
 			
@@ -535,125 +750,457 @@ int parseCommand(char input, struct xbee_con *r1Connection, struct xbee_con *r2C
 }
 
 //----------------------------------------------------------------------
-// main ----------- Performs initialization of xbee and handles main 
-//					logic of the rover controller to take input from user.
-// Preconditions:   None.
+// elapsedMs ------ Milliseconds between start and now on the monotonic
+//					clock.
+// Preconditions:   start was read from CLOCK_MONOTONIC.
+// Postconditions:  Returns the elapsed time in milliseconds.
+//----------------------------------------------------------------------
+double elapsedMs(const struct timespec *start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+//----------------------------------------------------------------------
+// sleepUntil ----- Sleeps until due milliseconds after start. Returns 
+//					immediately if that time has already passed.
+// Preconditions:   start was read from CLOCK_MONOTONIC.
 // Postconditions:  None.
 //----------------------------------------------------------------------
-int main(void) {
-	void *d;
-	struct xbee *xbee;
-	struct xbee_con *r1Connection;
-	struct xbee_con *r2Connection;
-	struct xbee_conAddress r1Address;
-	struct xbee_conAddress r2Address;
-	xbee_err ret;
-	char lastCmd = '!';
-	
-	// setup local xbee connection
-	if ((ret = xbee_setup(&xbee, "xbee1", "/dev/ttyUSB0", 9600)) != XBEE_ENONE) {
-		printf("ret: %d (%s)\n", ret, xbee_errorToStr(ret));
-		return ret;
+void sleepUntil(const struct timespec *start, long due) {
+	struct timespec target = *start;
+	target.tv_sec += due / 1000;
+	target.tv_nsec += (due % 1000) * 1000000L;
+	if (target.tv_nsec >= 1000000000L) {
+		target.tv_sec++;
+		target.tv_nsec -= 1000000000L;
 	}
 	
-	// create the memory address objects
-	memset(&r1Address, 0, sizeof(r1Address));
-	r1Address.addr64_enabled = 1;
-	r1Address.addr64[0] = R1_ADDR_0;
-	r1Address.addr64[1] = R1_ADDR_1;
-	r1Address.addr64[2] = R1_ADDR_2;
-	r1Address.addr64[3] = R1_ADDR_3;
-	r1Address.addr64[4] = R1_ADDR_4;
-	r1Address.addr64[5] = R1_ADDR_5;
-	r1Address.addr64[6] = R1_ADDR_6;
-	r1Address.addr64[7] = R1_ADDR_7;
-	
-	memset(&r2Address, 0, sizeof(r2Address));
-	r2Address.addr64_enabled = 1;
-	r2Address.addr64[0] = R2_ADDR_0;
-	r2Address.addr64[1] = R2_ADDR_1;
-	r2Address.addr64[2] = R2_ADDR_2;
-	r2Address.addr64[3] = R2_ADDR_3;
-	r2Address.addr64[4] = R2_ADDR_4;
-	r2Address.addr64[5] = R2_ADDR_5;
-	r2Address.addr64[6] = R2_ADDR_6;
-	r2Address.addr64[7] = R2_ADDR_7;
-	
-	// open a connection with rover 1 and attach to the callback
-	if ((ret = xbee_conNew(xbee, &r1Connection, "64-bit Data", &r1Address)) != XBEE_ENONE) {
-		xbee_log(xbee, -1, "xbee_conNew() for rover 1 returned: %d (%s)", ret, xbee_errorToStr(ret));
-		return ret;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, NULL) != 0); // restart if interrupted
+}
+
+//----------------------------------------------------------------------
+// waitForAcks ---- Waits up to ACK_TIMEOUT ms for the callback to clear
+//					the pendingAck of every rover in the mask when using
+//					rover packet acks. The rovers share the timeout, so
+//					their acks are collected in parallel.
+// Preconditions:   pendingAck was set before each frame was sent.
+// Postconditions:  Returns the mask of rovers that are still waiting for
+//					their ack. Round trips are recorded for the others.
+//----------------------------------------------------------------------
+uint32_t waitForAcks(uint32_t rovers) {
+	uint32_t waiting = 0;
+	
+	#ifdef COM_USE_ROVER_ACKS
+		struct timespec delay = { 0, 1000000L }; // 1ms
+		for (int i = 0; i < ACK_TIMEOUT; i++) {
+			int pending = 0;
+			for (int r = 0; r < roster.count && !pending; r++)
+				pending = (rovers & (1u << r)) && roster.rovers[r].pendingAck;
+			if (!pending)
+				break;
+			nanosleep(&delay, NULL);
+		}
+	#endif
+	
+	for (int r = 0; r < roster.count; r++) {
+		if (!(rovers & (1u << r)))
+			continue;
+		#ifdef COM_USE_ROVER_ACKS
+			collectAck(&roster.rovers[r]);
+		#endif
+		if (roster.rovers[r].pendingAck)
+			waiting |= 1u << r;
 	}
+	return waiting;
+}
 
-	if ((ret = xbee_conDataSet(r1Connection, xbee, NULL)) != XBEE_ENONE) {
-		xbee_log(xbee, -1, "xbee_conDataSet() for rover 1 returned: %d", ret);
-		return ret;
+//----------------------------------------------------------------------
+// flushRovers ---- Transmits the roverPackets coalesced for each rover in
+//					the mask as a single frame per rover, retrying once 
+//					like the interactive mode does. Every frame is sent 
+//					before the acks are collected, so one slow or missing
+//					rover costs a single ACK_TIMEOUT instead of one each.
+//					With regular xbee acks xbee_connTx still waits for 
+//					each TX status in turn.
+// Preconditions:   Connections are configured.
+// Postconditions:  The lens of the masked rovers are reset to 0 and the
+//					rovers' state and stats are updated.
+//----------------------------------------------------------------------
+void flushRovers(unsigned char frames[][MAX_SIZE], int *lens, uint32_t rovers,
+		const struct timespec *start, struct ScriptStats *stats) {
+	uint32_t pending = 0;
+	
+	for (int r = 0; r < roster.count; r++) {
+		if (!(rovers & (1u << r)) || lens[r] == 0)
+			continue;
+		printf("[%9.3f] %s: %i command(s) in a %i byte frame\n", elapsedMs(start) / 1000.0,
+				roster.rovers[r].name, lens[r] / MIN_SIZE, lens[r]);
+		pending |= 1u << r;
 	}
+	
+	for (int attempt = 0; attempt < 2 && pending; attempt++) {
+		uint32_t sent = 0;
+		
+		// issue every frame first ...
+		for (int r = 0; r < roster.count; r++) {
+			struct Rover *rover = &roster.rovers[r];
+			if (!(pending & (1u << r)))
+				continue;
+			
+			if (attempt > 0) {
+				printf("RETRY: %s\n", rover->name);
+				stats->retries++;
+				rover->retries++;
+				recordTimeout(rover, rover->txCmd);
+			}
+			
+			rover->pendingAck = 1;
+			if (sendFrame(frames[r], lens[r], rover))
+				sent |= 1u << r;
+		}
+		
+		// ... then collect their acks
+		sent &= ~waitForAcks(sent);
+		for (int r = 0; r < roster.count; r++) {
+			if (!(sent & (1u << r)))
+				continue;
+			stats->frames++;
+			lens[r] = 0;
+			pending &= ~(1u << r);
+		}
+	}
+	
+	for (int r = 0; r < roster.count; r++) {
+		struct Rover *rover = &roster.rovers[r];
+		if (!(pending & (1u << r)))
+			continue;
+		recordTimeout(rover, rover->txCmd);
+		rover->pendingAck = 0;
+		stats->failures++;
+		rover->failures++;
+		lens[r] = 0;
+	}
+}
 
-	if ((ret = xbee_conCallbackSet(r1Connection, roverCallback, NULL)) != XBEE_ENONE) {
-		xbee_log(xbee, -1, "xbee_conCallbackSet() for rover 1 returned: %d", ret);
-		return ret;
+//----------------------------------------------------------------------
+// flushFrame ----- Transmits the frame coalesced for one rover.
+// Preconditions:   Connection is configured.
+// Postconditions:  lens[r] is reset to 0.
+//----------------------------------------------------------------------
+void flushFrame(unsigned char frames[][MAX_SIZE], int *lens, int r,
+		const struct timespec *start, struct ScriptStats *stats) {
+	flushRovers(frames, lens, 1u << r, start, stats);
+}
+
+//----------------------------------------------------------------------
+// flushAll ------- Transmits the frames coalesced for every rover.
+// Preconditions:   Connections are configured.
+// Postconditions:  Every len is reset to 0.
+//----------------------------------------------------------------------
+void flushAll(unsigned char frames[][MAX_SIZE], int *lens, const struct timespec *start,
+		struct ScriptStats *stats) {
+	flushRovers(frames, lens, ~0u, start, stats);
+}
+
+//----------------------------------------------------------------------
+// runScript ------ Runs a command script instead of the keyboard loop.
+//					Each line holds an optional timing annotation and then
+//					any number of command keys (same keys as help()):
+//						@<ms>	send at <ms> after the script started
+//						+<ms>	send <ms> after the previous line
+//					Lines without an annotation are sent with the previous
+//					line. Everything after '#' is a comment and a line 
+//					with only an annotation just waits. 'X' ends the script
+//					and '=' displays the round trip times so far.
+//					Consecutive commands to the same rover that are due at
+//					the same time are coalesced into one frame of up to 
+//					MAX_SIZE bytes, and frames are sent as soon as they are
+//					due instead of one second apart. An Emergency Stop is 
+//					always sent on its own so it is not held back.
+// Preconditions:   Connections are configured.
+// Postconditions:  Returns 0 if every frame was delivered, 1 otherwise.
+//					A summary with the total run time is displayed.
+//----------------------------------------------------------------------
+int runScript(FILE *script) {
+	unsigned char frames[ROSTER_MAX][MAX_SIZE];
+	int lens[ROSTER_MAX] = { 0 };
+	struct ScriptStats stats = { 0, 0, 0, 0 };
+	struct timespec start;
+	char line[SCRIPT_LINE];
+	int lineNum = 0;
+	long due = 0; // ms after start that the pending frames are due
+	int done = 0;
+	
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	
+	while (!done && fgets(line, sizeof(line), script) != NULL) {
+		char *p = line;
+		char *comment = strchr(line, '#');
+		long next = due;
+		lineNum++;
+		
+		if (comment != NULL)
+			*comment = '\0';
+		while (isspace((unsigned char)*p))
+			p++;
+		
+		// timing annotation
+		if (*p == '@' || *p == '+') {
+			char *end;
+			long ms = strtol(p + 1, &end, 10);
+			if (end == p + 1 || ms < 0) {
+				fprintf(stderr, "Script line %i: bad timing annotation, line skipped\n", lineNum);
+				continue;
+			}
+			next = (*p == '@') ? ms : due + ms;
+			p = end;
+		}
+		
+		// a new time sends what was queued for the old one
+		if (next != due) {
+			flushAll(frames, lens, &start, &stats);
+			due = next;
+			sleepUntil(&start, due);
+		}
+		
+		for (; *p != '\0' && !done; p++) {
+			unsigned char cmd;
+			uint32_t rovers;
+			
+			if (isspace((unsigned char)*p))
+				continue;
+			
+			if (*p == 'x' || *p == 'X') {
+				done = 1;
+				break;
+			}
+			
+			if (*p == '=') {
+				printLatency();
+				continue;
+			}
+			
+			if (!roster_keyToCommand(&roster, *p, &cmd, &rovers)) {
+				fprintf(stderr, "Script line %i: unknown command '%c' ignored\n", lineNum, *p);
+				continue;
+			}
+			
+			for (int r = 0; r < roster.count; r++) {
+				if (!(rovers & (1u << r)))
+					continue;
+				
+				if (cmd == 0x0 || lens[r] + MIN_SIZE > MAX_SIZE) // estop alone or frame is full
+					flushFrame(frames, lens, r, &start, &stats);
+				
+				packPacket(cmd, 0x0, 0x0, frames[r] + lens[r]);
+				lens[r] += MIN_SIZE;
+				stats.commands++;
+				
+				if (cmd == 0x0)
+					flushFrame(frames, lens, r, &start, &stats);
+			}
+		}
 	}
 	
-	// open a connection with rover 2 and attach to the callback
-	if ((ret = xbee_conNew(xbee, &r2Connection, "64-bit Data", &r2Address)) != XBEE_ENONE) {
-		xbee_log(xbee, -1, "xbee_conNew() for rover 2 returned: %d (%s)", ret, xbee_errorToStr(ret));
+	flushAll(frames, lens, &start, &stats);
+	
+	printf("Script: %i commands in %i frames (%i retries, %i failed) over %.3f s\n",
+			stats.commands, stats.frames, stats.retries, stats.failures, elapsedMs(&start) / 1000.0);
+	
+	return stats.failures == 0 ? 0 : 1;
+}
+
+//----------------------------------------------------------------------
+// connectRover --- Opens a 64-bit data connection with a rover and 
+//					attaches the callback with the rover as its data.
+// Preconditions:   xbee is setup.
+// Postconditions:  Returns XBEE_ENONE and sets rover->con on success.
+//----------------------------------------------------------------------
+xbee_err connectRover(struct xbee *xbee, struct Rover *rover) {
+	struct xbee_conAddress address;
+	xbee_err ret;
+	
+	// create the memory address object
+	memset(&address, 0, sizeof(address));
+	address.addr64_enabled = 1;
+	memcpy(address.addr64, rover->addr64, sizeof(address.addr64));
+	
+	// open a connection with the rover and attach to the callback
+	if ((ret = xbee_conNew(xbee, &rover->con, "64-bit Data", &address)) != XBEE_ENONE) {
+		xbee_log(xbee, -1, "xbee_conNew() for %s returned: %d (%s)", rover->name, ret, xbee_errorToStr(ret));
 		return ret;
 	}
 
-	if ((ret = xbee_conDataSet(r2Connection, xbee, NULL)) != XBEE_ENONE) {
-		xbee_log(xbee, -1, "xbee_conDataSet() for rover 2 returned: %d", ret);
+	if ((ret = xbee_conDataSet(rover->con, rover, NULL)) != XBEE_ENONE) {
+		xbee_log(xbee, -1, "xbee_conDataSet() for %s returned: %d", rover->name, ret);
 		return ret;
 	}
 
-	if ((ret = xbee_conCallbackSet(r2Connection, roverCallback, NULL)) != XBEE_ENONE) {
-		xbee_log(xbee, -1, "xbee_conCallbackSet() for rover 2 returned: %d", ret);
+	if ((ret = xbee_conCallbackSet(rover->con, roverCallback, NULL)) != XBEE_ENONE) {
+		xbee_log(xbee, -1, "xbee_conCallbackSet() for %s returned: %d", rover->name, ret);
 		return ret;
 	}
 	
 	#ifdef COM_USE_ROVER_ACKS
 		// disable normal acks
 		struct xbee_conSettings settings;
-		if (xbee_conSettings(r1Connection, NULL, &settings) != XBEE_ENONE) return -1;
-		settings.disableAck = 1;
-		if (xbee_conSettings(r1Connection, &settings, NULL) != XBEE_ENONE) return -1;
-		if (xbee_conSettings(r2Connection, NULL, &settings) != XBEE_ENONE) return -1;
+		if ((ret = xbee_conSettings(rover->con, NULL, &settings)) != XBEE_ENONE) return ret;
 		settings.disableAck = 1;
-		if (xbee_conSettings(r2Connection, &settings, NULL) != XBEE_ENONE) return -1;
+		if ((ret = xbee_conSettings(rover->con, &settings, NULL)) != XBEE_ENONE) return ret;
 	#endif
 	
+	return XBEE_ENONE;
+}
+
+//----------------------------------------------------------------------
+// shutdownTerminal Shuts down xbee (stopping the callbacks), drains and
+//					stops the output thread and closes the telemetry log.
+// Preconditions:   The output thread was started.
+// Postconditions:  Round trip times and the frames lost to a full output
+//					queue are reported.
+//----------------------------------------------------------------------
+void shutdownTerminal(struct xbee *xbee, pthread_t output) {
+	struct OutMsg quit = { .type = OQ_QUIT };
+	
+	xbee_shutdown(xbee);
+	while (oq_push(&outQueue, &quit) != 0)
+		sched_yield();
+	pthread_join(output, NULL);
+	
+	printLatency();
+	for (int r = 0; r < roster.count; r++) {
+		for (int cmd = 0; cmd < ROSTER_COMMANDS; cmd++)
+			free(roster.rovers[r].rtt[cmd]);
+	}
+	
+	if (atomic_load(&outQueue.drops) > 0)
+		fprintf(stderr, "%lu received frames were dropped (output queue full)\n",
+				atomic_load(&outQueue.drops));
+	
+	oq_destroy(&outQueue);
+	tlm_close(&tlmLog);
+}
+
+//----------------------------------------------------------------------
+// main ----------- Performs initialization of xbee and handles main 
+//					logic of the rover controller to take input from user,
+//					or runs the script named by the first argument.
+//					Loads the roster if -r is given (Rover1 and Rover2
+//					otherwise) and opens the telemetry log if -l is given.
+// Preconditions:   None.
+// Postconditions:  None.
+//----------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+	FILE *script = NULL;
+	const char *device = XBEE_DEVICE;
+	struct xbee *xbee;
+	pthread_t output;
+	xbee_err ret;
+	int opt;
+	
+	roster_default(&roster);
+	
+	// parse options
+	while ((opt = getopt(argc, argv, "d:l:r:")) != -1) {
+		switch (opt) {
+			case 'd':
+				device = optarg;
+				break;
+			case 'l':
+				if (tlm_open(&tlmLog, optarg) != 0)
+					return 1;
+				break;
+			case 'r':
+				if (roster_load(&roster, optarg) != 0) {
+					tlm_close(&tlmLog);
+					return 1;
+				}
+				break;
+			default:
+				fprintf(stderr, "Usage: %s [-d device] [-r roster] [-l telemetry.log] [script | -]\n", argv[0]);
+				tlm_close(&tlmLog);
+				return 1;
+		}
+	}
+	
+	// open the command script if one was given
+	if (optind < argc) {
+		script = (strcmp(argv[optind], "-") == 0) ? stdin : fopen(argv[optind], "r");
+		if (script == NULL) {
+			perror(argv[optind]);
+			tlm_close(&tlmLog);
+			return 1;
+		}
+	}
+	
+	// start the output thread before any callback can run
+	if (oq_init(&outQueue) != 0 || pthread_create(&output, NULL, outputThread, NULL) != 0) {
+		fprintf(stderr, "Unable to start the output thread\n");
+		tlm_close(&tlmLog);
+		return 1;
+	}
+	
+	// setup local xbee connection
+	if ((ret = xbee_setup(&xbee, "xbee1", device, 9600)) != XBEE_ENONE) {
+		printf("ret: %d (%s)\n", ret, xbee_errorToStr(ret));
+		return ret;
+	}
+	
+	// one connection (and callback thread) per rover
+	for (int r = 0; r < roster.count; r++) {
+		if ((ret = connectRover(xbee, &roster.rovers[r])) != XBEE_ENONE)
+			return ret;
+	}
+	
+	// run the script instead of reading keys
+	if (script != NULL) {
+		int scriptRet = runScript(script);
+		if (script != stdin)
+			fclose(script);
+		shutdownTerminal(xbee, output);
+		return scriptRet;
+	}
+	
 	help(); // display help
 	
 	// continually check callback status and read input from user
 	for (;;) {
-		void *p;
+		void *p = NULL;
 
-		if ((ret = xbee_conCallbackGet(r1Connection, (xbee_t_conCallback*)&p)) != XBEE_ENONE) {
-			xbee_log(xbee, -1, "xbee_conCallbackGet() for rover 1 returned: %d", ret);
-			return ret;
-		}
-		
-		if ((ret = xbee_conCallbackGet(r2Connection, (xbee_t_conCallback*)&p)) != XBEE_ENONE) {
-			xbee_log(xbee, -1, "xbee_conCallbackGet() for rover 2 returned: %d", ret);
-			return ret;
+		for (int r = 0; r < roster.count; r++) {
+			if ((ret = xbee_conCallbackGet(roster.rovers[r].con, (xbee_t_conCallback*)&p)) != XBEE_ENONE) {
+				xbee_log(xbee, -1, "xbee_conCallbackGet() for %s returned: %d", roster.rovers[r].name, ret);
+				return ret;
+			}
 		}
 
 		if (p == NULL) break;
 		
-		// Check if ack was received for last message and retry once if not
-		if (pendingAck) {
-			pendingAck = 0;
-			printf("RETRY: ");
-			parseCommand(lastCmd, r1Connection, r2Connection);
-		}	
+		// Check if ack was received for each rover's last message and retry once if not
+		for (int r = 0; r < roster.count; r++) {
+			struct Rover *rover = &roster.rovers[r];
+			#ifdef COM_USE_ROVER_ACKS
+				collectAck(rover);
+			#endif
+			if (rover->pendingAck) {
+				printf("RETRY: ");
+				rover->retries++;
+				recordTimeout(rover, rover->lastCmd);
+				sendCommand(rover->lastCmd, 1u << r);
+				rover->pendingAck = 0;
+			}
+		}
 		
 		// Read input from user
 		int goodParse = 0;
 		while (!goodParse) {
-			scanf("%c", &lastCmd);
-			goodParse = parseCommand(lastCmd, r1Connection, r2Connection);
+			char input;
+			if (scanf("%c", &input) != 1)
+				input = 'x'; // end of input
+			goodParse = parseCommand(input);
 			if (goodParse == -1) { // exit request
-				xbee_shutdown(xbee);
+				shutdownTerminal(xbee, output);
 				exit(0);
 			}
 		}
@@ -661,17 +1208,14 @@ int main(void) {
 		sleep(1);
 	}
 
-	if ((ret = xbee_conEnd(r1Connection)) != XBEE_ENONE) {
-		xbee_log(xbee, -1, "xbee_conEnd() for rover 1 returned: %d", ret);
-		return ret;
-	}
-	
-	if ((ret = xbee_conEnd(r2Connection)) != XBEE_ENONE) {
-		xbee_log(xbee, -1, "xbee_conEnd() for rover 2 returned: %d", ret);
-		return ret;
+	for (int r = 0; r < roster.count; r++) {
+		if ((ret = xbee_conEnd(roster.rovers[r].con)) != XBEE_ENONE) {
+			xbee_log(xbee, -1, "xbee_conEnd() for %s returned: %d", roster.rovers[r].name, ret);
+			return ret;
+		}
 	}
 
-	xbee_shutdown(xbee);
+	shutdownTerminal(xbee, output);
 
 	return 0;
 }
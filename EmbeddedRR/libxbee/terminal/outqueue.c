@@ -0,0 +1,128 @@
+//---------------------------- outqueue.c -----------------------------
+// Filename:      	outqueue.c
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Bounded lock-free multi-producer single-consumer
+//					queue of received frames. See outqueue.h.
+//------------------------------ Includes  ----------------------------
+#include "outqueue.h"
+
+#include <stdlib.h>
+#include <errno.h>
+#include <sched.h>
+
+//----------------------------------------------------------------------
+// oq_init -------- Allocates a queue of OQ_CAPACITY slots.
+// Preconditions:   None.
+// Postconditions:  Returns 0 on success, -1 if out of memory.
+//----------------------------------------------------------------------
+int oq_init(struct OutQueue *q) {
+	q->slots = malloc(OQ_CAPACITY * sizeof(struct OutSlot));
+	if (q->slots == NULL)
+		return -1;
+
+	// slot i is free for the producer that claims position i
+	for (size_t i = 0; i < OQ_CAPACITY; i++)
+		atomic_init(&q->slots[i].seq, i);
+
+	q->mask = OQ_CAPACITY - 1;
+	atomic_init(&q->head, 0);
+	q->tail = 0;
+	atomic_init(&q->drops, 0);
+	sem_init(&q->ready, 0, 0);
+	return 0;
+}
+
+//----------------------------------------------------------------------
+// oq_push -------- Copies msg into the queue. Safe to call from any
+//					number of threads and never blocks.
+// Preconditions:   q was initialized.
+// Postconditions:  Returns 0 if queued, -1 if the queue was full (the
+//					message is dropped and counted).
+//----------------------------------------------------------------------
+int oq_push(struct OutQueue *q, const struct OutMsg *msg) {
+	size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+	struct OutSlot *slot;
+
+	// claim a position
+	for (;;) {
+		slot = &q->slots[pos & q->mask];
+		size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+		intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+		if (diff == 0) { // free, try to take it
+			if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + 1,
+					memory_order_relaxed, memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0) { // consumer has not read this slot yet
+			atomic_fetch_add_explicit(&q->drops, 1, memory_order_relaxed);
+			return -1;
+		}
+		else { // another producer took it
+			pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+		}
+	}
+
+	// fill and publish
+	slot->msg = *msg;
+	atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+	sem_post(&q->ready);
+	return 0;
+}
+
+//----------------------------------------------------------------------
+// take ----------- Copies out the message at the tail.
+// Preconditions:   A sem_wait on q->ready succeeded. Only one thread pops.
+// Postconditions:  msg holds the oldest published message and its slot
+//					is free for producers.
+//----------------------------------------------------------------------
+static void take(struct OutQueue *q, struct OutMsg *msg) {
+	struct OutSlot *slot = &q->slots[q->tail & q->mask];
+
+	// a later producer may have published first, wait for this slot
+	while (atomic_load_explicit(&slot->seq, memory_order_acquire) != q->tail + 1)
+		sched_yield();
+
+	*msg = slot->msg;
+	atomic_store_explicit(&slot->seq, q->tail + OQ_CAPACITY, memory_order_release);
+	q->tail++;
+}
+
+//----------------------------------------------------------------------
+// oq_pop --------- Waits for the next message and copies it to msg.
+// Preconditions:   q was initialized. Only one thread pops.
+// Postconditions:  msg holds the oldest published message.
+//----------------------------------------------------------------------
+void oq_pop(struct OutQueue *q, struct OutMsg *msg) {
+	while (sem_wait(&q->ready) != 0); // restart if interrupted
+	take(q, msg);
+}
+
+//----------------------------------------------------------------------
+// oq_popUntil ---- Like oq_pop, but gives up at deadline.
+// Preconditions:   q was initialized. Only one thread pops. deadline is
+//					CLOCK_REALTIME, as for sem_timedwait.
+// Postconditions:  Returns 0 and msg holds the oldest published message,
+//					or returns -1 if none was published by deadline.
+//----------------------------------------------------------------------
+int oq_popUntil(struct OutQueue *q, struct OutMsg *msg, const struct timespec *deadline) {
+	while (sem_timedwait(&q->ready, deadline) != 0) {
+		if (errno != EINTR) // ETIMEDOUT
+			return -1;
+	}
+	take(q, msg);
+	return 0;
+}
+
+//----------------------------------------------------------------------
+// oq_destroy ----- Frees the queue.
+// Preconditions:   No thread is using q.
+// Postconditions:  q->slots is NULL.
+//----------------------------------------------------------------------
+void oq_destroy(struct OutQueue *q) {
+	sem_destroy(&q->ready);
+	free(q->slots);
+	q->slots = NULL;
+}
@@ -0,0 +1,91 @@
+//---------------------------- outqueue.h -----------------------------
+// Filename:      	outqueue.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Bounded lock-free multi-producer single-consumer
+//					queue of received frames. Every libxbee connection
+//					callback thread pushes into it and a single output
+//					thread pops, so callbacks never wait on stdout or
+//					the telemetry log. Each slot carries a sequence
+//					number that tells producers and the consumer whose
+//					turn it is; a full queue drops the frame and counts
+//					it instead of blocking the radio.
+//------------------------------ Includes  ----------------------------
+#ifndef _outqueue_h_
+#define _outqueue_h_
+
+#include <stdatomic.h>
+#include <semaphore.h>
+#include <time.h>
+
+#include "telemetry.h"
+
+// Configuration
+#define OQ_CAPACITY 1024		// slots, must be a power of two
+
+// Message types
+#define OQ_FRAME 0				// a received frame
+#define OQ_QUIT 1				// ends the output thread
+
+// One queued message
+struct OutMsg {
+	int type;					// OQ_FRAME or OQ_QUIT
+	int rover;					// roster index of the sender, -1 if unknown
+	struct TelemetryRecord rec;	// frame stamped when it was received
+};
+
+struct OutSlot {
+	atomic_size_t seq;
+	struct OutMsg msg;
+};
+
+struct OutQueue {
+	struct OutSlot *slots;
+	size_t mask;
+	atomic_size_t head;			// next slot claimed by a producer
+	size_t tail;				// next slot read by the consumer
+	atomic_ulong drops;			// messages lost to a full queue
+	sem_t ready;				// counts published messages
+};
+
+//----------------------------------------------------------------------
+// oq_init -------- Allocates a queue of OQ_CAPACITY slots.
+// Preconditions:   None.
+// Postconditions:  Returns 0 on success, -1 if out of memory.
+//----------------------------------------------------------------------
+int oq_init(struct OutQueue *q);
+
+//----------------------------------------------------------------------
+// oq_push -------- Copies msg into the queue. Safe to call from any
+//					number of threads and never blocks.
+// Preconditions:   q was initialized.
+// Postconditions:  Returns 0 if queued, -1 if the queue was full (the
+//					message is dropped and counted).
+//----------------------------------------------------------------------
+int oq_push(struct OutQueue *q, const struct OutMsg *msg);
+
+//----------------------------------------------------------------------
+// oq_pop --------- Waits for the next message and copies it to msg.
+// Preconditions:   q was initialized. Only one thread pops.
+// Postconditions:  msg holds the oldest published message.
+//----------------------------------------------------------------------
+void oq_pop(struct OutQueue *q, struct OutMsg *msg);
+
+//----------------------------------------------------------------------
+// oq_popUntil ---- Like oq_pop, but gives up at deadline.
+// Preconditions:   q was initialized. Only one thread pops. deadline is
+//					CLOCK_REALTIME, as for sem_timedwait.
+// Postconditions:  Returns 0 and msg holds the oldest published message,
+//					or returns -1 if none was published by deadline.
+//----------------------------------------------------------------------
+int oq_popUntil(struct OutQueue *q, struct OutMsg *msg, const struct timespec *deadline);
+
+//----------------------------------------------------------------------
+// oq_destroy ----- Frees the queue.
+// Preconditions:   No thread is using q.
+// Postconditions:  q->slots is NULL.
+//----------------------------------------------------------------------
+void oq_destroy(struct OutQueue *q);
+
+#endif
@@ -0,0 +1,189 @@
+//----------------------------- roster.c ------------------------------
+// Filename:      	roster.c
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Rovers known to the terminal. See roster.h for the
+//					config file format.
+//------------------------------ Includes  ----------------------------
+#include "roster.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// Keys kept by the terminal and the script format
+#define RESERVED_KEYS "?/_=xX#@+-"
+
+//----------------------------------------------------------------------
+// addRover ------- Appends a rover with the given address and keys.
+// Preconditions:   roster has room for another rover.
+// Postconditions:  The rover is added with no connection or pending ack.
+//----------------------------------------------------------------------
+static void addRover(struct Roster *roster, const char *name, uint64_t addr, const char *keys) {
+	struct Rover *rover = &roster->rovers[roster->count++];
+	memset(rover, 0, sizeof(*rover));
+
+	snprintf(rover->name, sizeof(rover->name), "%s", name);
+	for (int i = 7; i >= 0; i--) {
+		rover->addr64[i] = addr & 0xFF;
+		addr >>= 8;
+	}
+
+	memset(rover->keys, '-', ROSTER_KEYS);
+	for (int i = 0; i < ROSTER_KEYS && keys[i] != '\0'; i++)
+		rover->keys[i] = tolower((unsigned char)keys[i]);
+}
+
+//----------------------------------------------------------------------
+// roster_default - Fills the roster with the two project rovers and the
+//					original key bindings.
+// Preconditions:   roster points to valid memory.
+// Postconditions:  roster holds Rover1 and Rover2.
+//----------------------------------------------------------------------
+void roster_default(struct Roster *roster) {
+	roster->count = 0;
+	addRover(roster, "Rover1", 0x0013A20040F9CEDEULL, "eqwsadfr");
+	addRover(roster, "Rover2", 0x0013A2004103DA0FULL, "ouikjlh-");
+}
+
+//----------------------------------------------------------------------
+// roster_load ---- Reads a roster config file (see roster.h).
+// Preconditions:   roster points to valid memory.
+// Postconditions:  Returns 0 on success. On failure -1 is returned and
+//					the error is displayed with its line number.
+//----------------------------------------------------------------------
+int roster_load(struct Roster *roster, const char *path) {
+	char line[ROSTER_LINE];
+	int lineNum = 0;
+	FILE *fp = fopen(path, "r");
+	if (fp == NULL) {
+		perror(path);
+		return -1;
+	}
+
+	roster->count = 0;
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		char name[ROSTER_LINE], addr[ROSTER_LINE], keys[ROSTER_LINE], extra[ROSTER_LINE];
+		char *comment = strchr(line, '#');
+		char *end;
+		lineNum++;
+
+		if (comment != NULL)
+			*comment = '\0';
+
+		keys[0] = '\0';
+		int fields = sscanf(line, "%s %s %s %s", name, addr, keys, extra);
+		if (fields <= 0)
+			continue; // blank line
+
+		if (fields < 2 || fields > 3) {
+			fprintf(stderr, "%s:%i: expected <name> <address> [keys]\n", path, lineNum);
+			goto fail;
+		}
+
+		if (roster->count == ROSTER_MAX) {
+			fprintf(stderr, "%s:%i: more than %i rovers\n", path, lineNum, ROSTER_MAX);
+			goto fail;
+		}
+
+		if (strlen(name) >= ROSTER_NAME) {
+			fprintf(stderr, "%s:%i: name longer than %i characters\n", path, lineNum, ROSTER_NAME - 1);
+			goto fail;
+		}
+
+		uint64_t address = strtoull(addr, &end, 16);
+		if (*end != '\0' || strlen(addr) > 18) {
+			fprintf(stderr, "%s:%i: bad address '%s'\n", path, lineNum, addr);
+			goto fail;
+		}
+
+		if (strlen(keys) > ROSTER_KEYS) {
+			fprintf(stderr, "%s:%i: more than %i keys\n", path, lineNum, ROSTER_KEYS);
+			goto fail;
+		}
+
+		addRover(roster, name, address, keys);
+		struct Rover *added = &roster->rovers[roster->count - 1];
+
+		// keys must not clash with the terminal or with another command
+		for (int cmd = 0; cmd < ROSTER_KEYS; cmd++) {
+			char key = added->keys[cmd];
+			if (key == '-')
+				continue;
+			if (strchr(RESERVED_KEYS, key) != NULL || !isgraph((unsigned char)key)) {
+				fprintf(stderr, "%s:%i: key '%c' is reserved\n", path, lineNum, key);
+				goto fail;
+			}
+
+			for (int r = 0; r < roster->count; r++) {
+				for (int other = 0; other < ROSTER_KEYS; other++) {
+					if (roster->rovers[r].keys[other] == key && other != cmd) {
+						fprintf(stderr, "%s:%i: key '%c' is bound to command 0x%X and 0x%X\n",
+								path, lineNum, key, other, cmd);
+						goto fail;
+					}
+				}
+			}
+		}
+
+		if (roster_find(roster, added->addr64) != roster->count - 1) {
+			fprintf(stderr, "%s:%i: address of %s is already in the roster\n", path, lineNum, name);
+			goto fail;
+		}
+	}
+
+	fclose(fp);
+	if (roster->count == 0) {
+		fprintf(stderr, "%s: no rovers\n", path);
+		return -1;
+	}
+	return 0;
+
+fail:
+	fclose(fp);
+	return -1;
+}
+
+//----------------------------------------------------------------------
+// roster_find ---- Looks up a rover by its 64-bit address.
+// Preconditions:   None.
+// Postconditions:  Returns the roster index or -1 if not found.
+//----------------------------------------------------------------------
+int roster_find(const struct Roster *roster, const uint8_t addr64[8]) {
+	for (int i = 0; i < roster->count; i++) {
+		if (memcmp(roster->rovers[i].addr64, addr64, 8) == 0)
+			return i;
+	}
+	return -1;
+}
+
+//----------------------------------------------------------------------
+// roster_keyToCommand Looks up the rover command bound to a key (case
+//					insensitive).
+// Preconditions:   cmd and rovers point to valid memory.
+// Postconditions:  Returns the number of rovers the key is bound on,
+//					sets cmd and sets bit i of rovers for each roster
+//					index i bound. Returns 0 if the key is unbound.
+//----------------------------------------------------------------------
+int roster_keyToCommand(const struct Roster *roster, char key, unsigned char *cmd,
+		uint32_t *rovers) {
+	int found = 0;
+	key = tolower((unsigned char)key);
+	*rovers = 0;
+
+	if (key == '-')
+		return 0;
+
+	for (int r = 0; r < roster->count; r++) {
+		const char *bound = memchr(roster->rovers[r].keys, key, ROSTER_KEYS);
+		if (bound != NULL) {
+			*cmd = bound - roster->rovers[r].keys;
+			*rovers |= 1u << r;
+			found++;
+		}
+	}
+
+	return found;
+}
@@ -0,0 +1,92 @@
+//----------------------------- roster.h ------------------------------
+// Filename:      	roster.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Rovers known to the terminal. Each rover has its own
+//					xbee connection, pending ack and retry state and the
+//					keys that send it commands. The roster is read from
+//					a config file with one rover per line:
+//						<name> <64-bit address in hex> [keys]
+//					keys holds up to ROSTER_KEYS characters bound to the
+//					commands 0x0 to 0x7 in order (E-Stop, Stop, Forward,
+//					Back, Left, Right, Start, Sensors), '-' leaves a
+//					command unbound. A key may be bound on several rovers
+//					(to the same command) to send it to all of them.
+//					Everything after '#' is a comment.
+//------------------------------ Includes  ----------------------------
+#ifndef _roster_h_
+#define _roster_h_
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "latency.h"
+
+// Configuration
+#define ROSTER_MAX 16		// rovers in a roster (bits in a rover mask)
+#define ROSTER_NAME 16		// characters in a name including terminator
+#define ROSTER_KEYS 8		// commands 0x0 - 0x7 can be bound to keys
+#define ROSTER_LINE 256		// max characters in a roster line
+#define ROSTER_COMMANDS 16	// 4-bit roverPacket commands
+
+struct xbee_con;
+
+// One rover and the state of its connection
+struct Rover {
+	char name[ROSTER_NAME];
+	uint8_t addr64[8];			// msb first
+	char keys[ROSTER_KEYS + 1];	// key for each command, '-' if unbound
+	struct xbee_con *con;
+	atomic_int pendingAck;		// a command is still waiting for its ack
+	unsigned char lastCmd;		// last command sent, repeated on a retry
+	unsigned char txCmd;		// first command of the frame in flight
+	uint64_t txTime;			// lat_now() when the frame was issued
+	uint64_t ackTime;			// lat_now() of the rover ack (callback only)
+	struct LatHist *rtt[ROSTER_COMMANDS]; // round trip times by command
+	int retries;				// frames sent a second time
+	int failures;				// frames dropped after the retry
+	unsigned long framesRx;		// frames received (output thread only)
+	uint8_t lastRssi;			// rssi of the last frame (output thread only)
+};
+
+struct Roster {
+	int count;
+	struct Rover rovers[ROSTER_MAX];
+};
+
+//----------------------------------------------------------------------
+// roster_default - Fills the roster with the two project rovers and the
+//					original key bindings.
+// Preconditions:   roster points to valid memory.
+// Postconditions:  roster holds Rover1 and Rover2.
+//----------------------------------------------------------------------
+void roster_default(struct Roster *roster);
+
+//----------------------------------------------------------------------
+// roster_load ---- Reads a roster config file (see above).
+// Preconditions:   roster points to valid memory.
+// Postconditions:  Returns 0 on success. On failure -1 is returned and
+//					the error is displayed with its line number.
+//----------------------------------------------------------------------
+int roster_load(struct Roster *roster, const char *path);
+
+//----------------------------------------------------------------------
+// roster_find ---- Looks up a rover by its 64-bit address.
+// Preconditions:   None.
+// Postconditions:  Returns the roster index or -1 if not found.
+//----------------------------------------------------------------------
+int roster_find(const struct Roster *roster, const uint8_t addr64[8]);
+
+//----------------------------------------------------------------------
+// roster_keyToCommand Looks up the rover command bound to a key (case
+//					insensitive).
+// Preconditions:   cmd and rovers point to valid memory.
+// Postconditions:  Returns the number of rovers the key is bound on,
+//					sets cmd and sets bit i of rovers for each roster
+//					index i bound. Returns 0 if the key is unbound.
+//----------------------------------------------------------------------
+int roster_keyToCommand(const struct Roster *roster, char key, unsigned char *cmd,
+		uint32_t *rovers);
+
+#endif
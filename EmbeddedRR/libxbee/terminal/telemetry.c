@@ -0,0 +1,310 @@
+//---------------------------- telemetry.c ----------------------------
+// Filename:      	telemetry.c
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Append-only binary log of every frame received by
+//					the terminal. See telemetry.h for the file format.
+//------------------------------ Includes  ----------------------------
+#include "telemetry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+//----------------------------------------------------------------------
+// writeAll ------- Writes len bytes, retrying short writes.
+// Preconditions:   fd is open for writing.
+// Postconditions:  Returns 0 on success, -1 on error.
+//----------------------------------------------------------------------
+static int writeAll(int fd, const void *buf, size_t len) {
+	const char *p = buf;
+	while (len > 0) {
+		ssize_t n = write(fd, p, len);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		p += n;
+		len -= n;
+	}
+	return 0;
+}
+
+//----------------------------------------------------------------------
+// flushLocked ---- Writes out the buffer with a single write and syncs.
+// Preconditions:   log->lock is held.
+// Postconditions:  Buffer is empty and lastFlush is updated.
+//----------------------------------------------------------------------
+static void flushLocked(struct TelemetryLog *log) {
+	if (log->used > 0) {
+		if (writeAll(log->fd, log->buf, log->used * sizeof(struct TelemetryRecord)) != 0)
+			perror("telemetry write");
+		else if (fdatasync(log->fd) != 0)
+			perror("telemetry fdatasync");
+		log->used = 0;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &log->lastFlush);
+}
+
+//----------------------------------------------------------------------
+// tlm_open ------- Opens (or creates) a log for appending.
+// Preconditions:   None.
+// Postconditions:  Returns 0 on success. On failure -1 is returned, an
+//					error is displayed and log->fd is -1.
+//----------------------------------------------------------------------
+int tlm_open(struct TelemetryLog *log, const char *path) {
+	struct TelemetryHeader header;
+	struct stat st;
+	
+	log->fd = -1;
+	log->used = 0;
+	log->records = 0;
+	log->buf = malloc(TLM_BUFFER_RECORDS * sizeof(struct TelemetryRecord));
+	if (log->buf == NULL) {
+		fprintf(stderr, "telemetry: insufficient memory for the write buffer\n");
+		return -1;
+	}
+	
+	int fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+	if (fd < 0 || fstat(fd, &st) != 0) {
+		perror(path);
+		goto fail;
+	}
+	
+	if (st.st_size == 0) {
+		// new log, write the header
+		memset(&header, 0, sizeof(header));
+		strcpy(header.magic, TLM_MAGIC);
+		header.version = TLM_VERSION;
+		header.recordSize = sizeof(struct TelemetryRecord);
+		if (writeAll(fd, &header, sizeof(header)) != 0) {
+			perror(path);
+			goto fail;
+		}
+	}
+	else {
+		// existing log, only append records of the same format
+		if (pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+				memcmp(header.magic, TLM_MAGIC, sizeof(TLM_MAGIC)) != 0 ||
+				header.version != TLM_VERSION ||
+				header.recordSize != sizeof(struct TelemetryRecord)) {
+			fprintf(stderr, "%s: not a telemetry log of this version\n", path);
+			goto fail;
+		}
+		if ((st.st_size - sizeof(header)) % sizeof(struct TelemetryRecord) != 0) {
+			fprintf(stderr, "%s: ends with a partial record\n", path);
+			goto fail;
+		}
+	}
+	
+	pthread_mutex_init(&log->lock, NULL);
+	clock_gettime(CLOCK_MONOTONIC, &log->lastFlush);
+	log->fd = fd;
+	return 0;
+	
+fail:
+	if (fd >= 0)
+		close(fd);
+	free(log->buf);
+	log->buf = NULL;
+	return -1;
+}
+
+//----------------------------------------------------------------------
+// tlm_fillRecord - Fills in a record stamped with the current host time.
+// Preconditions:   rec points to valid memory. Payloads beyond 
+//					TLM_DATA_SIZE bytes are truncated.
+// Postconditions:  rec holds the frame.
+//----------------------------------------------------------------------
+void tlm_fillRecord(struct TelemetryRecord *rec, const uint8_t addr64[8], uint8_t rssi,
+		const uint8_t *data, int dataLen) {
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	
+	if (dataLen < 0)
+		dataLen = 0;
+	else if (dataLen > TLM_DATA_SIZE)
+		dataLen = TLM_DATA_SIZE;
+	
+	memset(rec, 0, sizeof(*rec));
+	rec->hostTime = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+	memcpy(rec->addr64, addr64, sizeof(rec->addr64));
+	rec->rssi = rssi;
+	rec->dataLen = dataLen;
+	memcpy(rec->data, data, dataLen);
+}
+
+//----------------------------------------------------------------------
+// tlm_appendRecord Appends a record that was already filled in, keeping
+//					its hostTime. Safe to call from several threads.
+// Preconditions:   log was opened. rec->dataLen <= TLM_DATA_SIZE.
+// Postconditions:  The record is buffered and the buffer is written out
+//					when full or TLM_FLUSH_INTERVAL seconds have passed.
+//----------------------------------------------------------------------
+void tlm_appendRecord(struct TelemetryLog *log, const struct TelemetryRecord *rec) {
+	struct timespec mono;
+	
+	pthread_mutex_lock(&log->lock);
+	
+	log->buf[log->used++] = *rec;
+	log->records++;
+	
+	clock_gettime(CLOCK_MONOTONIC, &mono);
+	if (log->used == TLM_BUFFER_RECORDS || mono.tv_sec - log->lastFlush.tv_sec >= TLM_FLUSH_INTERVAL)
+		flushLocked(log);
+	
+	pthread_mutex_unlock(&log->lock);
+}
+
+//----------------------------------------------------------------------
+// tlm_append ----- Appends one received frame stamped with the current
+//					host time. Safe to call from several threads.
+// Preconditions:   log was opened. Payloads beyond TLM_DATA_SIZE bytes
+//					are truncated.
+// Postconditions:  The record is buffered and the buffer is written out
+//					when full or TLM_FLUSH_INTERVAL seconds have passed.
+//----------------------------------------------------------------------
+void tlm_append(struct TelemetryLog *log, const uint8_t addr64[8], uint8_t rssi,
+		const uint8_t *data, int dataLen) {
+	struct TelemetryRecord rec;
+	tlm_fillRecord(&rec, addr64, rssi, data, dataLen);
+	tlm_appendRecord(log, &rec);
+}
+
+//----------------------------------------------------------------------
+// tlm_flush ------ Writes out any buffered records and syncs the data.
+// Preconditions:   log was opened.
+// Postconditions:  Buffer is empty.
+//----------------------------------------------------------------------
+void tlm_flush(struct TelemetryLog *log) {
+	pthread_mutex_lock(&log->lock);
+	flushLocked(log);
+	pthread_mutex_unlock(&log->lock);
+}
+
+//----------------------------------------------------------------------
+// tlm_close ------ Flushes and closes the log.
+// Preconditions:   None.
+// Postconditions:  log->fd is -1.
+//----------------------------------------------------------------------
+void tlm_close(struct TelemetryLog *log) {
+	if (log->fd < 0)
+		return;
+	
+	tlm_flush(log);
+	close(log->fd);
+	pthread_mutex_destroy(&log->lock);
+	free(log->buf);
+	log->buf = NULL;
+	log->fd = -1;
+}
+
+//----------------------------------------------------------------------
+// tlm_decodePacket Decodes the 7 byte roverPacket at p.
+// Preconditions:   All parameters point to valid memory.
+// Postconditions:  timestamp, cmd, lData and rData are set.
+//----------------------------------------------------------------------
+void tlm_decodePacket(const uint8_t *p, unsigned long *timestamp, unsigned char *cmd,
+		short *lData, short *rData) {
+	// timestamp 0-7, 8-15, 16-23, 24-31
+	*timestamp = ((unsigned long)p[0] << 24) | ((unsigned long)p[1] << 16) |
+			((unsigned long)p[2] << 8) | p[3];
+	
+	// data left 32-39, 40-41
+	*lData = p[4];
+	*lData <<= 8; // set the sign bit
+	*lData >>= 6; // repeat the sign bit
+	*lData += p[5] >> 6; // grab last 2 bits
+	
+	// data right 42-47, 48-51
+	*rData = p[5];
+	*rData <<= 10; // set the sign bit and discard first two bits
+	*rData >>= 6; // repeat the sign bit
+	*rData += p[6] >> 4; // grab last 4 bits
+	
+	// command 52-55
+	*cmd = p[6] & 0x0F;
+}
+
+//----------------------------------------------------------------------
+// getBe ---------- Big endian value at p.
+// Preconditions:   p holds bytes bytes, bytes <= 4.
+// Postconditions:  Returns the value.
+//----------------------------------------------------------------------
+static uint32_t getBe(const uint8_t *p, int bytes) {
+	uint32_t value = 0;
+	for (int i = 0; i < bytes; i++)
+		value = (value << 8) | p[i];
+	return value;
+}
+
+//----------------------------------------------------------------------
+// tlm_decodeStats  Decodes a statistics frame.
+// Preconditions:   data holds len bytes, stats points to valid memory.
+// Postconditions:  Returns 1 and fills in stats if data is a statistics
+//					frame of a known version, 0 otherwise. Version 1
+//					frames decode with no capacities or drops.
+//----------------------------------------------------------------------
+int tlm_decodeStats(const uint8_t *data, int len, struct RoverStats *stats) {
+	if (len < 2 || data[0] != COM_STATS_MARKER)
+		return 0;
+	if (!(data[1] == COM_STATS_VERSION && len == COM_STATS_SIZE) &&
+			!(data[1] == 1 && len == COM_STATS_V1_SIZE))
+		return 0;
+	
+	// counters in the order of the rover library, 4 bytes each
+	uint32_t *counters[] = { &stats->msgsToMaster, &stats->msgsFromMaster, &stats->acksFromMaster,
+			&stats->msgsToSlave, &stats->msgsFromSlave, &stats->acksFromSlave, &stats->encodedPackets,
+			&stats->decodedPackets, &stats->queuedPackets, &stats->failedEncodes };
+	const uint8_t *p = data + 2;
+	for (size_t i = 0; i < sizeof(counters) / sizeof(counters[0]); i++, p += 4)
+		*counters[i] = getBe(p, 4);
+	
+	stats->lastRssi = *p++;
+	stats->worstRssi = *p++;
+	for (int i = 0; i < COM_QUEUES; i++, p += 2)
+		stats->queueHighWater[i] = getBe(p, 2);
+	memset(stats->queueCapacity, 0, sizeof(stats->queueCapacity));
+	memset(stats->queueDrops, 0, sizeof(stats->queueDrops));
+	if (data[1] >= 2) {
+		for (int i = 0; i < COM_QUEUES; i++, p += 2)
+			stats->queueCapacity[i] = getBe(p, 2);
+		for (int i = 0; i < COM_QUEUES; i++, p += 2)
+			stats->queueDrops[i] = getBe(p, 2);
+	}
+	stats->millis = getBe(p, 4);
+	return 1;
+}
+
+//----------------------------------------------------------------------
+// tlm_decodeHist - Decodes a histogram frame.
+// Preconditions:   data holds len bytes, hists holds COM_HIST_PER_FRAME
+//					histograms.
+// Postconditions:  Returns the number of histograms decoded into hists,
+//					0 if data is not a histogram frame of a known
+//					version.
+//----------------------------------------------------------------------
+int tlm_decodeHist(const uint8_t *data, int len, struct RoverHist *hists) {
+	if (len < 2 + COM_HIST_ENTRY_SIZE || (len - 2) % COM_HIST_ENTRY_SIZE != 0 ||
+			data[0] != COM_HIST_MARKER || data[1] != COM_HIST_VERSION)
+		return 0;
+	
+	int count = (len - 2) / COM_HIST_ENTRY_SIZE;
+	if (count > COM_HIST_PER_FRAME)
+		return 0;
+	
+	const uint8_t *p = data + 2;
+	for (int i = 0; i < count; i++) {
+		hists[i].kind = *p >> 4;
+		hists[i].cmd = *p++ & 0x0F;
+		for (int b = 0; b < COM_HIST_BUCKETS; b++, p += 2)
+			hists[i].counts[b] = getBe(p, 2);
+	}
+	return count;
+}
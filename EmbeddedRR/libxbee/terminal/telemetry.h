@@ -0,0 +1,173 @@
+//---------------------------- telemetry.h ----------------------------
+// Filename:      	telemetry.h
+// Project Team:  	EmbeddedRR
+// Group Members: 	Robert Griswold and Ryu Muthui
+// Date:          	19 Oct 2026
+// Description:   	Append-only binary log of every frame received by
+//					the terminal. The file is a TelemetryHeader followed
+//					by fixed size TelemetryRecords so it can be mmapped
+//					and scanned offline (see logscan.c).
+//------------------------------ Includes  ----------------------------
+#ifndef _telemetry_h_
+#define _telemetry_h_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <time.h>
+
+// Configuration
+#define TLM_MAGIC "RVRTLM1"		// 7 chars + terminator
+#define TLM_VERSION 1
+#define TLM_DATA_SIZE 108			// xbee 802.15.4 payloads are at most 100 bytes
+#define TLM_BUFFER_RECORDS 512		// records held before a write (64 KB)
+#define TLM_FLUSH_INTERVAL 2		// seconds between forced writes + fdatasync
+
+// Statistics frame of com_sendStatistics64 (matches the rover library),
+// COM_STATS_SIZE is not a multiple of 7 so it is never a roverPacket payload
+#define COM_STATS_MARKER 0x53	// 'S'
+#define COM_STATS_VERSION 2
+#define COM_STATS_SIZE 60
+#define COM_STATS_V1_SIZE 52		// no queue capacities or drops
+#define COM_QUEUES 2			// packetQueue, navigation queue
+
+// Histogram frames that follow it, 2 + 21 * n bytes (matches the rover library)
+#define COM_HIST_MARKER 0x48	// 'H'
+#define COM_HIST_VERSION 1
+#define COM_HIST_BUCKETS 10		// 0 ms or less, then 2^(b-1) to 2^b - 1 ms, the last open ended
+#define COM_HIST_PER_FRAME 4
+#define COM_HIST_ENTRY_SIZE (1 + 2 * COM_HIST_BUCKETS)
+#define COM_HIST_RESIDENCE 0	// packetQueue enqueue to decode
+#define COM_HIST_LATENCY 1		// sender timestamp to enqueue
+
+// Decoded statistics frame
+struct RoverStats {
+	uint32_t msgsToMaster;
+	uint32_t msgsFromMaster;
+	uint32_t acksFromMaster;
+	uint32_t msgsToSlave;
+	uint32_t msgsFromSlave;
+	uint32_t acksFromSlave;
+	uint32_t encodedPackets;
+	uint32_t decodedPackets;
+	uint32_t queuedPackets;
+	uint32_t failedEncodes;
+	uint8_t lastRssi;		// magnitude, higher is worse
+	uint8_t worstRssi;
+	uint16_t queueHighWater[COM_QUEUES];
+	uint16_t queueCapacity[COM_QUEUES];	// 0 if on the heap or version 1
+	uint16_t queueDrops[COM_QUEUES];	// 0 in version 1
+	uint32_t millis;		// rover time when sent
+};
+
+// Decoded histogram of a histogram frame
+struct RoverHist {
+	uint8_t kind;			// COM_HIST_RESIDENCE or COM_HIST_LATENCY
+	uint8_t cmd;			// roverPacket command
+	uint16_t counts[COM_HIST_BUCKETS];
+};
+
+// File header (16 bytes)
+struct TelemetryHeader {
+	char magic[8];			// TLM_MAGIC
+	uint32_t version;		// TLM_VERSION
+	uint32_t recordSize;	// sizeof(struct TelemetryRecord)
+};
+
+// One received frame (128 bytes)
+struct TelemetryRecord {
+	uint64_t hostTime;		// host receive time, ns since the epoch
+	uint8_t addr64[8];		// source address, msb first
+	uint8_t rssi;			// magnitude of the rssi - higher is worse
+	uint8_t dataLen;		// bytes used in data
+	uint8_t reserved[2];
+	uint8_t data[TLM_DATA_SIZE]; // raw payload (roverPackets)
+};
+
+// Buffered writer state
+struct TelemetryLog {
+	int fd;					// -1 when recording is disabled
+	struct TelemetryRecord *buf;
+	size_t used;			// records waiting in buf
+	unsigned long records;	// records appended since open
+	struct timespec lastFlush;
+	pthread_mutex_t lock;
+};
+
+//----------------------------------------------------------------------
+// tlm_open ------- Opens (or creates) a log for appending.
+// Preconditions:   None.
+// Postconditions:  Returns 0 on success. On failure -1 is returned, an
+//					error is displayed and log->fd is -1.
+//----------------------------------------------------------------------
+int tlm_open(struct TelemetryLog *log, const char *path);
+
+//----------------------------------------------------------------------
+// tlm_append ----- Appends one received frame stamped with the current
+//					host time. Safe to call from several threads.
+// Preconditions:   log was opened. Payloads beyond TLM_DATA_SIZE bytes
+//					are truncated.
+// Postconditions:  The record is buffered and the buffer is written out
+//					when full or TLM_FLUSH_INTERVAL seconds have passed.
+//----------------------------------------------------------------------
+void tlm_append(struct TelemetryLog *log, const uint8_t addr64[8], uint8_t rssi,
+		const uint8_t *data, int dataLen);
+
+//----------------------------------------------------------------------
+// tlm_appendRecord Appends a record that was already filled in, keeping
+//					its hostTime. Safe to call from several threads.
+// Preconditions:   log was opened. rec->dataLen <= TLM_DATA_SIZE.
+// Postconditions:  Same as tlm_append.
+//----------------------------------------------------------------------
+void tlm_appendRecord(struct TelemetryLog *log, const struct TelemetryRecord *rec);
+
+//----------------------------------------------------------------------
+// tlm_fillRecord - Fills in a record stamped with the current host time.
+// Preconditions:   rec points to valid memory. Payloads beyond 
+//					TLM_DATA_SIZE bytes are truncated.
+// Postconditions:  rec holds the frame.
+//----------------------------------------------------------------------
+void tlm_fillRecord(struct TelemetryRecord *rec, const uint8_t addr64[8], uint8_t rssi,
+		const uint8_t *data, int dataLen);
+
+//----------------------------------------------------------------------
+// tlm_flush ------ Writes out any buffered records and syncs the data.
+// Preconditions:   log was opened.
+// Postconditions:  Buffer is empty.
+//----------------------------------------------------------------------
+void tlm_flush(struct TelemetryLog *log);
+
+//----------------------------------------------------------------------
+// tlm_close ------ Flushes and closes the log.
+// Preconditions:   None.
+// Postconditions:  log->fd is -1.
+//----------------------------------------------------------------------
+void tlm_close(struct TelemetryLog *log);
+
+//----------------------------------------------------------------------
+// tlm_decodePacket Decodes the 7 byte roverPacket at p.
+// Preconditions:   All parameters point to valid memory.
+// Postconditions:  timestamp, cmd, lData and rData are set.
+//----------------------------------------------------------------------
+void tlm_decodePacket(const uint8_t *p, unsigned long *timestamp, unsigned char *cmd,
+		short *lData, short *rData);
+
+//----------------------------------------------------------------------
+// tlm_decodeStats  Decodes a statistics frame.
+// Preconditions:   data holds len bytes, stats points to valid memory.
+// Postconditions:  Returns 1 and fills in stats if data is a statistics
+//					frame of a known version, 0 otherwise.
+//----------------------------------------------------------------------
+int tlm_decodeStats(const uint8_t *data, int len, struct RoverStats *stats);
+
+//----------------------------------------------------------------------
+// tlm_decodeHist - Decodes a histogram frame.
+// Preconditions:   data holds len bytes, hists holds COM_HIST_PER_FRAME
+//					histograms.
+// Postconditions:  Returns the number of histograms decoded into hists,
+//					0 if data is not a histogram frame of a known
+//					version.
+//----------------------------------------------------------------------
+int tlm_decodeHist(const uint8_t *data, int len, struct RoverHist *hists);
+
+#endif